@@ -15,6 +15,7 @@ LA_DEBUG=""
 LA_BINARY_TRANSLATION=""
 LA_THREADED="-DLA_THREADED=ON"
 LA_TAILCALL="-DLA_TAILCALL_DISPATCH=OFF"
+LA_PROFILING=""
 
 while [[ $# -gt 0 ]]; do
 	case $1 in
@@ -59,6 +60,10 @@ while [[ $# -gt 0 ]]; do
 			LA_TAILCALL="-DLA_TAILCALL_DISPATCH=ON"
 			shift
 			;;
+		--instruction-profiling)
+			LA_PROFILING="-DLA_INSTRUCTION_PROFILING=ON"
+			shift
+			;;
 		-h|--help)
 			echo "Usage: $0 [options]"
 			echo ""
@@ -72,6 +77,8 @@ while [[ $# -gt 0 ]]; do
 			echo "                            Example: --masked-memory-bits 32 (4GB arena)"
 			echo "  --binary-translation      Enable binary translation (experimental)"
 			echo "  --no-threaded             Disable threaded dispatch"
+			echo "  --tailcall-dispatch       Use tail-call dispatch (Clang 13+, GCC 15+)"
+			echo "  --instruction-profiling   Count executed instructions (laemu --profile)"
 			echo ""
 			echo "Examples:"
 			echo "  $0                                    # Standard optimized build"
@@ -96,6 +103,7 @@ echo "  LTO: ${LTO#-DLTO=}"
 [ -n "$LA_DEBUG" ] && echo "  Debug mode: ON" || echo "  Debug mode: OFF"
 [ -n "$LA_BINARY_TRANSLATION" ] && echo "  Binary translation: ON" || echo "  Binary translation: OFF"
 echo "  Threaded dispatch: ${LA_THREADED#-DLA_THREADED=}"
+[ -n "$LA_PROFILING" ] && echo "  Instruction profiling: ON"
 if [ -n "$MASKED_MEMORY_BITS" ]; then
 	BITS="${MASKED_MEMORY_BITS#-DLA_MASKED_MEMORY_BITS=}"
 	SIZE=$((1 << BITS))
@@ -123,7 +131,8 @@ cmake .. \
 	$LA_BINARY_TRANSLATION \
 	$LA_THREADED \
 	$MASKED_MEMORY_BITS \
-	$LA_TAILCALL
+	$LA_TAILCALL \
+	$LA_PROFILING
 
 # Build
 make -j$(nproc)
@@ -0,0 +1,138 @@
+#!/usr/bin/env bash
+# Generate profile-guided bytecodes from dynamic instruction profiles
+#
+# 1. Build the emulator with instruction profiling:
+#      ./build.sh --instruction-profiling
+# 2. Run a corpus of guest programs, one profile each:
+#      .build/laemu --profile physics.prof physics.elf
+#      .build/laemu --profile strings.prof strings.elf
+# 3. Generate the bytecode list from the merged profiles:
+#      ./generate_bytecodes.sh physics.prof strings.prof
+# 4. Rebuild without profiling.
+#
+# The hottest instructions that do not have a hand-written bytecode are
+# written to lib/libloong/profiled_bytecodes.hpp, which provides the bytecode
+# enum, the InstrId to bytecode mapping, the rewriter cases and the handlers.
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+LIB_DIR="${SCRIPT_DIR}/../lib/libloong"
+OUTPUT="${LIB_DIR}/profiled_bytecodes.hpp"
+MAX_BYTECODES=32
+MIN_SHARE="0.01"
+PROFILES=()
+
+while [[ $# -gt 0 ]]; do
+	case $1 in
+		-n|--max-bytecodes)
+			MAX_BYTECODES="$2"
+			shift 2
+			;;
+		-m|--min-share)
+			MIN_SHARE="$2"
+			shift 2
+			;;
+		-o|--output)
+			OUTPUT="$2"
+			shift 2
+			;;
+		-h|--help)
+			echo "Usage: $0 [options] <profile>..."
+			echo ""
+			echo "Options:"
+			echo "  -n, --max-bytecodes N     Generate at most N bytecodes (default: $MAX_BYTECODES)"
+			echo "  -m, --min-share PERCENT   Skip instructions below PERCENT of all executed"
+			echo "                            instructions (default: $MIN_SHARE)"
+			echo "  -o, --output FILE         Output file (default: lib/libloong/profiled_bytecodes.hpp)"
+			echo ""
+			echo "Profiles are written by laemu --profile in a LA_INSTRUCTION_PROFILING build."
+			exit 0
+			;;
+		-*)
+			echo "Unknown option: $1"
+			echo "Use --help for usage information"
+			exit 1
+			;;
+		*)
+			PROFILES+=("$1")
+			shift
+			;;
+	esac
+done
+
+if [ ${#PROFILES[@]} -eq 0 ]; then
+	echo "Error: No profiles specified"
+	echo "Use --help for usage information"
+	exit 1
+fi
+
+TMP_DIR="$(mktemp -d)"
+trap 'rm -rf "$TMP_DIR"' EXIT
+
+# InstrId values, in declaration order (INVALID = 0)
+awk '/enum class InstrId/ { inside = 1; next }
+	inside && /MAX_INSTRUCTION_ID/ { exit }
+	inside && match($0, /^[ \t]*[A-Z][A-Z0-9_]*/) {
+		name = substr($0, RSTART, RLENGTH); gsub(/[ \t]/, "", name)
+		print id++, name
+	}' "${LIB_DIR}/la_instr_enum.hpp" > "$TMP_DIR/ids"
+
+# Instructions that already have a hand-written bytecode
+grep -o 'case InstrId::[A-Z0-9_]*' "${LIB_DIR}/decoder_cache.cpp" \
+	| sed 's/case InstrId:://' > "$TMP_DIR/handwritten"
+grep -o '^LA64_VECTOR_BYTECODE([A-Z0-9_]*' "${LIB_DIR}/vector_bytecodes.hpp" \
+	| sed 's/LA64_VECTOR_BYTECODE(//' >> "$TMP_DIR/handwritten"
+
+# Instructions whose handler is InstrImpl::<InstrId>
+grep -oE '^[[:space:]]*INSTRUCTION(_P)?\([A-Z0-9_]+' "${LIB_DIR}/la64.cpp" \
+	| sed -E 's/.*\(//' > "$TMP_DIR/implemented"
+
+awk -v max="$MAX_BYTECODES" -v min_share="$MIN_SHARE" \
+	-v ids="$TMP_DIR/ids" -v handwritten="$TMP_DIR/handwritten" -v implemented="$TMP_DIR/implemented" '
+	BEGIN {
+		while ((getline line < ids) > 0) { split(line, f, " "); name[f[1]] = f[2] }
+		while ((getline line < handwritten) > 0) skip[line] = 1
+		while ((getline line < implemented) > 0) impl[line] = 1
+		# Never dispatched through the generic handler
+		skip["INVALID"] = skip["UNIMPLEMENTED"] = skip["SYSCALL"] = skip["BREAK"] = 1
+	}
+	/^#/ || NF < 2 { next }
+	{ count[$1] += $2; total += $2 }
+	END {
+		for (id in count) {
+			n = name[id]
+			if (n == "") {
+				printf("Warning: unknown InstrId %s (stale profile?)\n", id) > "/dev/stderr"
+				continue
+			}
+			if (n in skip || !(n in impl)) continue
+			if (100.0 * count[id] / total < min_share) continue
+			printf("%s %s %.4f\n", count[id], n, 100.0 * count[id] / total)
+		}
+	}' "${PROFILES[@]}" | sort -k1,1nr | head -n "$MAX_BYTECODES" > "$TMP_DIR/selected"
+
+{
+	echo "// Profile-guided bytecodes"
+	echo "// Generated by emulator/generate_bytecodes.sh - do not edit by hand"
+	echo "//"
+	echo "// LA64_PROFILED_BYTECODE(InstrId, name) becomes the bytecode LA64_BC_<InstrId>,"
+	echo "// which calls InstrImpl::<InstrId> directly instead of going through the"
+	echo "// LA64_BC_FUNCTION handler table. Ordered by dynamic execution count."
+	echo "// This file is included several times, with different definitions of the macro."
+	echo "//"
+	echo "// Profiles:"
+	for profile in "${PROFILES[@]}"; do
+		echo "//   $(basename "$profile")"
+	done
+	if [ ! -s "$TMP_DIR/selected" ]; then
+		echo "//"
+		echo "// No instruction without a bytecode reached ${MIN_SHARE}% of the executed"
+		echo "// instructions, so there are no profile-guided bytecodes."
+	fi
+	while read -r count id share; do
+		printf 'LA64_PROFILED_BYTECODE(%-16s "%s") // %s\n' "$id," "${id//_/.}" "$count"
+	done < "$TMP_DIR/selected"
+} > "$OUTPUT"
+
+echo "Generated $(wc -l < "$TMP_DIR/selected") bytecodes in $OUTPUT"
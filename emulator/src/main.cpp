@@ -1,4 +1,5 @@
 #include <libloong/machine.hpp>
+#include <libloong/sample_profiler.hpp>
 #include <libloong/threaded_bytecodes.hpp>
 #include <chrono>
 #include <cstdlib>
@@ -20,17 +21,25 @@ struct EmulatorOptions {
 	std::string binary_path;
 	std::vector<std::string> program_args;
 	uint64_t max_instructions = 0; // unlimited
+	uint64_t timeout_ms = 0; // Wall-clock limit, 0 = none
 	uint64_t memory_max = 4096ull << 20; // 4 GB
 	bool verbose = false;
 	bool precise = false;
 	bool timing = false;
 	bool silent = false;
 	bool show_bytecode_stats = false;
+	std::string instruction_profile_file; // Dynamic instruction profile output
+	bool show_block_profile = false;
+	std::string sample_profile_file; // Folded stacks output
+	uint64_t sample_interval = SampleProfiler::DEFAULT_INTERVAL;
 	bool enable_translation = true;
 	bool trace_translation = false;
 	bool enable_register_caching = true;
 	bool translate_nbit_as = false;
 	bool translate_unsafe = false;
+	bool translate_aot = false; // Compile with the system compiler before running
+	std::string translate_cache_dir; // Cached shared objects from the system compiler
+	uint32_t translate_hot_threshold = 0; // Tiered translation of hot blocks
 	std::string translate_output_file; // Output file for generated C code
 };
 
@@ -56,6 +65,35 @@ static std::vector<uint8_t> load_file(const char* filename)
 	return buffer;
 }
 
+// Get the mnemonic of an instruction using its printer, or nothing
+static std::string instruction_mnemonic(const Machine& machine, uint32_t instr_bits)
+{
+	loongarch::la_instruction instr;
+	instr.whole = instr_bits;
+	const auto& decoded = loongarch::CPU::decode(instr);
+	if (!decoded.printer)
+		return {};
+
+	char buffer[256];
+	try {
+		// Most printers don't use the CPU parameter, but some might.
+		const int printed = decoded.printer(buffer, sizeof(buffer),
+			machine.cpu, instr, 0);
+		if (printed <= 0 || buffer[0] == '\0')
+			return {};
+	} catch (...) {
+		// Printer crashed (probably used CPU)
+		return {};
+	}
+	// Extract just the mnemonic (first word before space)
+	std::string mnemonic(buffer);
+	const size_t space_pos = mnemonic.find(' ');
+	if (space_pos != std::string::npos) {
+		mnemonic = mnemonic.substr(0, space_pos);
+	}
+	return mnemonic;
+}
+
 static void print_bytecode_statistics(const Machine& machine)
 {
 	printf("\n=== Bytecode Usage Statistics ===\n\n");
@@ -82,42 +120,12 @@ static void print_bytecode_statistics(const Machine& machine)
 		// For fallback bytecodes (FUNCTION), decode the sample instruction using the printer
 		if (stat.bytecode == loongarch::LA64_BC_FUNCTION &&
 		    stat.sample_instruction != 0) {
-			// Decode the instruction to get its printer
-			loongarch::la_instruction instr;
-			instr.whole = stat.sample_instruction;
-			const auto& decoded = loongarch::CPU::decode(instr);
-
-			if (decoded.printer) {
-				char buffer[256];
-				// Most printers don't use the CPU parameter, but some might.
-				// We create a temporary CPU on the stack for safety.
-				try {
-					// Call the printer - pass nullptr for CPU as most don't use it
-					int printed = decoded.printer(buffer, sizeof(buffer),
-						machine.cpu, instr, 0);
-
-					if (printed > 0 && buffer[0] != '\0') {
-						// Extract just the mnemonic (first word before space)
-						std::string mnemonic(buffer);
-						size_t space_pos = mnemonic.find(' ');
-						if (space_pos != std::string::npos) {
-							mnemonic = mnemonic.substr(0, space_pos);
-						}
-
-						printf("%-20s %12" PRIu64 " %9.2f%% (%s)\n",
-							   name, stat.count, percentage, mnemonic.c_str());
-					} else {
-						// Printer returned nothing, show hex
-						printf("%-20s %12" PRIu64 " %9.2f%% (0x%08x)\n",
-							   name, stat.count, percentage, stat.sample_instruction);
-					}
-				} catch (...) {
-					// Printer crashed (probably used CPU), show hex
-					printf("%-20s %12" PRIu64 " %9.2f%% (0x%08x)\n",
-						   name, stat.count, percentage, stat.sample_instruction);
-				}
+			const std::string mnemonic = instruction_mnemonic(machine, stat.sample_instruction);
+			if (!mnemonic.empty()) {
+				printf("%-20s %12" PRIu64 " %9.2f%% (%s)\n",
+					   name, stat.count, percentage, mnemonic.c_str());
 			} else {
-				// No printer, show hex
+				// Printer returned nothing, show hex
 				printf("%-20s %12" PRIu64 " %9.2f%% (0x%08x)\n",
 					   name, stat.count, percentage, stat.sample_instruction);
 			}
@@ -129,6 +137,73 @@ static void print_bytecode_statistics(const Machine& machine)
 	printf("\nTotal instructions in cache: %" PRIu64 "\n", total);
 }
 
+// Write dynamic per-instruction execution counts, one instruction per line:
+//   <InstrId> <count> <bytecode> <mnemonic>
+// Profiles from several programs are merged by generate_bytecodes.sh.
+static void write_instruction_profile(const Machine& machine, const std::string& filename)
+{
+	const auto profile = machine.collect_instruction_profile();
+
+	FILE* f = fopen(filename.c_str(), "w");
+	if (f == nullptr) {
+		throw std::runtime_error("Failed to open profile file: " + filename);
+	}
+	uint64_t total = 0;
+	fprintf(f, "# libloong instruction profile\n");
+	fprintf(f, "# id count bytecode mnemonic\n");
+	for (const auto& entry : profile) {
+		const std::string mnemonic = instruction_mnemonic(machine, entry.sample_instruction);
+		fprintf(f, "%u %" PRIu64 " %s %s\n",
+			unsigned(entry.id), entry.count,
+			loongarch::bytecode_name(entry.bytecode),
+			mnemonic.empty() ? "?" : mnemonic.c_str());
+		total += entry.count;
+	}
+	fclose(f);
+
+	fprintf(stderr, "Wrote profile of %zu instructions (%" PRIu64 " executed) to %s\n",
+		profile.size(), total, filename.c_str());
+}
+
+// Print the hottest blocks counted by the block-profiling dispatch
+static void print_block_profile(const Machine& machine, size_t max_blocks = 25)
+{
+	const auto profile = machine.collect_block_profile();
+	if (profile.empty()) {
+		printf("No block profile available\n");
+		return;
+	}
+	uint64_t total = 0;
+	for (const auto& block : profile) {
+		total += block.count * block.instructions;
+	}
+
+	printf("\n=== Block Profile ===\n");
+	printf("%-18s %12s %7s %8s  %s\n", "Address", "Count", "Instrs", "Share", "Symbol");
+	printf("%-18s %12s %7s %8s  %s\n", "-------", "-----", "------", "-----", "------");
+	for (size_t i = 0; i < profile.size() && i < max_blocks; i++) {
+		const auto& block = profile[i];
+		const double percentage = (100.0 * block.count * block.instructions) / total;
+		printf("0x%016" PRIx64 " %12" PRIu64 " %7u %7.2f%%  %s\n",
+			uint64_t(block.pc), block.count, block.instructions, percentage,
+			block.symbol.empty() ? "?" : block.symbol.c_str());
+	}
+	printf("\n%zu blocks, %" PRIu64 " instructions\n", profile.size(), total);
+}
+
+static void write_sample_profile(const Machine& machine, const SampleProfiler& profiler, const std::string& filename)
+{
+	FILE* f = fopen(filename.c_str(), "w");
+	if (f == nullptr) {
+		throw std::runtime_error("Failed to open profile file: " + filename);
+	}
+	const std::string folded = profiler.folded_stacks(machine);
+	fwrite(folded.data(), 1, folded.size(), f);
+	fclose(f);
+
+	fprintf(stderr, "Wrote %" PRIu64 " samples to %s\n", profiler.samples(), filename.c_str());
+}
+
 static int run_program(const std::vector<uint8_t>& binary, const EmulatorOptions& opts)
 {
 	const auto custom_arena = MachineOptions::estimate_cpu_relative_arena_size_for(opts.memory_max);
@@ -153,16 +228,21 @@ static int run_program(const std::vector<uint8_t>& binary, const EmulatorOptions
 #ifdef LA_BINARY_TRANSLATION
 			.translate_enabled = opts.enable_translation,
 			.translate_trace = opts.trace_translation,
-			.translate_ignore_instruction_limit = opts.max_instructions == 0,
+			// Translated code must stop at the sampling points
+			.translate_ignore_instruction_limit = opts.max_instructions == 0 && opts.sample_profile_file.empty(),
 			.translate_use_register_caching = opts.enable_register_caching,
-			.translate_background_callback = [](const std::function<void()>& step) {
-				// Simple background compilation using a detached thread
-				std::thread(step).detach();
-			},
+			.translate_background_callback = opts.translate_aot ? nullptr :
+				std::function<void(const std::function<void()>&)>([](const std::function<void()>& step) {
+					// Simple background compilation using a detached thread
+					std::thread(step).detach();
+				}),
 			.translate_automatic_nbit_address_space = opts.translate_nbit_as,
 			.translate_unchecked_memory_accesses = opts.translate_unsafe,
 			.translate_verbose_fallbacks = opts.verbose,
 			.translate_output_file = opts.translate_output_file,
+			.translate_use_system_compiler = opts.translate_aot,
+			.translate_cache_dir = opts.translate_cache_dir,
+			.translate_hot_threshold = opts.translate_hot_threshold,
 #endif
 		});
 		machine = new (arena_ptr) Machine(binary, *options);
@@ -203,15 +283,30 @@ static int run_program(const std::vector<uint8_t>& binary, const EmulatorOptions
 			exit(1);
 		});
 
+		if (opts.show_block_profile) {
+			machine->set_block_profiling(true);
+		}
+		SampleProfiler sample_profiler(opts.sample_interval);
+		if (!opts.sample_profile_file.empty()) {
+			machine->set_sample_profiler(&sample_profiler);
+		}
+
 		const auto t0 = std::chrono::high_resolution_clock::now();
+		bool timed_out = false;
 
 		// Run the program
 		if (opts.precise) {
 			machine->set_max_instructions(opts.max_instructions ? opts.max_instructions : UINT64_MAX);
 			machine->set_instruction_counter(0);
 			machine->cpu.simulate_precise();
+		} else if (opts.max_instructions == 0 && !opts.show_block_profile && opts.sample_profile_file.empty()
+			&& opts.translate_hot_threshold == 0) {
+			if (opts.timeout_ms != 0)
+				timed_out = !machine->simulate_for(std::chrono::milliseconds(opts.timeout_ms));
+			else
+				machine->cpu.simulate_inaccurate(machine->cpu.pc());
 		} else if (opts.max_instructions == 0) {
-			machine->cpu.simulate_inaccurate(machine->cpu.pc());
+			machine->simulate(UINT64_MAX);
 		} else {
 			machine->simulate(opts.max_instructions);
 		}
@@ -223,9 +318,24 @@ static int run_program(const std::vector<uint8_t>& binary, const EmulatorOptions
 		if (opts.show_bytecode_stats) {
 			print_bytecode_statistics(*machine);
 		}
+		if (!opts.instruction_profile_file.empty()) {
+			write_instruction_profile(*machine, opts.instruction_profile_file);
+		}
+		if (opts.show_block_profile) {
+			print_block_profile(*machine);
+		}
+		if (!opts.sample_profile_file.empty()) {
+			machine->set_sample_profiler(nullptr);
+			write_sample_profile(*machine, sample_profiler, opts.sample_profile_file);
+		}
 
 		// Check if stopped normally
-		if (!machine->instruction_limit_reached()) {
+		if (timed_out) {
+			if (!opts.silent) {
+				fprintf(stderr, "Execution timeout after %.3f seconds\n", elapsed.count());
+			}
+			return -1;
+		} else if (!machine->instruction_limit_reached()) {
 			const int exit_code = machine->template return_value<int>();
 			if (!opts.silent) {
 				if (opts.max_instructions != 0) {
@@ -280,13 +390,24 @@ static void print_help(const char* progname)
 	printf("      --precise           Use precise simulation mode (slower)\n");
 	printf("  -t, --timing            Show execution timing and instruction count\n");
 	printf("      --stats             Show bytecode usage statistics after execution\n");
+	printf("      --profile <file>    Write dynamic instruction counts to file\n");
+	printf("                          (requires a LA_INSTRUCTION_PROFILING build)\n");
+	printf("      --block-profile     Show the hottest blocks after execution\n");
+	printf("      --sample-profile <file>  Write sampled guest stacks as folded stacks\n");
+	printf("      --sample-interval <num>  Instructions between samples (default: %" PRIu64 ")\n",
+		SampleProfiler::DEFAULT_INTERVAL);
 	printf("  -f, --fuel <num>        Maximum instructions to execute (default: 2000000000)\n");
 	printf("                          Use 0 for unlimited execution\n");
+	printf("      --timeout <ms>      Wall-clock limit in milliseconds, when no --fuel is given\n");
 	printf("  -m, --memory <size>     Maximum memory in MiB (default: 512)\n");
 	printf("  -n, --no-translate      Disable binary translation (interpret only)\n");
 	printf("      --no-regcache       Disable register caching in translated code\n");
 	printf("      --fast              Enable fastest binary translation (unsafe)\n");
 	printf("      --nbit-as           Use automatic N-bit address masking in binary translation\n");
+	printf("      --aot               Compile the translation with the system compiler ($CC)\n");
+	printf("                          before running, instead of libtcc in the background\n");
+	printf("      --cache <dir>       Cache --aot translations in a directory\n");
+	printf("      --tiered <n>        Translate only blocks entered n times, while running\n");
 	printf("  -T, --trace             Trace binary translation execution\n");
 	printf("  -O, --output <file>     Write generated translation code to file\n\n");
 	printf("The emulator automatically detects LA32/LA64 architecture from the ELF binary.\n\n");
@@ -319,6 +440,14 @@ static EmulatorOptions parse_arguments(int argc, char* argv[])
 		{"nbit-as", no_argument,       0, '\x06'},
 		{"trace",   no_argument,       0, 'T'},
 		{"output",  required_argument, 0, 'O'},
+		{"profile", required_argument, 0, '\x07'},
+		{"block-profile", no_argument, 0, '\x08'},
+		{"sample-profile", required_argument, 0, '\x09'},
+		{"sample-interval", required_argument, 0, '\x0a'},
+		{"timeout", required_argument, 0, '\x0b'},
+		{"aot",     no_argument,       0, '\x0c'},
+		{"cache",   required_argument, 0, '\x0d'},
+		{"tiered",  required_argument, 0, '\x0e'},
 		{0, 0, 0, 0}
 	};
 
@@ -371,6 +500,39 @@ static EmulatorOptions parse_arguments(int argc, char* argv[])
 		case '\x06':
 			opts.translate_nbit_as = true;
 			break;
+		case '\x07':
+#ifdef LA_INSTRUCTION_PROFILING
+			opts.instruction_profile_file = optarg;
+			// Only interpreted instructions are counted
+			opts.enable_translation = false;
+			break;
+#else
+			fprintf(stderr, "Error: --profile requires a build with LA_INSTRUCTION_PROFILING=ON\n");
+			exit(1);
+#endif
+		case '\x08':
+			opts.show_block_profile = true;
+			// Only interpreted blocks are counted
+			opts.enable_translation = false;
+			break;
+		case '\x09':
+			opts.sample_profile_file = optarg;
+			break;
+		case '\x0a':
+			opts.sample_interval = strtoull(optarg, nullptr, 10);
+			break;
+		case '\x0b':
+			opts.timeout_ms = strtoull(optarg, nullptr, 10);
+			break;
+		case '\x0c':
+			opts.translate_aot = true;
+			break;
+		case '\x0d':
+			opts.translate_cache_dir = optarg;
+			break;
+		case '\x0e':
+			opts.translate_hot_threshold = strtoul(optarg, nullptr, 10);
+			break;
 		default:
 			print_help(argv[0]);
 			exit(1);
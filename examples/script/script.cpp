@@ -393,9 +393,9 @@ void Script::patch_host_functions()
 		entry.block_bytes = 0; // Diverges here
 		entry.instr = binding.syscall_num;
 
-		// Install into decoder cache
-		auto exec_seg = m_machine->memory.exec_segment_for(addr);
-		if (!exec_seg->empty()) {
+		// Install into this machine's decoder cache
+		auto* exec_seg = m_machine->memory.private_execute_segment_for(addr);
+		if (exec_seg != nullptr) {
 			exec_seg->set(addr, entry);
 		}
 	}
@@ -1,6 +1,6 @@
 /**
  * Bytecode implementation for threaded dispatch
- * This file is included by threaded_dispatch.cpp and threaded_inaccurate_dispatch.cpp
+ * This file is included by threaded_dispatch.cpp and the tail-call dispatch files
  **/
 
 // ============ Popular Instruction Bytecodes ============
@@ -452,9 +452,27 @@ INSTRUCTION(LA64_BC_B, la64_b)
 INSTRUCTION(LA64_BC_BL, la64_bl)
 {
 	REG(REG_RA) = pc + 4;
+	CPU().push_return_address(*exec, pc + 4, &DECODER() + 1);
 	PERFORM_BRANCH((int32_t)DECODER().instr);
 }
 
+// LA64_BC_B_CHAINED: Forward branch into a block that was already counted
+// block_bytes holds the size of the target block, so the block ending here
+// counted the target block too (see DecodedExecuteSegment::chain_blocks).
+// Chains only go forward, so they cannot loop without a counter check.
+INSTRUCTION(LA64_BC_B_CHAINED, la64_b_chained)
+{
+	CHAINED_BRANCH((int32_t)DECODER().instr);
+}
+
+// LA64_BC_BL_CHAINED: Forward branch and link into an already counted block
+INSTRUCTION(LA64_BC_BL_CHAINED, la64_bl_chained)
+{
+	REG(REG_RA) = RECONSTRUCT_PC() + 4;
+	CPU().push_return_address(*exec, RECONSTRUCT_PC() + 4, &DECODER() + 1);
+	CHAINED_BRANCH((int32_t)DECODER().instr);
+}
+
 // LA64_BC_BEQZ: Branch if equal to zero
 INSTRUCTION(LA64_BC_BEQZ, la64_beqz)
 {
@@ -544,10 +562,258 @@ INSTRUCTION(LA64_BC_JIRL, la64_jirl)
 
 	if (fi.rd != 0) {
 		REG(fi.rd) = pc + 4;
+		// Indirect call
+		if (fi.rd == REG_RA)
+			CPU().push_return_address(*exec, pc + 4, &DECODER() + 1);
 	}
 	NEXT_BLOCK(target - pc);
 }
 
+// LA64_BC_RET: Return from function (JIRL zero, ra, 0)
+// Calls push their return address, so a return that matches the
+// prediction jumps straight to the decoder entry after the call.
+INSTRUCTION(LA64_BC_RET, la64_ret)
+{
+	const address_t target = REG(REG_RA);
+	DecoderData* entry = CPU().predict_return(target);
+	if (LA_LIKELY(entry != nullptr)) {
+		pc = target;
+		PREDICTED_RETURN(entry);
+	}
+	NEXT_BLOCK(target - pc);
+}
+
+// ============ Superinstructions ============
+// The first slot holds the fused bytecode, while the second slot keeps its
+// original decoder entry. SKIP_INSTR() moves on to the second slot.
+
+// LA64_BC_SLT_BEQZ: SLT rd, rj, rk + BEQZ rd, offs
+INSTRUCTION(LA64_BC_SLT_BEQZ, la64_slt_beqz)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const address_t value = (int64_t)REG(fi.rj) < (int64_t)REG(fi.rk);
+	REG(fi.rd) = value;
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (value == 0) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_SLT_BNEZ: SLT rd, rj, rk + BNEZ rd, offs
+INSTRUCTION(LA64_BC_SLT_BNEZ, la64_slt_bnez)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const address_t value = (int64_t)REG(fi.rj) < (int64_t)REG(fi.rk);
+	REG(fi.rd) = value;
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (value != 0) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_SLTU_BEQZ: SLTU rd, rj, rk + BEQZ rd, offs
+INSTRUCTION(LA64_BC_SLTU_BEQZ, la64_sltu_beqz)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const address_t value = REG(fi.rj) < REG(fi.rk);
+	REG(fi.rd) = value;
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (value == 0) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_SLTU_BNEZ: SLTU rd, rj, rk + BNEZ rd, offs
+INSTRUCTION(LA64_BC_SLTU_BNEZ, la64_sltu_bnez)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const address_t value = REG(fi.rj) < REG(fi.rk);
+	REG(fi.rd) = value;
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (value != 0) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_ADDI_D_LD_D: ADDI.D rd, rj, imm + LD.D rd2, rd, imm2
+INSTRUCTION(LA64_BC_ADDI_D_LD_D, la64_addi_d_ld_d)
+{
+	auto fi = *(FasterLA64_RI12 *)&DECODER().instr;
+	const address_t base = REG(fi.rj) + fi.imm;
+	REG(fi.rd) = base;
+	SKIP_INSTR();
+	auto li = *(FasterLA64_RI12 *)&DECODER().instr;
+	REG(li.rd) = MACHINE().memory.template read<uint64_t, true>(base + li.imm);
+	NEXT_INSTR();
+}
+
+// LA64_BC_ALSL_D_LDX_D: ALSL.D rd, rj, rk, sa2 + LDX.D rd2, rj2, rk2 (rd is rj2 or rk2)
+INSTRUCTION(LA64_BC_ALSL_D_LDX_D, la64_alsl_d_ldx_d)
+{
+	auto fi = *(FasterLA64_R3SA2 *)&DECODER().instr;
+	REG(fi.rd) = (REG(fi.rj) << (fi.sa2 + 1)) + REG(fi.rk);
+	SKIP_INSTR();
+	auto li = *(FasterLA64_R3 *)&DECODER().instr;
+	const auto addr = REG(li.rj) + REG(li.rk);
+	REG(li.rd) = MACHINE().memory.template read<int64_t, true>(addr);
+	NEXT_INSTR();
+}
+
+// LA64_BC_LD_D_LD_D: LD.D rd, rj, imm + LD.D rd2, rj, imm2 (rd != rj)
+INSTRUCTION(LA64_BC_LD_D_LD_D, la64_ld_d_ld_d)
+{
+	auto fi = *(FasterLA64_RI12 *)&DECODER().instr;
+	const address_t base = REG(fi.rj);
+	REG(fi.rd) = MACHINE().memory.template read<uint64_t, true>(base + fi.imm);
+	SKIP_INSTR();
+	auto li = *(FasterLA64_RI12 *)&DECODER().instr;
+	REG(li.rd) = MACHINE().memory.template read<uint64_t, true>(base + li.imm);
+	NEXT_INSTR();
+}
+
+// LA64_BC_FCMP_S_BCEQZ: FCMP.cond.S cd, fj, fk + BCEQZ cd, offs
+INSTRUCTION(LA64_BC_FCMP_S_BCEQZ, la64_fcmp_s_bceqz)
+{
+	auto fi = *(FasterLA64_FCmp *)&DECODER().instr;
+	const bool result = InstructionHelpers::fcmp_condition(fi.cond,
+		REGISTERS().getvr(fi.fj).f[0], REGISTERS().getvr(fi.fk).f[0]);
+	REGISTERS().set_cf(fi.cd, result);
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (!result) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_FCMP_S_BCNEZ: FCMP.cond.S cd, fj, fk + BCNEZ cd, offs
+INSTRUCTION(LA64_BC_FCMP_S_BCNEZ, la64_fcmp_s_bcnez)
+{
+	auto fi = *(FasterLA64_FCmp *)&DECODER().instr;
+	const bool result = InstructionHelpers::fcmp_condition(fi.cond,
+		REGISTERS().getvr(fi.fj).f[0], REGISTERS().getvr(fi.fk).f[0]);
+	REGISTERS().set_cf(fi.cd, result);
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (result) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_FCMP_D_BCEQZ: FCMP.cond.D cd, fj, fk + BCEQZ cd, offs
+INSTRUCTION(LA64_BC_FCMP_D_BCEQZ, la64_fcmp_d_bceqz)
+{
+	auto fi = *(FasterLA64_FCmp *)&DECODER().instr;
+	const bool result = InstructionHelpers::fcmp_condition(fi.cond,
+		REGISTERS().getvr(fi.fj).df[0], REGISTERS().getvr(fi.fk).df[0]);
+	REGISTERS().set_cf(fi.cd, result);
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (!result) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_FCMP_D_BCNEZ: FCMP.cond.D cd, fj, fk + BCNEZ cd, offs
+INSTRUCTION(LA64_BC_FCMP_D_BCNEZ, la64_fcmp_d_bcnez)
+{
+	auto fi = *(FasterLA64_FCmp *)&DECODER().instr;
+	const bool result = InstructionHelpers::fcmp_condition(fi.cond,
+		REGISTERS().getvr(fi.fj).df[0], REGISTERS().getvr(fi.fk).df[0]);
+	REGISTERS().set_cf(fi.cd, result);
+	SKIP_INSTR();
+	auto bi = *(FasterLA64_RI21_Branch *)&DECODER().instr;
+	if (result) {
+		PERFORM_BRANCH(bi.offset);
+	}
+	NEXT_BLOCK_UNCHECKED(4);
+}
+
+// LA64_BC_LD_D_SP/LA64_BC_ST_D_SP: Run of LD.D/ST.D relative to sp
+// sp is validated once, after which this and the following stack accesses
+// are performed without further checks. None of them writes sp, and each
+// validates sp when jumped to directly, so they are all valid entry points.
+#define STACK_RUN()                                                         \
+	auto& mem = MACHINE().memory;                                           \
+	const address_t sp = REG(REG_SP);                                       \
+	if (LA_LIKELY(mem.is_stack_accessible(sp))) {                           \
+		for (;;) {                                                          \
+			auto fi = *(FasterLA64_RI12 *)&DECODER().instr;                 \
+			if (DECODER().get_bytecode() == LA64_BC_LD_D_SP)                \
+				REG(fi.rd) = mem.template read_stack<uint64_t>(sp, fi.imm); \
+			else                                                            \
+				mem.template write_stack<uint64_t>(sp, fi.imm, REG(fi.rd)); \
+			const uint8_t next = (&DECODER() + 1)->get_bytecode();          \
+			if (next != LA64_BC_LD_D_SP && next != LA64_BC_ST_D_SP)         \
+				break;                                                      \
+			SKIP_INSTR();                                                   \
+		}                                                                   \
+		NEXT_INSTR();                                                       \
+	}
+
+INSTRUCTION(LA64_BC_LD_D_SP, la64_ld_d_sp)
+{
+	STACK_RUN();
+	// sp is near the edge of the writable area (or outside of it)
+	auto fi = *(FasterLA64_RI12 *)&DECODER().instr;
+	REG(fi.rd) = mem.template read<uint64_t, true>(sp + fi.imm);
+	NEXT_INSTR();
+}
+
+INSTRUCTION(LA64_BC_ST_D_SP, la64_st_d_sp)
+{
+	STACK_RUN();
+	auto fi = *(FasterLA64_RI12 *)&DECODER().instr;
+	mem.template write<uint64_t, true>(sp + fi.imm, REG(fi.rd));
+	NEXT_INSTR();
+}
+#undef STACK_RUN
+
+// LA64_BC_CONST: Folded constant or PC-relative address (rd = table[index])
+INSTRUCTION(LA64_BC_CONST, la64_const)
+{
+	auto fi = *(FasterLA64_Constant *)&DECODER().instr;
+	REG(fi.rd) = exec->folded_constant(fi.index);
+	SKIP_INSTRS(fi.count - 1);
+	NEXT_INSTR();
+}
+
+// LA64_BC_CONST_LD_D: Folded PC-relative address + LD.D rd2, rd, imm
+INSTRUCTION(LA64_BC_CONST_LD_D, la64_const_ld_d)
+{
+	auto fi = *(FasterLA64_Constant *)&DECODER().instr;
+	const address_t base = exec->folded_constant(fi.index);
+	REG(fi.rd) = base;
+	SKIP_INSTR();
+	auto li = *(FasterLA64_RI12 *)&DECODER().instr;
+	REG(li.rd) = MACHINE().memory.template read<uint64_t, true>(base + li.imm);
+	NEXT_INSTR();
+}
+
+// ============ Profile-guided Bytecodes ============
+
+// Hot instructions without a hand-written bytecode call their regular
+// handler directly, which avoids the indirect call through the handler
+// table. The list is generated from instruction profiles.
+#define LA64_PROFILED_BYTECODE(id, name)                 \
+INSTRUCTION(LA64_BC_##id, la64_profiled_##id)            \
+{                                                        \
+	InstrImpl::id(CPU(), la_instruction{DECODER().instr}); \
+	NEXT_INSTR();                                        \
+}
+#include "profiled_bytecodes.hpp"
+#undef LA64_PROFILED_BYTECODE
+
 // ============ Generic Bytecode Handlers ============
 
 // ============ LSX (SIMD) Instruction Bytecodes ============
@@ -639,6 +905,65 @@ INSTRUCTION(LA64_BC_VHADDW_D_W, la64_vhaddw_d_w)
 	NEXT_INSTR();
 }
 
+// LA64_BC_VORI_B: Vector OR immediate (vd.b[i] = vj.b[i] | ui8)
+INSTRUCTION(LA64_BC_VORI_B, la64_vori_b)
+{
+	auto fi = *(FasterLA64_RI8 *)&DECODER().instr;
+	auto& dst = REGISTERS().getvr(fi.rd);
+	const auto& src = REGISTERS().getvr(fi.rj);
+	const uint64_t imm = 0x0101010101010101ull * fi.imm;
+	dst.du[0] = src.du[0] | imm;
+	dst.du[1] = src.du[1] | imm;
+	NEXT_INSTR();
+}
+
+// LA64_BC_VREPLGR2VR_W: Broadcast word (vd.w[i] = rj)
+INSTRUCTION(LA64_BC_VREPLGR2VR_W, la64_vreplgr2vr_w)
+{
+	auto fi = *(FasterLA64_R2 *)&DECODER().instr;
+	const uint64_t value = 0x0000000100000001ull * uint32_t(REG(fi.rj));
+	auto& dst = REGISTERS().getvr(fi.rd);
+	dst.du[0] = value;
+	dst.du[1] = value;
+	NEXT_INSTR();
+}
+
+// LA64_BC_VREPLGR2VR_D: Broadcast doubleword (vd.d[i] = rj)
+INSTRUCTION(LA64_BC_VREPLGR2VR_D, la64_vreplgr2vr_d)
+{
+	auto fi = *(FasterLA64_R2 *)&DECODER().instr;
+	const uint64_t value = REG(fi.rj);
+	auto& dst = REGISTERS().getvr(fi.rd);
+	dst.du[0] = value;
+	dst.du[1] = value;
+	NEXT_INSTR();
+}
+
+// LA64_BC_VPICKVE2GR_W: Vector element to GPR (rd = sign_ext(vj.w[ui2]))
+INSTRUCTION(LA64_BC_VPICKVE2GR_W, la64_vpickve2gr_w)
+{
+	auto fi = *(FasterLA64_RI8 *)&DECODER().instr;
+	REG(fi.rd) = (int64_t)(int32_t)REGISTERS().getvr(fi.rj).wu[fi.imm];
+	NEXT_INSTR();
+}
+
+// LA64_BC_VPICKVE2GR_D: Vector element to GPR (rd = vj.d[ui1])
+INSTRUCTION(LA64_BC_VPICKVE2GR_D, la64_vpickve2gr_d)
+{
+	auto fi = *(FasterLA64_RI8 *)&DECODER().instr;
+	REG(fi.rd) = REGISTERS().getvr(fi.rj).du[fi.imm];
+	NEXT_INSTR();
+}
+
+// LA64_BC_VSHUF_B: Vector byte shuffle (vd.b[i] = (vk:vj).b[va.b[i] & 31])
+INSTRUCTION(LA64_BC_VSHUF_B, la64_vshuf_b)
+{
+	auto fi = *(FasterLA64_4R *)&DECODER().instr;
+	simd::vshuf_b(REGISTERS().getvr(fi.rd), REGISTERS().getvr(fi.rj),
+		REGISTERS().getvr(fi.rk), REGISTERS().getvr(fi.ra));
+	NEXT_INSTR();
+}
+
 // LA64_BC_XVLD: LASX 256-bit vector load
 INSTRUCTION(LA64_BC_XVLD, la64_xvld)
 {
@@ -679,6 +1004,33 @@ INSTRUCTION(LA64_BC_XVSTX, la64_xvstx)
 	NEXT_INSTR();
 }
 
+// LA64_BC_XVFMADD_D: LASX vector fused multiply-add double (xd = xa + xj * xk)
+INSTRUCTION(LA64_BC_XVFMADD_D, la64_xvfmadd_d)
+{
+	auto fi = *(FasterLA64_4R *)&DECODER().instr;
+	auto& dst = REGISTERS().getvr(fi.rd);
+	const auto& src_j = REGISTERS().getvr(fi.rj);
+	const auto& src_k = REGISTERS().getvr(fi.rk);
+	const auto& src_a = REGISTERS().getvr(fi.ra);
+
+	dst.df[0] = src_a.df[0] + src_j.df[0] * src_k.df[0];
+	dst.df[1] = src_a.df[1] + src_j.df[1] * src_k.df[1];
+	dst.df[2] = src_a.df[2] + src_j.df[2] * src_k.df[2];
+	dst.df[3] = src_a.df[3] + src_j.df[3] * src_k.df[3];
+	NEXT_INSTR();
+}
+
+// LSX/LASX 3R bytecodes: the operation gets the pre-extracted vd, vj and vk
+#define LA64_VECTOR_BYTECODE(id, name, ...)            \
+INSTRUCTION(LA64_BC_##id, la64_vector_##id)            \
+{                                                      \
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;      \
+	__VA_ARGS__(REGISTERS(), fi.rd, fi.rj, fi.rk);     \
+	NEXT_INSTR();                                      \
+}
+#include "vector_bytecodes.hpp"
+#undef LA64_VECTOR_BYTECODE
+
 // LA64_BC_FMADD_D: Fused multiply-add double precision
 INSTRUCTION(LA64_BC_FMADD_D, la64_fmadd_d)
 {
@@ -713,6 +1065,139 @@ INSTRUCTION(LA64_BC_FSTX_D, la64_fstx_d)
 	NEXT_INSTR();
 }
 
+// LA64_BC_FLD_S: Floating-point load word
+INSTRUCTION(LA64_BC_FLD_S, la64_fld_s)
+{
+	auto fi = *(FasterLA64_RI12 *)&DECODER().instr;
+	const auto addr = REG(fi.rj) + fi.imm;
+	uint32_t val = MACHINE().memory.template read<uint32_t, true>(addr);
+	auto& vr = REGISTERS().getvr(fi.rd);
+	vr.wu[0] = val;
+	vr.wu[1] = 0;
+	vr.du[1] = 0;
+	NEXT_INSTR();
+}
+
+// LA64_BC_FST_S: Floating-point store word
+INSTRUCTION(LA64_BC_FST_S, la64_fst_s)
+{
+	auto fi = *(FasterLA64_RI12 *)&DECODER().instr;
+	const auto addr = REG(fi.rj) + fi.imm;
+	const auto& vr = REGISTERS().getvr(fi.rd);
+	MACHINE().memory.template write<uint32_t, true>(addr, vr.wu[0]);
+	NEXT_INSTR();
+}
+
+// LA64_BC_FADD_S: Floating-point add single
+INSTRUCTION(LA64_BC_FADD_S, la64_fadd_s)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const auto& vr_j = REGISTERS().getvr(fi.rj);
+	const auto& vr_k = REGISTERS().getvr(fi.rk);
+	auto& vr_d = REGISTERS().getvr(fi.rd);
+	vr_d.f[0] = vr_j.f[0] + vr_k.f[0];
+	NEXT_INSTR();
+}
+
+// LA64_BC_FSUB_S: Floating-point subtract single
+INSTRUCTION(LA64_BC_FSUB_S, la64_fsub_s)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const auto& vr_j = REGISTERS().getvr(fi.rj);
+	const auto& vr_k = REGISTERS().getvr(fi.rk);
+	auto& vr_d = REGISTERS().getvr(fi.rd);
+	vr_d.f[0] = vr_j.f[0] - vr_k.f[0];
+	NEXT_INSTR();
+}
+
+// LA64_BC_FMUL_S: Floating-point multiply single
+INSTRUCTION(LA64_BC_FMUL_S, la64_fmul_s)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const auto& vr_j = REGISTERS().getvr(fi.rj);
+	const auto& vr_k = REGISTERS().getvr(fi.rk);
+	auto& vr_d = REGISTERS().getvr(fi.rd);
+	vr_d.f[0] = vr_j.f[0] * vr_k.f[0];
+	NEXT_INSTR();
+}
+
+// LA64_BC_FDIV_S: Floating-point divide single
+INSTRUCTION(LA64_BC_FDIV_S, la64_fdiv_s)
+{
+	auto fi = *(FasterLA64_R3 *)&DECODER().instr;
+	const auto& vr_j = REGISTERS().getvr(fi.rj);
+	const auto& vr_k = REGISTERS().getvr(fi.rk);
+	auto& vr_d = REGISTERS().getvr(fi.rd);
+	vr_d.f[0] = vr_j.f[0] / vr_k.f[0];
+	NEXT_INSTR();
+}
+
+// LA64_BC_FMADD_S: Fused multiply-add single precision
+INSTRUCTION(LA64_BC_FMADD_S, la64_fmadd_s)
+{
+	// 4R-type format: fd = fa + fj * fk
+	auto fi = *(FasterLA64_4R *)&DECODER().instr;
+	const auto& vr_j = REGISTERS().getvr(fi.rj);
+	const auto& vr_k = REGISTERS().getvr(fi.rk);
+	const auto& vr_a = REGISTERS().getvr(fi.ra);
+	auto& vr_d = REGISTERS().getvr(fi.rd);
+
+	vr_d.f[0] = vr_a.f[0] + vr_j.f[0] * vr_k.f[0];
+	NEXT_INSTR();
+}
+
+// LA64_BC_FMOV_S: Floating-point move single
+INSTRUCTION(LA64_BC_FMOV_S, la64_fmov_s)
+{
+	auto fi = *(FasterLA64_R2 *)&DECODER().instr;
+	REGISTERS().getvr(fi.rd).f[0] = REGISTERS().getvr(fi.rj).f[0];
+	NEXT_INSTR();
+}
+
+// LA64_BC_FMOV_D: Floating-point move double
+INSTRUCTION(LA64_BC_FMOV_D, la64_fmov_d)
+{
+	auto fi = *(FasterLA64_R2 *)&DECODER().instr;
+	REGISTERS().getvr(fi.rd).du[0] = REGISTERS().getvr(fi.rj).du[0];
+	NEXT_INSTR();
+}
+
+// LA64_BC_FCVT_S_D: Convert double to single
+INSTRUCTION(LA64_BC_FCVT_S_D, la64_fcvt_s_d)
+{
+	auto fi = *(FasterLA64_R2 *)&DECODER().instr;
+	REGISTERS().getvr(fi.rd).f[0] = static_cast<float>(REGISTERS().getvr(fi.rj).df[0]);
+	NEXT_INSTR();
+}
+
+// LA64_BC_FCVT_D_S: Convert single to double
+INSTRUCTION(LA64_BC_FCVT_D_S, la64_fcvt_d_s)
+{
+	auto fi = *(FasterLA64_R2 *)&DECODER().instr;
+	REGISTERS().getvr(fi.rd).df[0] = static_cast<double>(REGISTERS().getvr(fi.rj).f[0]);
+	NEXT_INSTR();
+}
+
+// LA64_BC_FCMP_COND_S: Floating-point compare single (condition code validated at decode)
+INSTRUCTION(LA64_BC_FCMP_COND_S, la64_fcmp_cond_s)
+{
+	auto fi = *(FasterLA64_FCmp *)&DECODER().instr;
+	const bool result = InstructionHelpers::fcmp_condition(fi.cond,
+		REGISTERS().getvr(fi.fj).f[0], REGISTERS().getvr(fi.fk).f[0]);
+	REGISTERS().set_cf(fi.cd, result);
+	NEXT_INSTR();
+}
+
+// LA64_BC_FCMP_COND_D: Floating-point compare double (condition code validated at decode)
+INSTRUCTION(LA64_BC_FCMP_COND_D, la64_fcmp_cond_d)
+{
+	auto fi = *(FasterLA64_FCmp *)&DECODER().instr;
+	const bool result = InstructionHelpers::fcmp_condition(fi.cond,
+		REGISTERS().getvr(fi.fj).df[0], REGISTERS().getvr(fi.fk).df[0]);
+	REGISTERS().set_cf(fi.cd, result);
+	NEXT_INSTR();
+}
+
 // LA64_BC_BCEQZ: Branch if condition flag equals zero
 INSTRUCTION(LA64_BC_BCEQZ, la64_bceqz)
 {
@@ -1042,7 +1527,8 @@ INSTRUCTION(LA64_BC_FUNCTION2, execute_function_extended)
 // LA64_BC_TRANSLATOR is implemented in each dispatch file separately
 
 INSTRUCTION(LA64_BC_LIVEPATCH, execute_livepatch) {
-	switch (DECODER().handler_idx) {
+	// Acquire, as the patched decoder cache was filled by another thread
+	switch (DECODER().load_acquire().handler_idx) {
 	case 0: { // Live-patch binary translation
 #ifdef LA_BINARY_TRANSLATION
 		// Special bytecode that does not read any decoder data
@@ -1050,15 +1536,15 @@ INSTRUCTION(LA64_BC_LIVEPATCH, execute_livepatch) {
 		pc = RECONSTRUCT_PC();
 #  ifdef DISPATCH_MODE_TAILCALL
 		// 2. Find the correct decoder pointer in the patched decoder cache
-		auto* patched = &exec->patched_decoder_cache() - (exec->exec_begin() >> DecoderCache::SHIFT);
+		auto* patched = exec->patched_decoder_cache() - (exec->exec_begin() >> DecoderCache::SHIFT);
 		d = &patched[pc >> DecoderCache::SHIFT];
+		// 3. Execute the instruction
+		EXECUTE_CURRENT();
 #  else
 		// 2. Find the correct decoder pointer in the patched decoder cache
 		exec_decoder = exec->patched_decoder_cache() - (exec->exec_begin() >> DecoderCache::SHIFT);
 		goto continue_segment;
 #  endif
-		// 3. Execute the instruction
-		EXECUTE_INSTR();
 #else
 		// Invalid handler
 		DECODER().set_bytecode(LA64_BC_INVALID);
@@ -1070,5 +1556,9 @@ INSTRUCTION(LA64_BC_LIVEPATCH, execute_livepatch) {
 		DECODER().set_bytecode(LA64_BC_INVALID);
 		DECODER().handler_idx = 0;
 	}
+#ifdef DISPATCH_MODE_TAILCALL
+	EXECUTE_CURRENT();
+#else
 	EXECUTE_INSTR();
+#endif
 }
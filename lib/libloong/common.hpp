@@ -74,7 +74,33 @@ namespace loongarch
 		bool translate_verbose_fallbacks = false;
 		size_t translate_blocks_max = 10000;
 		size_t translate_instr_max = 50'000'000ull;
-		std::string translate_output_file; // Optional: output file path for generated C code
+		std::string translate_output_file; // Optional: output file path for generated C code (unit N goes to file.N.c)
+		/// @brief Compile translations ahead of time with the system C compiler.
+		/// @details The generated C code is compiled into a shared object, which is
+		/// loaded with dlopen and validated by the CRC32-C of its source. This takes
+		/// much longer than libtcc, but produces much faster code. Builds without
+		/// libtcc (LA_LIBTCC=OFF) always use the system compiler.
+		bool translate_use_system_compiler = false;
+		/// @brief The system C compiler. Default: $CC, or cc when it is not set.
+		std::string translate_compiler;
+		/// @brief Optimization flags for the system compiler. -O3 was measured
+		/// to be slower than -O2 on the large translated functions.
+		std::string translate_compiler_flags = "-O2";
+		/// @brief Directory for caching shared objects from the system compiler.
+		/// @details A translation is reused when the execute segment CRC32-C, the
+		/// arena layout, the translation options, the compiler and the host program
+		/// all match. A cache hit skips C code generation and compilation. Empty
+		/// disables the cache.
+		std::string translate_cache_dir;
+		/// @brief Tiered translation: translate only blocks that become hot.
+		/// @details When non-zero, the execute segment is not translated up
+		/// front. simulate() counts block entries instead, and a block entered
+		/// this many times (rounded up to a power of two) is queued for
+		/// translation together with the other hot blocks. Each round compiles
+		/// only the code regions that contain queued blocks, and is installed
+		/// by live-patching, in the background when a callback is set.
+		/// The on-disk cache is not used. Zero translates everything up front.
+		uint32_t translate_hot_threshold = 0;
 #endif
 	};
 
@@ -126,6 +152,21 @@ namespace loongarch
 			: MachineException(MACHINE_TIMEOUT, "Machine instruction timeout") {}
 	};
 
+	// A guest fault returned instead of thrown, see Machine::try_simulate()
+	struct GuestFault {
+		ExceptionType type = ILLEGAL_OPCODE;
+		uint64_t  data = 0;            // Same as MachineException::data()
+		address_t pc = 0;              // PC of the faulting instruction
+		const char* message = nullptr; // Static string, nullptr when there was no fault
+
+		explicit operator bool() const noexcept { return message != nullptr; }
+		// For callers that want the exception after all
+		void throw_if_fault() const {
+			if (message != nullptr)
+				throw MachineException(type, message, data);
+		}
+	};
+
 	struct Arena;
 
 	// Compiler attributes
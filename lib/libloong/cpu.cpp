@@ -1,5 +1,6 @@
 #include "cpu.hpp"
 #include "machine.hpp"
+#include "threaded_bytecodes.hpp"
 #include <cstdio>
 
 namespace loongarch
@@ -20,14 +21,16 @@ namespace loongarch
 	}
 
 	CPU::CPU(Machine& machine)
-		: m_machine(machine), m_exec(empty_execute_segment().get())
+		: m_machine(machine), m_exec(empty_execute_segment().get()),
+		  m_last_exec(empty_execute_segment().get())
 	{
 		// Don't call reset() here - memory isn't loaded yet!
 		// reset() will be called by Machine after memory is initialized
 	}
 
 	CPU::CPU(Machine& machine, const Machine& other)
-		: m_machine(machine), m_exec(other.cpu.m_exec)
+		: m_machine(machine), m_exec(other.cpu.m_exec),
+		  m_last_exec(empty_execute_segment().get())
 	{
 		m_regs = other.cpu.m_regs;
 	}
@@ -41,7 +44,7 @@ namespace loongarch
 		m_regs.get(REG_SP) = machine().memory.stack_address();
 	}
 
-	void CPU::trigger_exception(ExceptionType type, address_t data)
+	const char* CPU::exception_message(ExceptionType type) noexcept
 	{
 		const char* msg = "Unknown exception";
 		switch (type) {
@@ -58,7 +61,30 @@ namespace loongarch
 			case UNIMPLEMENTED_SYSCALL: msg = "Unimplemented syscall"; break;
 			case GUEST_ABORT: msg = "Guest abort"; break;
 		}
-		throw MachineException(type, msg, data);
+		return msg;
+	}
+
+	void CPU::trigger_exception(ExceptionType type, address_t data)
+	{
+		trigger_exception(type, data, exception_message(type));
+	}
+
+	void CPU::trigger_exception(ExceptionType type, address_t data, const char* message)
+	{
+		if (FaultTrap* trap = m_fault_trap) {
+			trap->fault = GuestFault{type, data, 0, message};
+			std::longjmp(trap->jump, 1);
+		}
+		throw MachineException(type, message, data);
+	}
+
+	address_t CPU::pc_of(const DecoderData* entry) const noexcept
+	{
+		const DecoderData* cache = m_exec->decoder_cache();
+		const size_t count = (m_exec->exec_end() - m_exec->exec_begin()) >> DecoderCache::SHIFT;
+		if (entry != nullptr && entry >= cache && entry < cache + count)
+			return m_exec->exec_begin() + (address_t(entry - cache) << DecoderCache::SHIFT);
+		return pc();
 	}
 
 	typename CPU::format_t CPU::read_current_instruction() const
@@ -74,8 +100,8 @@ namespace loongarch
 
 	bool CPU::is_executable(address_t addr) const noexcept
 	{
-		auto segment = memory().exec_segment_for(addr);
-		return segment != nullptr;
+		return memory().find_execute_segment(addr) != nullptr
+			|| memory().is_jit_executable(addr);
 	}
 
 	DecodedExecuteSegment& CPU::init_execute_area(
@@ -87,19 +113,46 @@ namespace loongarch
 		}
 		auto& segment = machine().memory.create_execute_segment(
 			machine().options(), data, begin, length, true);
-		this->m_exec = &segment;
+		this->set_execute_segment(segment);
 		return segment;
 	}
 
 	typename CPU::NextExecuteReturn CPU::next_execute_segment(address_t pc)
 	{
-		auto segment = machine().memory.exec_segment_for(pc);
-		if (segment->empty()) {
-			throw MachineException(EXECUTION_SPACE_PROTECTION_FAULT,
-				"Jump outside execute segment", pc);
+		DecodedExecuteSegment* segment = this->m_exec;
+		if (!segment->is_within(pc)) {
+			// Programs tend to bounce between two segments (eg. main
+			// program and a JIT area), so remember the one we left.
+			segment = this->m_last_exec;
+			if (!segment->is_within(pc)) {
+				segment = machine().memory.find_execute_segment(pc);
+				if (segment == nullptr) {
+					// Guest-generated code is decoded on first use
+					segment = machine().memory.create_jit_segment_for(pc);
+				}
+				if (LA_UNLIKELY(segment == nullptr)) {
+					trigger_exception(EXECUTION_SPACE_PROTECTION_FAULT, pc,
+						"Jump outside execute segment");
+				}
+			}
+			this->m_last_exec = this->m_exec;
+			this->set_execute_segment(*segment);
 		}
-		this->m_exec = segment.get();
-		return {this->m_exec, pc};
+		return {segment, pc};
+	}
+
+	void CPU::reset_execute_segment_cache() noexcept
+	{
+		this->m_last_exec = empty_execute_segment().get();
+	}
+
+	void CPU::clear_return_stack(DecodedExecuteSegment& exec) noexcept
+	{
+		// Unused entries predict the start of the segment, which is
+		// always a valid decoder entry, so no prediction can go stale.
+		DecoderData* entry = exec.pc_relative_decoder_cache(exec.exec_begin());
+		for (auto& prediction : m_return_stack)
+			prediction = {exec.exec_begin(), entry};
 	}
 
 	std::string CPU::to_string(format_t format) const
@@ -155,13 +208,6 @@ namespace loongarch
 		}
 	}
 
-	void CPU::simulate_precise()
-	{
-		while (machine().instruction_counter() < machine().max_instructions()) {
-			step_one(true);
-		}
-	}
-
 	std::string Registers::to_string() const
 	{
 		char buffer[4096];
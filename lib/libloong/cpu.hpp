@@ -3,6 +3,8 @@
 #include "registers.hpp"
 #include "la_instr.hpp"
 #include "decoded_exec_segment.hpp"
+#include <array>
+#include <csetjmp>
 #include <functional>
 #include <memory>
 
@@ -24,9 +26,30 @@ namespace loongarch
 
 		// Simulation methods
 		bool simulate(address_t pc, uint64_t icounter, uint64_t maxcounter);
+		// simulate() that also counts block entries (see Machine::set_block_profiling)
+		bool simulate_block_profiling(address_t pc, uint64_t icounter, uint64_t maxcounter);
+		// simulate() that calls the dispatch tracer on every block entry (see Machine::set_dispatch_tracer)
+		bool simulate_tracing(address_t pc, uint64_t icounter, uint64_t maxcounter);
+		// simulate() that keeps the current decoder entry in the armed fault trap
+		// (see FaultTrap), so that a trapped fault has an exact PC
+		bool simulate_trapping(address_t pc, uint64_t icounter, uint64_t maxcounter);
+#ifdef LA_BINARY_TRANSLATION
+		// simulate() that counts block entries and translates hot blocks
+		// (see MachineOptions::translate_hot_threshold)
+		bool simulate_tiering(address_t pc, uint64_t icounter, uint64_t maxcounter);
+#endif
 		void simulate_inaccurate(address_t pc);
+		// simulate_inaccurate() that also stops when Machine::stop_flag() is raised.
+		// Returns false when stopped by the flag, which is then cleared.
+		bool simulate_watchdog(address_t pc);
+		// Counts every instruction, and stops exactly at the instruction limit
+		// A separate dispatch loop that runs one bytecode per instruction.
 		void simulate_precise();
+		// Execute one instruction, read and decoded from guest memory
 		void step_one(bool use_instruction_counter = true);
+		// step_one() using the decoder cache of the current execute segment
+		// Like the other dispatch modes, it doesn't see code changed after decoding.
+		void step_decoded(bool use_instruction_counter = true);
 
 		// Register access
 		LA_ALWAYS_INLINE auto& registers() noexcept { return m_regs; }
@@ -65,7 +88,7 @@ namespace loongarch
 
 		// Execute segments
 		DecodedExecuteSegment& init_execute_area(const void* data, address_t begin, address_t length);
-		void set_execute_segment(DecodedExecuteSegment& seg) noexcept { m_exec = &seg; }
+		void set_execute_segment(DecodedExecuteSegment& seg) noexcept { m_exec = &seg; clear_return_stack(seg); }
 		auto& current_execute_segment() noexcept { return *m_exec; }
 		auto& current_execute_segment() const noexcept { return *m_exec; }
 
@@ -75,6 +98,38 @@ namespace loongarch
 			address_t pc;
 		};
 		NextExecuteReturn next_execute_segment(address_t pc);
+		// Forget the last-hit segment (required when segments are evicted)
+		void reset_execute_segment_cache() noexcept;
+
+		// Pins the segment a dispatch loop is running in while it calls out
+		// to the host (system calls, translated code). Invalidated segments
+		// are kept alive for as long as they are pinned.
+		struct ExecutePin {
+			ExecutePin(CPU& cpu, const DecodedExecuteSegment* exec) noexcept
+				: m_cpu(cpu), m_exec(exec), m_prev(cpu.m_exec_pins) { cpu.m_exec_pins = this; }
+			~ExecutePin() { m_cpu.m_exec_pins = m_prev; }
+			CPU& m_cpu;
+			const DecodedExecuteSegment* const m_exec;
+			ExecutePin* const m_prev;
+		};
+		bool is_execute_pinned(const DecodedExecuteSegment& exec) const noexcept {
+			for (const ExecutePin* pin = m_exec_pins; pin != nullptr; pin = pin->m_prev)
+				if (pin->m_exec == &exec)
+					return true;
+			return false;
+		}
+		// Fault traps longjmp past pins, so try_simulate() restores them
+		ExecutePin* execute_pins() const noexcept { return m_exec_pins; }
+		void restore_execute_pins(ExecutePin* pins) noexcept { m_exec_pins = pins; }
+
+		// Return address prediction for the interpreter (LA64_BC_RET)
+		// Predictions always point into the current execute segment, and
+		// are cleared whenever the current execute segment changes.
+		static constexpr unsigned RETURN_STACK_SIZE = 16;
+		void push_return_address(const DecodedExecuteSegment& exec, address_t pc, DecoderData* entry) noexcept;
+		// Pops a prediction, returning its decoder entry if it matches pc
+		DecoderData* predict_return(address_t pc) noexcept;
+		void clear_return_stack(DecodedExecuteSegment& exec) noexcept;
 
 		static std::shared_ptr<DecodedExecuteSegment>& empty_execute_segment() noexcept;
 		bool is_executable(address_t addr) const noexcept;
@@ -82,6 +137,35 @@ namespace loongarch
 		// Exception handling
 		[[noreturn]]
 		static void trigger_exception(ExceptionType type, address_t data = 0);
+		[[noreturn]] LA_COLD_PATH()
+		static void trigger_exception(ExceptionType type, address_t data, const char* message);
+		// Generic message for an exception type
+		static const char* exception_message(ExceptionType type) noexcept;
+
+		// While a fault trap is armed on this thread, trigger_exception() records
+		// the fault in it and longjmps back instead of throwing. Only
+		// Machine::try_simulate() arms one, and only around guest instructions:
+		// system call handlers may hold resources, so they see exceptions.
+		struct FaultTrap {
+			std::jmp_buf jump;
+			GuestFault fault;
+			const DecoderData* decoder = nullptr; // Entry being executed
+		};
+		static FaultTrap* armed_fault_trap() noexcept { return m_fault_trap; }
+		// Returns the previously armed trap
+		static FaultTrap* arm_fault_trap(FaultTrap* trap) noexcept {
+			FaultTrap* previous = m_fault_trap;
+			m_fault_trap = trap;
+			return previous;
+		}
+		// Disarms the trap for the lifetime of the object
+		struct FaultTrapPause {
+			FaultTrapPause() noexcept : m_trap(arm_fault_trap(nullptr)) {}
+			~FaultTrapPause() { arm_fault_trap(m_trap); }
+			FaultTrap* const m_trap;
+		};
+		// The PC of a decoder entry in the current execute segment, or pc()
+		address_t pc_of(const DecoderData* entry) const noexcept;
 
 		// Debug support
 		std::string to_string(format_t format) const;
@@ -94,10 +178,25 @@ namespace loongarch
 		static const instruction_t& get_unimplemented_instruction() noexcept;
 
 	private:
+		// The threaded dispatch loop, instantiated per DispatchPolicy
+		template <typename Policy>
+		bool dispatch(address_t pc, uint64_t icounter, uint64_t maxcounter);
+
 		Registers m_regs;
 		Machine& m_machine;
 		DecodedExecuteSegment* m_exec;
+		DecodedExecuteSegment* m_last_exec; // Last-hit cache for next_execute_segment()
+		ExecutePin* m_exec_pins = nullptr;
 		bool m_ll_bit = false; // LL/SC linked-load bit
+
+		struct ReturnPrediction {
+			address_t pc;
+			DecoderData* entry;
+		};
+		unsigned m_return_index = 0;
+		std::array<ReturnPrediction, RETURN_STACK_SIZE> m_return_stack {};
+
+		static inline thread_local FaultTrap* m_fault_trap = nullptr;
 	};
 
 } // namespace loongarch
@@ -128,4 +128,50 @@ namespace loongarch
 		m_regs.pc = local_pc;
 	}
 
+	bool CPU::simulate_watchdog(address_t local_pc)
+	{
+		DecodedExecuteSegment* exec = m_exec;
+		address_t exec_begin = exec->exec_begin();
+		address_t exec_end = exec->exec_end();
+		DecoderData* cache = exec->pc_relative_decoder_cache();
+		std::atomic<bool>& stop_flag = machine().stop_flag();
+
+		machine().set_max_instructions(UINT64_MAX);
+		while (machine().max_instructions()) {
+			// The handler dispatch is slow enough to poll on every block
+			if (LA_UNLIKELY(stop_flag.load(std::memory_order_relaxed))) {
+				m_regs.pc = local_pc;
+				stop_flag.store(false, std::memory_order_relaxed);
+				return false;
+			}
+			if (LA_UNLIKELY(local_pc < exec_begin || local_pc >= exec_end)) {
+				m_regs.pc = local_pc;
+				auto result = next_execute_segment(local_pc); // Never null
+				exec = result.exec;
+				local_pc = result.pc;
+
+				exec_begin = exec->exec_begin();
+				exec_end = exec->exec_end();
+				cache = exec->pc_relative_decoder_cache();
+			}
+
+			auto* decoder = &cache[local_pc >> DecoderCache::SHIFT];
+			unsigned block_bytes = decoder->block_bytes;
+			local_pc += block_bytes;
+
+			while (block_bytes >= 4) {
+				decoder->handler(*this, la_instruction{decoder->instr});
+				decoder += 1;
+				block_bytes -= 4;
+			}
+
+			m_regs.pc = local_pc;
+			decoder->handler(*this, la_instruction{decoder->instr});
+			local_pc = m_regs.pc + 4;
+		}
+
+		m_regs.pc = local_pc;
+		return true;
+	}
+
 } // loongarch
@@ -25,4 +25,18 @@ namespace loongarch
 		this->m_regs.pc = addr;
 	}
 
+	inline void CPU::push_return_address(const DecodedExecuteSegment& exec, address_t pc, DecoderData* entry) noexcept {
+		// A call at the very end of the segment returns into another segment
+		if (LA_LIKELY(pc < exec.exec_end())) {
+			m_return_index = (m_return_index + 1) % RETURN_STACK_SIZE;
+			m_return_stack[m_return_index] = {pc, entry};
+		}
+	}
+
+	inline DecoderData* CPU::predict_return(address_t pc) noexcept {
+		const auto& prediction = m_return_stack[m_return_index];
+		m_return_index = (m_return_index - 1) % RETURN_STACK_SIZE;
+		return (prediction.pc == pc) ? prediction.entry : nullptr;
+	}
+
 } // loongarch
@@ -12,7 +12,7 @@ namespace loongarch
 		while (!this->machine.stopped()) {
 			if (this->verbose_instructions)
 				print_instruction();
-			this->machine.cpu.step_one();
+			this->machine.cpu.step_decoded();
 			if (this->machine.cpu.reg(0) != 0) {
 				print_registers();
 				throw MachineException(PROTECTION_FAULT, "Zero register R0 modified");
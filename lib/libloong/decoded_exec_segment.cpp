@@ -1,8 +1,83 @@
 #include "decoded_exec_segment.hpp"
 #include "machine.hpp"
+#include <algorithm>
+#include <cstring>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <map>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace loongarch
 {
+#if defined(__linux__)
+	// The decoder caches of all shared segments live in one anonymous file,
+	// so that overlays can map their pages privately (copy-on-write) while
+	// the process holds a single file descriptor for any number of segments.
+	struct SharedDecoderFile {
+		int fd = memfd_create("libloong-decoder-caches", MFD_CLOEXEC);
+		const size_t page_size = sysconf(_SC_PAGESIZE);
+		size_t file_size = 0;
+		std::map<size_t, size_t> free_ranges; // Offset -> bytes
+		std::mutex mutex;
+
+		size_t round_up(size_t bytes) const noexcept {
+			return (bytes + page_size - 1) & ~(page_size - 1);
+		}
+
+		// Returns the offset of a range of (page-rounded) bytes, or -1
+		long allocate(size_t bytes)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (fd < 0)
+				return -1;
+			for (auto it = free_ranges.begin(); it != free_ranges.end(); ++it) {
+				if (it->second >= bytes) {
+					const size_t offset = it->first;
+					if (it->second > bytes)
+						free_ranges.emplace(offset + bytes, it->second - bytes);
+					free_ranges.erase(it);
+					return long(offset);
+				}
+			}
+			if (ftruncate(fd, file_size + bytes) != 0)
+				return -1;
+			file_size += bytes;
+			return long(file_size - bytes);
+		}
+
+		void free(size_t offset, size_t bytes)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			// Give the pages back, the range itself is reused later
+			fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, bytes);
+			auto it = free_ranges.emplace(offset, bytes).first;
+			if (auto next = std::next(it); next != free_ranges.end() && it->first + it->second == next->first) {
+				it->second += next->second;
+				free_ranges.erase(next);
+			}
+			if (it != free_ranges.begin()) {
+				if (auto prev = std::prev(it); prev->first + prev->second == it->first) {
+					prev->second += it->second;
+					free_ranges.erase(it);
+					it = prev;
+				}
+			}
+			// Shrink the file when its tail is free
+			if (it->first + it->second == file_size && ftruncate(fd, it->first) == 0) {
+				file_size = it->first;
+				free_ranges.erase(it);
+			}
+		}
+	};
+	// Never destroyed, as shared segments may outlive static destruction
+	static SharedDecoderFile& shared_decoder_file()
+	{
+		static SharedDecoderFile* file = new SharedDecoderFile;
+		return *file;
+	}
+#endif
 
 #ifdef LA_BINARY_TRANSLATION
 	// Forward declaration from tr_compiler.cpp
@@ -31,32 +106,255 @@ namespace loongarch
 			return !m_is_background_compiling;
 		});
 	}
+
+	long DecodedExecuteSegment::add_translator_handlers(const bintr_block_func* handlers, size_t count)
+	{
+		bintr_block_func* table = m_translator_handlers.load(std::memory_order_relaxed);
+		if (table == nullptr) {
+			// Every translated function has at least one decoder cache entry
+			m_translator_handlers_capacity = std::max(m_decoder_cache.size, count);
+			table = new bintr_block_func[m_translator_handlers_capacity]();
+			m_translator_handlers.store(table, std::memory_order_release);
+		}
+		if (count > m_translator_handlers_capacity - m_translator_handlers_size)
+			return -1;
+		const size_t first = m_translator_handlers_size;
+		std::copy(handlers, handlers + count, table + first);
+		m_translator_handlers_size += count;
+		return long(first);
+	}
+
+	// Decoder entries may be executing in other threads while they are
+	// patched, so they are replaced as a whole, never field by field
+	void DecodedExecuteSegment::live_patch(address_t addr, const DecoderData& data)
+	{
+		static_assert(sizeof(DecoderData) == sizeof(uint64_t));
+		auto* entry = pc_relative_decoder_cache(addr);
+		uint64_t original, bits;
+		std::memcpy(&bits, &data, sizeof(bits));
+		// Overlays copy the base under the same lock
+		std::lock_guard<std::mutex> lock(m_overlays_mutex);
+		original = __atomic_exchange_n(reinterpret_cast<uint64_t*>(entry), bits, __ATOMIC_RELEASE);
+
+		// Overlay entries that still match the base are patched the same
+		// way. Entries the overlay patched itself keep the overlay patch.
+		for (DecodedExecuteSegment* overlay : m_overlays) {
+			auto* overlay_entry = reinterpret_cast<uint64_t*>(overlay->pc_relative_decoder_cache(addr));
+			// Pages the overlay has not copied already see the new entry,
+			// and a compare-exchange would copy them even when it fails
+			uint64_t expected = original;
+			if (__atomic_load_n(overlay_entry, __ATOMIC_RELAXED) == original)
+				__atomic_compare_exchange_n(overlay_entry, &expected, bits, false,
+					__ATOMIC_RELEASE, __ATOMIC_RELAXED);
+		}
+	}
 #endif
 
-	DecodedExecuteSegment::~DecodedExecuteSegment()
+	uint64_t* DecodedExecuteSegment::allocate_block_counts()
+	{
+		// Machines sharing the segment may race to allocate the counts
+		auto* counts = new uint64_t[m_decoder_cache.size]();
+		uint64_t* current = nullptr;
+		if (!m_block_counts.compare_exchange_strong(current, counts, std::memory_order_acq_rel)) {
+			delete[] counts;
+			return current;
+		}
+		return counts;
+	}
+
+	void DecodedExecuteSegment::reset_block_counts() noexcept
+	{
+		DecodedExecuteSegment& owner = m_overlay_base ? *m_overlay_base : *this;
+		uint64_t* counts = owner.m_block_counts.load(std::memory_order_acquire);
+		if (counts == nullptr)
+			return;
+		// Other machines may still be counting
+		for (size_t i = 0; i < owner.m_decoder_cache.size; i++)
+			__atomic_store_n(&counts[i], 0, __ATOMIC_RELAXED);
+	}
+
+	DecoderData* DecodedExecuteSegment::allocate_decoder_cache(size_t entries, bool shareable)
+	{
+		free_decoder_cache();
+#if defined(__linux__)
+		if (shareable) {
+			auto& file = shared_decoder_file();
+			const size_t bytes = file.round_up(entries * sizeof(DecoderData));
+			const long offset = file.allocate(bytes);
+			if (offset >= 0) {
+				void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, offset);
+				if (ptr != MAP_FAILED) {
+					m_decoder_mapping_offset = offset;
+					m_decoder_mapping_size = bytes;
+					set_decoder_cache(static_cast<DecoderData*>(ptr), entries - 1);
+					return m_decoder_cache.cache;
+				}
+				file.free(offset, bytes);
+			}
+			// Fall back to a regular allocation
+		}
+#else
+		(void)shareable;
+#endif
+		set_decoder_cache(new DecoderData[entries], entries - 1);
+		return m_decoder_cache.cache;
+	}
+
+	void DecodedExecuteSegment::free_decoder_cache() noexcept
+	{
+		if (m_decoder_cache.cache == nullptr)
+			return;
+#if defined(__linux__)
+		if (m_decoder_mapping_size != 0) {
+			munmap(m_decoder_cache.cache, m_decoder_mapping_size);
+			// Overlays only map the range of their base
+			if (!m_overlay_base)
+				shared_decoder_file().free(m_decoder_mapping_offset, m_decoder_mapping_size);
+			m_decoder_mapping_size = 0;
+			m_decoder_cache.cache = nullptr;
+			return;
+		}
+#endif
+		delete[] m_decoder_cache.cache;
+		m_decoder_cache.cache = nullptr;
+	}
+
+	std::shared_ptr<DecodedExecuteSegment> DecodedExecuteSegment::create_overlay(
+		const std::shared_ptr<DecodedExecuteSegment>& base)
+	{
+		auto overlay = std::make_shared<DecodedExecuteSegment>(base->exec_begin(), base->exec_end());
+		overlay->m_crc32c_hash = base->m_crc32c_hash;
+		overlay->m_execute_only = base->m_execute_only;
+		overlay->m_overlay_base = base;
+		overlay->m_folded_constants = base->m_folded_constants;
+		overlay->m_folded_heads = base->m_folded_heads;
+		overlay->m_chained_blocks = base->m_chained_blocks;
+		overlay->m_chain_sources = base->m_chain_sources;
+#ifdef LA_INSTRUCTION_PROFILING
+		overlay->m_profile = base->m_profile;
+#endif
+
+		// The base may be live-patched by its background compilation
+		// while we copy, so copy under the lock that live-patches take
+		const size_t entries = base->decoder_cache_size() + 1;
+#ifdef LA_BINARY_TRANSLATION
+		std::lock_guard<std::mutex> lock(base->m_overlays_mutex);
+#endif
+		DecoderData* cache = nullptr;
+#if defined(__linux__)
+		if (base->m_decoder_mapping_size != 0) {
+			// Private mapping of the base pages: only pages that are
+			// patched by this machine get copied by the kernel.
+			void* ptr = mmap(nullptr, base->m_decoder_mapping_size, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE, shared_decoder_file().fd, base->m_decoder_mapping_offset);
+			if (ptr != MAP_FAILED) {
+				cache = static_cast<DecoderData*>(ptr);
+				overlay->m_decoder_mapping_offset = base->m_decoder_mapping_offset;
+				overlay->m_decoder_mapping_size = base->m_decoder_mapping_size;
+			}
+		}
+#endif
+		if (cache == nullptr) {
+			cache = new DecoderData[entries];
+			std::memcpy(cache, base->decoder_cache(), entries * sizeof(DecoderData));
+		}
+		overlay->set_decoder_cache(cache, base->decoder_cache_size());
+#ifdef LA_BINARY_TRANSLATION
+		base->m_overlays.push_back(overlay.get());
+#endif
+		return overlay;
+	}
+
+#ifdef LA_INSTRUCTION_PROFILING
+	DecodedExecuteSegment::ExecutionProfile& DecodedExecuteSegment::create_execution_profile(size_t size)
 	{
+		m_profile = std::make_shared<ExecutionProfile>();
+		m_profile->instructions.resize(size);
+		m_profile->counts.resize(size);
+		return *m_profile;
+	}
+#endif
+
 #ifdef LA_BINARY_TRANSLATION
-		// Close the dynamic library if we have one
-		if (m_bintr_dl) {
-			dylib_close(m_bintr_dl, m_is_libtcc);
-			m_bintr_dl = nullptr;
+	DecoderData* DecodedExecuteSegment::overlay_patched_decoder_cache()
+	{
+		// Live-patching only happens once the base has been translated
+		if (m_patched_decoder_cache.cache == nullptr) {
+			const DecoderData* base_cache = m_overlay_base->m_patched_decoder_cache.cache;
+			if (base_cache == nullptr)
+				return nullptr;
+			const size_t size = m_overlay_base->m_patched_decoder_cache.size;
+			auto* cache = new DecoderData[size];
+			std::memcpy(cache, base_cache, size * sizeof(DecoderData));
+			for (const auto& [addr, data] : m_overlay_patches)
+				cache[(addr - m_exec_begin) >> DecoderCache::SHIFT] = data;
+			set_patched_decoder_cache(cache, size);
 		}
+		return m_patched_decoder_cache.cache;
+	}
+#endif
+
+	size_t DecodedExecuteSegment::memory_usage() const noexcept
+	{
+		size_t total = sizeof(*this);
+		// The decoder cache has an extra sentinel entry at the end
+		if (m_decoder_cache.cache) {
+			const size_t bytes = (m_decoder_cache.size + 1) * sizeof(DecoderData);
+#if defined(__linux__)
+			if (m_overlay_base && m_decoder_mapping_size != 0) {
+				// Copy-on-write overlays own the pages they have patched,
+				// counted as the pages that differ from the base
+				const size_t page_size = shared_decoder_file().page_size;
+				const auto* mine = reinterpret_cast<const uint8_t*>(m_decoder_cache.cache);
+				const auto* base = reinterpret_cast<const uint8_t*>(m_overlay_base->m_decoder_cache.cache);
+				for (size_t offset = 0; offset < bytes; offset += page_size) {
+					if (std::memcmp(mine + offset, base + offset, std::min(page_size, bytes - offset)) != 0)
+						total += page_size;
+				}
+				total -= bytes;
+			}
+#endif
+			total += bytes;
+		}
+		total += m_folded_constants.capacity() * sizeof(uint64_t);
+		total += m_folded_heads.capacity() * sizeof(DecoderData);
+		if (m_block_counts.load(std::memory_order_relaxed) != nullptr)
+			total += m_decoder_cache.size * sizeof(uint64_t);
+#ifdef LA_BINARY_TRANSLATION
+		if (m_patched_decoder_cache.cache)
+			total += m_patched_decoder_cache.size * sizeof(DecoderData);
+		total += m_translator_handlers_capacity * sizeof(bintr_block_func);
+#endif
+		return total;
+	}
 
+	DecodedExecuteSegment::~DecodedExecuteSegment()
+	{
+#ifdef LA_BINARY_TRANSLATION
+		if (m_overlay_base) {
+			std::lock_guard<std::mutex> lock(m_overlay_base->m_overlays_mutex);
+			auto& overlays = m_overlay_base->m_overlays;
+			overlays.erase(std::find(overlays.begin(), overlays.end(), this));
+		}
 		// Wait for any background compilation to complete
 		wait_for_compilation_complete();
 
+		// Close the dynamic libraries
+		for (void* dylib : m_bintr_dylibs)
+			dylib_close(dylib, m_is_libtcc);
+		m_bintr_dylibs.clear();
+
 		// Clean up patched decoder cache
 		if (m_patched_decoder_cache.cache) {
 			delete[] m_patched_decoder_cache.cache;
 			m_patched_decoder_cache.cache = nullptr;
 		}
+		delete[] m_translator_handlers.load(std::memory_order_relaxed);
 #endif
 
 		// Clean up main decoder cache
-		if (m_decoder_cache.cache) {
-			delete[] m_decoder_cache.cache;
-			m_decoder_cache.cache = nullptr;
-		}
+		free_decoder_cache();
+		delete[] m_block_counts.load(std::memory_order_relaxed);
 	}
 
 } // namespace loongarch
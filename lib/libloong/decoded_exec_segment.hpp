@@ -2,6 +2,8 @@
 #include "common.hpp"
 #include "decoder_cache.hpp"
 #include "tr_types.hpp"
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <mutex>
 #include <condition_variable>
@@ -44,8 +46,27 @@ namespace loongarch
 			m_decoder_cache.cache = cache;
 			m_decoder_cache.size = size;
 		}
+		// Allocate an owned decoder cache (entries includes the end sentinel)
+		// A shareable cache can be mapped copy-on-write by overlays.
+		DecoderData* allocate_decoder_cache(size_t entries, bool shareable);
+
+		// Segments in the shared segment cache must not be patched directly
+		bool is_shared() const noexcept { return m_is_shared; }
+		void set_shared(bool shared) noexcept { m_is_shared = shared; }
+
+		// Per-machine copy-on-write overlay of a shared segment
+		// Decoder cache pages are copied only when they are patched, untouched
+		// pages stay shared with the base segment. Without a shareable base
+		// cache the overlay takes a private copy of it instead. Either way,
+		// live-patches of binary translations are passed on (see live_patch()).
+		static std::shared_ptr<DecodedExecuteSegment> create_overlay(
+			const std::shared_ptr<DecodedExecuteSegment>& base);
+		bool is_overlay() const noexcept { return m_overlay_base != nullptr; }
+		const auto& overlay_base() const noexcept { return m_overlay_base; }
 
 		size_t size_bytes() const noexcept { return m_exec_end - m_exec_begin; }
+		// Host memory held by this segment (decoder caches included)
+		size_t memory_usage() const noexcept;
 		bool empty() const noexcept { return m_exec_begin >= m_exec_end; }
 
 		void set(address_t entry_addr, const DecoderData& data);
@@ -56,55 +77,157 @@ namespace loongarch
 		bool is_execute_only() const noexcept { return m_execute_only; }
 
 		uint32_t optimize_bytecode(uint8_t& bytecode, address_t pc, uint32_t instruction_bits) const;
+		// Fuse adjacent bytecodes into superinstructions (after optimize_bytecode)
+		void fuse_bytecodes();
+		// Chain forward B/BL into their target blocks, recomputing block_bytes
+		// of every entry (after fuse_bytecodes)
+		void chain_blocks();
+		// Folded constants and addresses, see LA64_BC_CONST
+		uint64_t folded_constant(unsigned index) const noexcept { return m_folded_constants[index]; }
+		// The original entry of a folded constant head
+		const DecoderData& folded_head(unsigned index) const noexcept { return m_folded_heads[index]; }
+
+		// Block entry counts of the block-profiling and tiering dispatch, indexed
+		// like the decoder cache. Overlays count into their base segment, and
+		// machines sharing a segment count into it concurrently, so a shared
+		// segment aggregates all its machines, and keeps the counts while cached.
+		// Returns the new count, or zero when pc is outside the segment.
+		uint64_t record_block_entry(address_t pc) {
+			DecodedExecuteSegment& owner = m_overlay_base ? *m_overlay_base : *this;
+			const size_t index = (pc - m_exec_begin) >> DecoderCache::SHIFT;
+			if (LA_UNLIKELY(index >= m_decoder_cache.size))
+				return 0;
+			uint64_t* counts = owner.m_block_counts.load(std::memory_order_acquire);
+			if (LA_UNLIKELY(counts == nullptr))
+				counts = owner.allocate_block_counts();
+			return __atomic_add_fetch(&counts[index], 1, __ATOMIC_RELAXED);
+		}
+		// decoder_cache_size() counts, or nullptr when no block was entered yet
+		const uint64_t* block_counts() const noexcept {
+			return (m_overlay_base ? m_overlay_base.get() : this)->m_block_counts.load(std::memory_order_acquire);
+		}
+		// Zeroes the counts, also for every other machine using the segment
+		void reset_block_counts() noexcept;
+
+#ifdef LA_INSTRUCTION_PROFILING
+		// Dynamic execution counts per decoder cache entry
+		// Overlays share the profile of their base segment.
+		struct ExecutionProfile {
+			std::vector<uint32_t> instructions; // Original instruction bits
+			std::vector<uint64_t> counts;
+		};
+		ExecutionProfile& create_execution_profile(size_t size);
+		const ExecutionProfile* execution_profile() const noexcept { return m_profile.get(); }
+		// Machines sharing a segment count into the same profile concurrently
+		void record_execution(const DecoderData* entry) noexcept {
+			const size_t index = entry - m_decoder_cache.cache;
+			if (m_profile != nullptr && index < m_profile->counts.size())
+				__atomic_add_fetch(&m_profile->counts[index], 1, __ATOMIC_RELAXED);
+		}
+#endif
 
 #ifdef LA_BINARY_TRANSLATION
 		// Binary translation support
-		bool is_binary_translated() const noexcept { return m_mappings_base_address != nullptr; }
+		bool is_binary_translated() const noexcept { return translator_handlers() != nullptr; }
 		bool is_libtcc() const noexcept { return m_is_libtcc; }
 		void set_libtcc(bool value) noexcept { m_is_libtcc = value; }
 
-		void set_mappings_base_address(const char* addr) noexcept { m_mappings_base_address = addr; }
-		const char* mappings_base_address() const noexcept { return m_mappings_base_address; }
+		// The handlers of all translations of this segment, indexed by the
+		// instr field of LA64_BC_TRANSLATOR entries. Tiered translation adds
+		// handlers while they are in use, so the table is never reallocated.
+		// Handlers are added before the entries that use them are published.
+		// Returns the index of the first added handler, or -1 when it is full.
+		long add_translator_handlers(const bintr_block_func* handlers, size_t count);
+		// Overlays may be created before the base segment has been
+		// (background) translated, so they always ask the base.
+		const bintr_block_func* translator_handlers() const noexcept {
+			const auto& owner = m_overlay_base ? *m_overlay_base : *this;
+			return owner.m_translator_handlers.load(std::memory_order_acquire);
+		}
 		bintr_block_func build_mapping(uint32_t instr_field) const {
-			const uintptr_t addr = (uintptr_t)m_mappings_base_address + (uintptr_t)instr_field;
-			return reinterpret_cast<bintr_block_func>(addr);
+			return translator_handlers()[instr_field];
 		}
 
+		// Tiered translation, enabled before the segment is first executed
+		TransTiering* tiering() const noexcept { return m_tiering.get(); }
+		void enable_tiering(const MachineOptions& options) { m_tiering = std::make_unique<TransTiering>(options); }
+
 		// Patched decoder cache (for live-patching)
-		auto* patched_decoder_cache() noexcept { return m_patched_decoder_cache.cache; }
-		auto* patched_decoder_cache() const noexcept { return m_patched_decoder_cache.cache; }
+		// For overlays this is a private copy with the overlay patches re-applied.
+		DecoderData* patched_decoder_cache() noexcept {
+			return m_overlay_base ? overlay_patched_decoder_cache() : m_patched_decoder_cache.cache;
+		}
+		const DecoderData* patched_decoder_cache() const noexcept { return m_patched_decoder_cache.cache; }
 		void set_patched_decoder_cache(DecoderData* cache, size_t size) noexcept {
 			m_patched_decoder_cache.cache = cache;
 			m_patched_decoder_cache.size = size;
 		}
 
 		// Background compilation state
+		// Live-patch an entry of this segment, and of every overlay that
+		// has not patched the entry itself
+		void live_patch(address_t addr, const DecoderData& data);
+
 		bool is_background_compiling() const noexcept;
 		void set_background_compiling(bool is_bg);
 		void wait_for_compilation_complete();
 
-		// Dynamic library handle
-		void* bintr_dylib() const noexcept { return m_bintr_dl; }
-		void set_bintr_dylib(void* dylib) noexcept { m_bintr_dl = dylib; }
+		// Dynamic library handles, closed with the segment
+		const std::vector<void*>& bintr_dylibs() const noexcept { return m_bintr_dylibs; }
+		void add_bintr_dylib(void* dylib) { m_bintr_dylibs.push_back(dylib); }
 #else
 		bool is_binary_translated() const noexcept { return false; }
 #endif
 
 	private:
+		void free_decoder_cache() noexcept;
+		uint64_t* allocate_block_counts();
+		// Restore superinstructions that cover the entry at index
+		void unfuse_before(size_t index) noexcept;
+		// Re-chain the blocks that reach a patched entry, see chain_blocks()
+		void rechain_blocks(size_t index);
+#ifdef LA_BINARY_TRANSLATION
+		DecoderData* overlay_patched_decoder_cache();
+#endif
+
 		address_t m_exec_begin;
 		address_t m_exec_end;
 		DecoderCache m_decoder_cache;
 		bool m_stale = false;
 		bool m_execute_only = false;
+		bool m_is_shared = false;
+		bool m_chained_blocks = false;
 		uint32_t m_crc32c_hash = 0;
+		// Memory-mapped decoder cache (shareable or copy-on-write overlay),
+		// at this offset of the process-wide decoder cache file
+		size_t m_decoder_mapping_offset = 0;
+		size_t m_decoder_mapping_size = 0;
+		std::shared_ptr<DecodedExecuteSegment> m_overlay_base;
+		std::vector<uint64_t> m_folded_constants;
+		std::vector<DecoderData> m_folded_heads; // Original entries, for un-folding
+		// (target, branch) entry indices of forward B/BL, sorted by target
+		std::vector<std::pair<uint32_t, uint32_t>> m_chain_sources;
+		// Allocated once, on the first recorded block entry
+		std::atomic<uint64_t*> m_block_counts { nullptr };
+#ifdef LA_INSTRUCTION_PROFILING
+		std::shared_ptr<ExecutionProfile> m_profile;
+#endif
 #ifdef LA_BINARY_TRANSLATION
 		bool m_is_libtcc = false;
-		const char* m_mappings_base_address = nullptr;
+		std::atomic<bintr_block_func*> m_translator_handlers { nullptr };
+		size_t m_translator_handlers_size = 0;
+		size_t m_translator_handlers_capacity = 0;
 		DecoderCache m_patched_decoder_cache;
-		void* m_bintr_dl = nullptr;
+		std::vector<void*> m_bintr_dylibs;
+		std::unique_ptr<TransTiering> m_tiering;
 		mutable std::mutex m_background_compilation_mutex;
 		mutable std::condition_variable m_background_compilation_cv;
 		bool m_is_background_compiling = false;
+		// Entries written into an overlay, re-applied to its patched decoder cache
+		std::vector<std::pair<address_t, DecoderData>> m_overlay_patches;
+		// Overlays of this segment, which receive its live-patches
+		std::mutex m_overlays_mutex;
+		std::vector<DecodedExecuteSegment*> m_overlays;
 #endif
 	};
 
@@ -127,6 +127,23 @@ extern bool try_translate(const Machine&, const MachineOptions&, std::shared_ptr
 		case InstrId::FLDX_D: return LA64_BC_FLDX_D;
 		case InstrId::FSTX_D: return LA64_BC_FSTX_D;
 		case InstrId::FMADD_D: return LA64_BC_FMADD_D;
+		case InstrId::FLD_S: return LA64_BC_FLD_S;
+		case InstrId::FST_S: return LA64_BC_FST_S;
+		case InstrId::FADD_S: return LA64_BC_FADD_S;
+		case InstrId::FSUB_S: return LA64_BC_FSUB_S;
+		case InstrId::FMUL_S: return LA64_BC_FMUL_S;
+		case InstrId::FDIV_S: return LA64_BC_FDIV_S;
+		case InstrId::FMADD_S: return LA64_BC_FMADD_S;
+		case InstrId::FMOV_S: return LA64_BC_FMOV_S;
+		case InstrId::FMOV_D: return LA64_BC_FMOV_D;
+		case InstrId::FCVT_S_D: return LA64_BC_FCVT_S_D;
+		case InstrId::FCVT_D_S: return LA64_BC_FCVT_D_S;
+		case InstrId::FCMP_COND_S:
+		case InstrId::FCMP_COND_D:
+			// Unknown condition codes raise an exception from the generic handler
+			if (!InstructionHelpers::fcmp_condition_valid((instr >> 15) & 0x1F))
+				return LA64_BC_FUNCTION + (handler_idx >> 8);
+			return (id == InstrId::FCMP_COND_S) ? LA64_BC_FCMP_COND_S : LA64_BC_FCMP_COND_D;
 		case InstrId::VFMADD_D: return LA64_BC_VFMADD_D;
 		case InstrId::VHADDW_D_W: return LA64_BC_VHADDW_D_W;
 		case InstrId::XVLD: return LA64_BC_XVLD;
@@ -155,6 +172,18 @@ extern bool try_translate(const Machine&, const MachineOptions&, std::shared_ptr
 		case InstrId::XVLDX: return LA64_BC_XVLDX;
 		case InstrId::XVSTX: return LA64_BC_XVSTX;
 		case InstrId::VFADD_D: return LA64_BC_VFADD_D;
+		case InstrId::VORI_B: return LA64_BC_VORI_B;
+		case InstrId::VREPLGR2VR_W: return LA64_BC_VREPLGR2VR_W;
+		case InstrId::VREPLGR2VR_D: return LA64_BC_VREPLGR2VR_D;
+		case InstrId::VPICKVE2GR_W: return LA64_BC_VPICKVE2GR_W;
+		case InstrId::VPICKVE2GR_D: return LA64_BC_VPICKVE2GR_D;
+		case InstrId::VSHUF_B: return LA64_BC_VSHUF_B;
+		case InstrId::XVFMADD_D: return LA64_BC_XVFMADD_D;
+
+		// LSX/LASX 3R bytecodes
+#define LA64_VECTOR_BYTECODE(id, name, ...) case InstrId::id: return LA64_BC_##id;
+#include "vector_bytecodes.hpp"
+#undef LA64_VECTOR_BYTECODE
 
 		// PC-modifying non-diverging instructions
 		case InstrId::PCADDI: return LA64_BC_PCADDI;
@@ -177,6 +206,11 @@ extern bool try_translate(const Machine&, const MachineOptions&, std::shared_ptr
 		case InstrId::BLTU: return LA64_BC_BLTU;
 		case InstrId::BGEU: return LA64_BC_BGEU;
 
+		// Profile-guided bytecodes
+#define LA64_PROFILED_BYTECODE(id, name) case InstrId::id: return LA64_BC_##id;
+#include "profiled_bytecodes.hpp"
+#undef LA64_PROFILED_BYTECODE
+
 		// All other instructions fall through to FUNCTION
 		default:
 			return LA64_BC_FUNCTION + (handler_idx >> 8);
@@ -201,7 +235,7 @@ extern bool try_translate(const Machine&, const MachineOptions&, std::shared_ptr
 		}
 
 		const size_t num_instructions = aligned_size / 4;
-		auto* cache = new DecoderData[num_instructions + 1];
+		auto* cache = segment->allocate_decoder_cache(num_instructions + 1, segment->is_shared());
 		// Guarantee that invalid instruction is handler 0
 		const auto invalid_handler = DecoderData::compute_handler_for(
 			CPU::get_invalid_instruction().handler);
@@ -214,6 +248,10 @@ extern bool try_translate(const Machine&, const MachineOptions&, std::shared_ptr
 		// This computes how many bytes until the next diverging instruction
 		const uint32_t* instr_ptr = reinterpret_cast<const uint32_t*>(code);
 		uint32_t accumulated_bytes = 0;
+#ifdef LA_INSTRUCTION_PROFILING
+		auto& profile = segment->create_execution_profile(num_instructions);
+		std::memcpy(profile.instructions.data(), instr_ptr, num_instructions * sizeof(uint32_t));
+#endif
 		std::unordered_map<typename DecoderData::handler_t, uint16_t> handler_map;
 		for (size_t i = num_instructions; i-- > 0; ) {
 			const uint32_t instr = instr_ptr[i];
@@ -260,6 +298,13 @@ extern bool try_translate(const Machine&, const MachineOptions&, std::shared_ptr
 
 		// Store the cache in the segment
 		segment->set_decoder_cache(cache, num_instructions);
+		segment->fuse_bytecodes();
+#ifdef LA_BINARY_TRANSLATION
+		// Translated code does its own instruction counting from the entry
+		// blocks, which must not include chained blocks.
+		if (!options.translate_enabled)
+#endif
+		segment->chain_blocks();
 
 #ifdef LA_BINARY_TRANSLATION
 		// Try to activate binary translation if enabled
@@ -289,6 +334,16 @@ extern bool try_translate(const Machine&, const MachineOptions&, std::shared_ptr
 		const size_t index = (entry_addr - m_exec_begin) >> DecoderCache::SHIFT;
 		if (index < m_decoder_cache.size) {
 			m_decoder_cache.cache[index] = data;
+			// A superinstruction covering this entry would bypass it
+			unfuse_before(index);
+			// Blocks chained into this entry were counted with its old size
+			if (m_chained_blocks)
+				rechain_blocks(index);
+#ifdef LA_BINARY_TRANSLATION
+			// Remembered for the private copy of the patched decoder cache
+			if (m_overlay_base)
+				m_overlay_patches.emplace_back(entry_addr, data);
+#endif
 		} else {
 			fprintf(stderr,
 				"DecodedExecuteSegment: set() address out of range: 0x%lx index=%zu size=%zu\n",
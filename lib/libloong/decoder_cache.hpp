@@ -1,5 +1,6 @@
 #pragma once
 #include "common.hpp"
+#include <cstring>
 #include <vector>
 
 namespace loongarch
@@ -12,11 +13,22 @@ namespace loongarch
 		uint8_t bytecode;         // Bytecode for threaded dispatch
 		uint8_t handler_idx;      // Handler index (0-255)
 		uint16_t block_bytes;     // Bytes until next diverging instruction (0 = diverges here)
+		                          // Chained branches continue into their target block, see LA64_BC_B_CHAINED
 		uint32_t instr;           // The 32-bit instruction bits
 
+		// Patched entries are published whole with a release store (see
+		// DecodedExecuteSegment::live_patch), so that what they refer to is
+		// visible once they are read with this
+		DecoderData load_acquire() const noexcept {
+			const uint64_t bits = __atomic_load_n(reinterpret_cast<const uint64_t*>(this), __ATOMIC_ACQUIRE);
+			DecoderData data;
+			std::memcpy(&data, &bits, sizeof(data));
+			return data;
+		}
+
 		// Calculate number of instructions in this block (LoongArch = 4 bytes per instruction)
 		// This includes the current (diverging) instruction: block instructions + 1
-		uint8_t instruction_count() const noexcept { return (block_bytes / 4) + 1; }
+		unsigned instruction_count() const noexcept { return (block_bytes / 4) + 1; }
 
 		// Bytecode accessors for threaded dispatch
 		uint8_t get_bytecode() const noexcept { return bytecode; }
@@ -0,0 +1,42 @@
+#pragma once
+
+namespace loongarch
+{
+	// Compile-time options of the threaded dispatch loop (CPU::dispatch)
+	// Every instantiation is a separate loop, so a disabled option costs
+	// nothing at run time. The Machine picks an instantiation per call to
+	// simulate(), see Machine::set_block_profiling and set_dispatch_tracer,
+	// try_simulate() uses the trapping one, and tiered binary translation
+	// (MachineOptions::translate_hot_threshold) the tiering one, and
+	// CPU::simulate_precise() the stepping one.
+	template <bool Counting, bool BlockProfiling = false, bool Watchdog = false, bool Tracing = false,
+		bool Trapping = false, bool Tiering = false, bool Stepping = false>
+	struct DispatchPolicy
+	{
+		// Count instructions and stop at the instruction limit
+		static constexpr bool counting = Counting;
+		// Count every block entry in its execute segment
+		static constexpr bool block_profiling = BlockProfiling;
+		// Stop when Machine::stop_flag() is raised
+		static constexpr bool watchdog = Watchdog;
+		// Call the machine's dispatch tracer on every block entry
+		static constexpr bool tracing = Tracing;
+		// Keep the current decoder entry in the armed CPU::FaultTrap
+		static constexpr bool trapping = Trapping;
+		// Count every block entry, and translate blocks that become hot
+		static constexpr bool tiering = Tiering;
+		// Count and check the limit on every instruction instead of every
+		// block, running superinstructions one instruction at a time
+		static constexpr bool stepping = Stepping;
+	};
+
+	using AccurateDispatch       = DispatchPolicy<true>;
+	using InaccurateDispatch     = DispatchPolicy<false>;
+	using WatchdogDispatch       = DispatchPolicy<false, false, true>;
+	using BlockProfilingDispatch = DispatchPolicy<true, true>;
+	using TracingDispatch        = DispatchPolicy<true, false, false, true>;
+	using TrappingDispatch       = DispatchPolicy<true, false, false, false, true>;
+	using TieringDispatch        = DispatchPolicy<true, false, false, false, false, true>;
+	using PreciseDispatch        = DispatchPolicy<true, false, false, false, false, false, true>;
+
+} // namespace loongarch
@@ -1,5 +1,6 @@
 #pragma once
 #include "common.hpp"
+#include <cmath>
 
 namespace loongarch {
 
@@ -293,6 +294,52 @@ struct InstructionHelpers {	// Sign extend immediate values
 		// offs is a 26-bit signed value
 		return int32_t(offs << 6) >> 6;
 	}
+
+	// FCMP.cond.S/D condition codes that are implemented
+	static constexpr bool fcmp_condition_valid(uint32_t cond) {
+		switch (cond) {
+			case 0x02: case 0x03: case 0x04: case 0x05:
+			case 0x06: case 0x07: case 0x08: case 0x09:
+			case 0x0A: case 0x0B: case 0x0E: case 0x0F:
+			case 0x14: case 0x18: case 0x19:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// Evaluate an FCMP.cond.S/D condition (see fcmp_condition_valid)
+	template <typename T>
+	static bool fcmp_condition(uint32_t cond, T fj_val, T fk_val) {
+		const bool is_unordered = std::isnan(fj_val) || std::isnan(fk_val);
+		switch (cond) {
+			case 0x02: // CLT - (Quiet) Less Than (ordered)
+			case 0x03: // SLT - Signaling Less Than (ordered)
+				return !is_unordered && (fj_val < fk_val);
+			case 0x04: // CEQ - Equal (ordered)
+			case 0x05: // SEQ - Signaling Equal (ordered)
+				return !is_unordered && (fj_val == fk_val);
+			case 0x06: // CLE - (Quiet) Less or Equal (ordered)
+			case 0x07: // SLE - Signaling Less or Equal (ordered)
+				return !is_unordered && (fj_val <= fk_val);
+			case 0x08: // CUN  - (Quiet) Incomparable
+			case 0x09: // SUN  - Signaling Incomparable
+				return is_unordered;
+			case 0x0A: // CULT - Less than or incomparable
+			case 0x0B: // SULT - Signaling Less than or incomparable
+				return (fj_val < fk_val) || is_unordered;
+			case 0x0E: // CULE - (Quiet) Unordered or Less or Equal
+			case 0x0F: // SULE - Signaling Unordered or Less or Equal
+				return is_unordered || (fj_val <= fk_val);
+			case 0x14: // COR - (Quiet) Ordered
+				return !is_unordered;
+			case 0x18: // CUNE - (Quiet) Unordered or Not Equal
+			case 0x19: // SUNE - Signaling Unordered or Not Equal
+				return is_unordered || (fj_val != fk_val);
+			default:
+				return false;
+		}
+	}
 };
 
 } // loongarch
@@ -1,6 +1,7 @@
 #pragma once
 #include "cpu.hpp"
 #include "la_instr.hpp"
+#include "la_instr_simd.hpp"
 #include <cmath>
 
 namespace loongarch {
@@ -649,6 +650,7 @@ struct InstrImpl {
 	static void SYSCALL(cpu_t& cpu, la_instruction instr) {
 		(void)instr;
 		const int syscall_nr = static_cast<uint32_t>(cpu.reg(REG_A7));
+		cpu_t::FaultTrapPause pause;
 		cpu.machine().system_call(syscall_nr);
 	}
 
@@ -656,6 +658,7 @@ struct InstrImpl {
 		(void)instr;
 		// BREAK instruction - currently hardcoded to syscall 0
 		// TODO: Extract the 15-bit code field from the instruction for proper handling
+		cpu_t::FaultTrapPause pause;
 		cpu.machine().system_call(0);
 	}
 
@@ -901,52 +904,14 @@ struct InstrImpl {
 		uint32_t fk = (instr.whole >> 10) & 0x1F; // Source register 2
 		uint32_t cond = (instr.whole >> 15) & 0x1F; // Condition code (5 bits)
 
+		if (!InstructionHelpers::fcmp_condition_valid(cond)) {
+			// Unknown condition code - this should not happen in normal execution
+			cpu.trigger_exception(ILLEGAL_OPCODE, instr.whole,
+				"FCMP.COND.S: Unknown condition code");
+		}
 		const auto& vr_j = cpu.registers().getvr(fj);
 		const auto& vr_k = cpu.registers().getvr(fk);
-		float fj_val = vr_j.f[0];
-		float fk_val = vr_k.f[0];
-
-		bool is_unordered = std::isnan(fj_val) || std::isnan(fk_val);
-		bool result = false;
-
-		switch (cond) {
-			case 0x02: // CLT - (Quiet) Less Than (ordered)
-			case 0x03: // SLT - Signaling Less Than (ordered)
-				result = !is_unordered && (fj_val < fk_val);
-				break;
-			case 0x04: // CEQ - Equal (ordered)
-			case 0x05: // SEQ - Signaling Equal (ordered)
-				result = !is_unordered && (fj_val == fk_val);
-				break;
-			case 0x06: // CLE - (Quiet) Less or Equal (ordered)
-			case 0x07: // SLE - Signaling Less or Equal (ordered)
-				result = !is_unordered && (fj_val <= fk_val);
-				break;
-			case 0x8:  // CUN  - (Quiet) Incomparable
-			case 0x9:  // SUN  - Signaling Incomparable
-				result = is_unordered;
-				break;
-			case 0x0E: // CULE - (Quiet) Unordered or Less or Equal
-			case 0x0F: // SULE - Signaling Unordered or Less or Equal
-				result = is_unordered || (fj_val <= fk_val);
-				break;
-			case 0x14: // COR - (Quiet) Ordered
-				result = !is_unordered;
-				break;
-			case 0x18: // CUNE - (Quiet) Unordered or Not Equal
-			case 0x19: // SUNE - Signaling Unordered or Not Equal
-				result = is_unordered || (fj_val != fk_val);
-				break;
-			case 0xA: // CULT - Less than or incomparable
-			case 0xB: // SULT - Signaling Less than or incomparable
-				result = (fj_val < fk_val) || is_unordered;
-				break;
-			default:
-				// Unknown condition code - this should not happen in normal execution
-				throw MachineException(ILLEGAL_OPCODE,
-					"FCMP.COND.S: Unknown condition code", instr.whole);
-		}
-
+		const bool result = InstructionHelpers::fcmp_condition(cond, vr_j.f[0], vr_k.f[0]);
 		cpu.registers().set_cf(cd, result ? 1 : 0);
 	}
 
@@ -958,52 +923,14 @@ struct InstrImpl {
 		uint32_t fk = (instr.whole >> 10) & 0x1F; // Source register 2
 		uint32_t cond = (instr.whole >> 15) & 0x1F; // Condition code (5 bits)
 
+		if (!InstructionHelpers::fcmp_condition_valid(cond)) {
+			// Unknown condition code - this should not happen in normal execution
+			cpu.trigger_exception(ILLEGAL_OPCODE, instr.whole,
+				"FCMP.COND.D: Unknown condition code");
+		}
 		const auto& vr_j = cpu.registers().getvr(fj);
 		const auto& vr_k = cpu.registers().getvr(fk);
-		double fj_val = vr_j.df[0];
-		double fk_val = vr_k.df[0];
-
-		bool is_unordered = std::isnan(fj_val) || std::isnan(fk_val);
-		bool result = false;
-
-		switch (cond) {
-			case 0x02: // CLT - (Quiet) Less Than (ordered)
-			case 0x03: // SLT - Signaling Less Than (ordered)
-				result = !is_unordered && (fj_val < fk_val);
-				break;
-			case 0x04: // CEQ - Equal (ordered)
-			case 0x05: // SEQ - Signaling Equal (ordered)
-				result = !is_unordered && (fj_val == fk_val);
-				break;
-			case 0x06: // CLE - (Quiet) Less or Equal (ordered)
-			case 0x07: // SLE - Signaling Less or Equal (ordered)
-				result = !is_unordered && (fj_val <= fk_val);
-				break;
-			case 0x8:  // CUN  - (Quiet) Incomparable
-			case 0x9:  // SUN  - Signaling Incomparable
-				result = is_unordered;
-				break;
-			case 0x0E: // CULE - (Quiet) Unordered or Less or Equal
-			case 0x0F: // SULE - Signaling Unordered or Less or Equal
-				result = is_unordered || (fj_val <= fk_val);
-				break;
-			case 0x14: // COR - (Quiet) Ordered
-				result = !is_unordered;
-				break;
-			case 0x18: // CUNE - (Quiet) Unordered or Not Equal
-			case 0x19: // SUNE - Signaling Unordered or Not Equal
-				result = is_unordered || (fj_val != fk_val);
-				break;
-			case 0xA: // CULT - Less than or incomparable
-			case 0xB: // SULT - Signaling Less than or incomparable
-				result = (fj_val < fk_val) || is_unordered;
-				break;
-			default:
-				// Unknown condition code - this should not happen in normal execution
-				throw MachineException(ILLEGAL_OPCODE,
-					"FCMP.COND.D: Unknown condition code", instr.whole);
-		}
-
+		const bool result = InstructionHelpers::fcmp_condition(cond, vr_j.df[0], vr_k.df[0]);
 		cpu.registers().set_cf(cd, result ? 1 : 0);
 	}
 
@@ -1072,8 +999,8 @@ struct InstrImpl {
 					}
 					break;
 				default:
-					throw MachineException(ILLEGAL_OPCODE,
-						"VFCMP.COND.D: Unsupported condition code", instr.whole);
+					cpu.trigger_exception(ILLEGAL_OPCODE, instr.whole,
+						"VFCMP.COND.D: Unsupported condition code");
 			}
 		}
 		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
@@ -1840,61 +1767,22 @@ struct InstrImpl {
 	static void VSUB_B(cpu_t& cpu, la_instruction instr) {
 		// VSUB.B: Vector subtract bytes
 		// Encoding: 0000 0001 0001 0100 1 vk5 vj5 vd5
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 16; i++) {
-			dst.bu[i] = src1.bu[i] - src2.bu[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Sub<uint8_t>>(cpu, instr);
 	}
 
 	static void VSUB_H(cpu_t& cpu, la_instruction instr) {
 		// VSUB.H: Vector subtract halfwords
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 8; i++) {
-			dst.hu[i] = src1.hu[i] - src2.hu[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Sub<uint16_t>>(cpu, instr);
 	}
 
 	static void VSUB_W(cpu_t& cpu, la_instruction instr) {
 		// VSUB.W: Vector subtract word
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		// Subtract each 32-bit word
-		dst.wu[0] = src1.wu[0] - src2.wu[0];
-		dst.wu[1] = src1.wu[1] - src2.wu[1];
-		dst.wu[2] = src1.wu[2] - src2.wu[2];
-		dst.wu[3] = src1.wu[3] - src2.wu[3];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.wu[4] = 0;
-		dst.wu[5] = 0;
-		dst.wu[6] = 0;
-		dst.wu[7] = 0;
+		simd::lsx<simd::Sub<uint32_t>>(cpu, instr);
 	}
 
 	static void VSUB_D(cpu_t& cpu, la_instruction instr) {
 		// VSUB.D: Vector subtract doublewords
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = src1.du[0] - src2.du[0];
-		dst.du[1] = src1.du[1] - src2.du[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Sub<uint64_t>>(cpu, instr);
 	}
 
 	static void VMUL_B(cpu_t& cpu, la_instruction instr) {
@@ -1913,33 +1801,12 @@ struct InstrImpl {
 
 	static void VMUL_H(cpu_t& cpu, la_instruction instr) {
 		// VMUL.H: Vector multiply halfwords
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 8; i++) {
-			dst.hu[i] = src1.hu[i] * src2.hu[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Mul<uint16_t>>(cpu, instr);
 	}
 
 	static void VMUL_W(cpu_t& cpu, la_instruction instr) {
 		// VMUL.W: Vector multiply words
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.wu[0] = src1.wu[0] * src2.wu[0];
-		dst.wu[1] = src1.wu[1] * src2.wu[1];
-		dst.wu[2] = src1.wu[2] * src2.wu[2];
-		dst.wu[3] = src1.wu[3] * src2.wu[3];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.wu[4] = 0;
-		dst.wu[5] = 0;
-		dst.wu[6] = 0;
-		dst.wu[7] = 0;
+		simd::lsx<simd::Mul<uint32_t>>(cpu, instr);
 	}
 
 	static void VMUL_D(cpu_t& cpu, la_instruction instr) {
@@ -2120,24 +1987,7 @@ struct InstrImpl {
 	static void XVADD_D(cpu_t& cpu, la_instruction instr) {
 		// XVADD.D: LASX vector add doublewords (256-bit)
 		// Adds corresponding 64-bit doublewords from two 256-bit vectors
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-
-		// Read all inputs first to handle register aliasing
-		int64_t r0 = src1.d[0] + src2.d[0];
-		int64_t r1 = src1.d[1] + src2.d[1];
-		int64_t r2 = src1.d[2] + src2.d[2];
-		int64_t r3 = src1.d[3] + src2.d[3];
-
-		auto& dst = cpu.registers().getvr(xd);
-		dst.d[0] = r0;
-		dst.d[1] = r1;
-		dst.d[2] = r2;
-		dst.d[3] = r3;
+		simd::lasx<simd::Add<uint64_t>>(cpu, instr);
 	}
 
 	static void XVBITSEL_V(cpu_t& cpu, la_instruction instr) {
@@ -2262,242 +2112,78 @@ struct InstrImpl {
 
 	static void VSEQ_B(cpu_t& cpu, la_instruction instr) {
 		// VSEQ.B: Vector compare equal bytes (set mask)
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 16; i++) {
-			dst.bu[i] = (src1.bu[i] == src2.bu[i]) ? 0xFF : 0x00;
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Seq<uint8_t>>(cpu, instr);
 	}
 
 	static void VSLT_B(cpu_t& cpu, la_instruction instr) {
 		// VSLT.B: Vector signed less-than bytes (set mask)
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 16; i++) {
-			// Signed comparison
-			dst.bu[i] = (src1.b[i] < src2.b[i]) ? 0xFF : 0x00;
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Slt<int8_t>>(cpu, instr);
 	}
 
 	static void VSLT_H(cpu_t& cpu, la_instruction instr) {
 		// VSLT.H: Vector signed less-than halfwords (set mask)
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 8; i++) {
-			// Signed comparison
-			dst.hu[i] = (src1.h[i] < src2.h[i]) ? 0xFFFF : 0x0000;
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Slt<int16_t>>(cpu, instr);
 	}
 
 	static void VSLT_W(cpu_t& cpu, la_instruction instr) {
 		// VSLT.W: Vector signed less-than words (set mask)
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.wu[0] = ((int32_t)src1.w[0] < (int32_t)src2.w[0]) ? UINT32_MAX : 0u;
-		dst.wu[1] = ((int32_t)src1.w[1] < (int32_t)src2.w[1]) ? UINT32_MAX : 0u;
-		dst.wu[2] = ((int32_t)src1.w[2] < (int32_t)src2.w[2]) ? UINT32_MAX : 0u;
-		dst.wu[3] = ((int32_t)src1.w[3] < (int32_t)src2.w[3]) ? UINT32_MAX : 0u;
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Slt<int32_t>>(cpu, instr);
 	}
 
 	static void VSLT_D(cpu_t& cpu, la_instruction instr) {
 		// VSLT.D: Vector signed less-than doublewords (set mask)
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = ((int64_t)src1.d[0] < (int64_t)src2.d[0]) ? UINT64_MAX : 0ULL;
-		dst.du[1] = ((int64_t)src1.d[1] < (int64_t)src2.d[1]) ? UINT64_MAX : 0ULL;
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Slt<int64_t>>(cpu, instr);
 	}
 
 	static void VILVL_B(cpu_t& cpu, la_instruction instr) {
 		// VILVL.B: Vector Interleave Low Byte
 		// Interleaves the low 64-bit bytes from two vectors
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		// Interleave: dst[0] = src2[0], dst[1] = src1[0], dst[2] = src2[1], dst[3] = src1[1], ...
-		// For bytes (8-bit), we interleave the low 8 elements from each source
-		uint8_t result[16];
-		for (int i = 0; i < 8; i++) {
-			result[i*2] = src2.bu[i];
-			result[i*2 + 1] = src1.bu[i];
-		}
-		for (int i = 0; i < 16; i++) {
-			dst.bu[i] = result[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::InterleaveLow<uint8_t>>(cpu, instr);
 	}
 
 	static void VILVL_H(cpu_t& cpu, la_instruction instr) {
 		// VILVL.H: Vector Interleave Low Half-word
 		// Interleaves the low 64-bit half-words from two vectors
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		// Interleave: dst[0] = src2[0], dst[1] = src1[0], dst[2] = src2[1], dst[3] = src1[1], ...
-		// For half-words (16-bit), we interleave the low 4 elements from each source
-		uint16_t result[8];
-		for (int i = 0; i < 4; i++) {
-			result[i*2] = src2.hu[i];
-			result[i*2 + 1] = src1.hu[i];
-		}
-		for (int i = 0; i < 8; i++) {
-			dst.hu[i] = result[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::InterleaveLow<uint16_t>>(cpu, instr);
 	}
 
 	static void VILVL_W(cpu_t& cpu, la_instruction instr) {
 		// VILVL.W: Vector Interleave Low Word
 		// Interleaves the low 64-bit words from two vectors
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		// Interleave: dst[0] = src2[0], dst[1] = src1[0], dst[2] = src2[1], dst[3] = src1[1]
-		// For words (32-bit), we interleave the low 2 elements from each source
-		uint32_t result[4];
-		for (int i = 0; i < 2; i++) {
-			result[i*2] = src2.wu[i];
-			result[i*2 + 1] = src1.wu[i];
-		}
-		for (int i = 0; i < 4; i++) {
-			dst.wu[i] = result[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::InterleaveLow<uint32_t>>(cpu, instr);
 	}
 
 	static void VILVL_D(cpu_t& cpu, la_instruction instr) {
 		// VILVL.D: Vector Interleave Low Double-word
 		// Interleaves the low 64-bit double-words from two vectors
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-
-		// Make sure to avoid aliasing issues by reading sources first
-		const auto src1_du = cpu.registers().getvr(vj).du[0];
-		const auto src2_du = cpu.registers().getvr(vk).du[0];
-		auto& dst = cpu.registers().getvr(vd);
-
-		// Interleave: dst[0] = src2[0], dst[1] = src1[0]
-		// For double-words (64-bit), we interleave the low element (1 element) from each source
-		dst.du[0] = src2_du;
-		dst.du[1] = src1_du;
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::InterleaveLow<uint64_t>>(cpu, instr);
 	}
 
 	static void VILVH_D(cpu_t& cpu, la_instruction instr) {
 		// VILVH.D: Vector Interleave High Double-word
 		// Interleaves the high 64-bit elements from two vectors
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src_j = cpu.registers().getvr(vj);
-		const auto& src_k = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-
-		// Interleave: dst[0] = src_k[1], dst[1] = src_j[1]
-		dst.du[0] = src_k.du[1];
-		dst.du[1] = src_j.du[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::InterleaveHigh64>(cpu, instr);
 	}
 
 	static void VPICKEV_W(cpu_t& cpu, la_instruction instr) {
 		// VPICKEV.W: Vector Pick Even Word
 		// Picks even-indexed 32-bit words from two vectors
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src_j = cpu.registers().getvr(vj);
-		const auto& src_k = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-
-		// Pick even words: dst = [vk[0], vk[2], vj[0], vj[2]]
-		dst.wu[0] = src_k.wu[0];
-		dst.wu[1] = src_k.wu[2];
-		dst.wu[2] = src_j.wu[0];
-		dst.wu[3] = src_j.wu[2];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.wu[4] = 0;
-		dst.wu[5] = 0;
-		dst.wu[6] = 0;
-		dst.wu[7] = 0;
+		simd::lsx<simd::PickEven32>(cpu, instr);
 	}
 
 	static void VNOR_V(cpu_t& cpu, la_instruction instr) {
 		// VNOR.V: Vector NOR
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = ~(src1.du[0] | src2.du[0]);
-		dst.du[1] = ~(src1.du[1] | src2.du[1]);
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Nor>(cpu, instr);
 	}
 
 	static void VORN_V(cpu_t& cpu, la_instruction instr) {
 		// VORN.V: Vector OR NOT (dst = src1 | ~src2)
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = src1.du[0] | ~src2.du[0];
-		dst.du[1] = src1.du[1] | ~src2.du[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Orn>(cpu, instr);
 	}
 
 	static void VAND_V(cpu_t& cpu, la_instruction instr) {
 		// VAND.V: Vector AND
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = src1.du[0] & src2.du[0];
-		dst.du[1] = src1.du[1] & src2.du[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::And>(cpu, instr);
 	}
 
 	static void VBITREVI_D(cpu_t& cpu, la_instruction instr) {
@@ -2757,8 +2443,8 @@ struct InstrImpl {
 			uint64_t val = (bit7 << 63) | ((1 - bit6) << 62) | ((bit6 * 0xFF) << 54) | (bits5_0 << 48);
 			for (int i = 0; i < 2; i++) dst.du[i] = val;
 		} else {
-			throw MachineException(ILLEGAL_OPCODE,
-				"VLDI: Unknown mode", top5);
+			cpu.trigger_exception(ILLEGAL_OPCODE, top5,
+				"VLDI: Unknown mode");
 		}
 	}
 
@@ -2779,56 +2465,22 @@ struct InstrImpl {
 
 	static void VFADD_D(cpu_t& cpu, la_instruction instr) {
 		// VFADD.D: Vector floating-point add (double precision, 2x64-bit)
-		const auto& src1 = cpu.registers().getvr(instr.r4.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r4.rk);
-		auto& dst = cpu.registers().getvr(instr.r4.rd);
-
-		dst.df[0] = src1.df[0] + src2.df[0];
-		dst.df[1] = src1.df[1] + src2.df[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::FAdd<double>>(cpu, instr);
 	}
 
 	static void VFDIV_D(cpu_t& cpu, la_instruction instr) {
 		// VFDIV.D: Vector floating-point divide (double precision, 2x64-bit)
-		const auto& src1 = cpu.registers().getvr(instr.r4.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r4.rk);
-		auto& dst = cpu.registers().getvr(instr.r4.rd);
-
-		dst.df[0] = src1.df[0] / src2.df[0];
-		dst.df[1] = src1.df[1] / src2.df[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::FDiv<double>>(cpu, instr);
 	}
 
 	static void VFMUL_S(cpu_t& cpu, la_instruction instr) {
 		// VFMUL.S: Vector floating-point multiply (single precision, 4x32-bit)
-		const auto& src1 = cpu.registers().getvr(instr.r4.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r4.rk);
-		auto& dst = cpu.registers().getvr(instr.r4.rd);
-
-		dst.f[0] = src1.f[0] * src2.f[0];
-		dst.f[1] = src1.f[1] * src2.f[1];
-		dst.f[2] = src1.f[2] * src2.f[2];
-		dst.f[3] = src1.f[3] * src2.f[3];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::FMul<float>>(cpu, instr);
 	}
 
 	static void VFMUL_D(cpu_t& cpu, la_instruction instr) {
 		// VFMUL.D: Vector floating-point multiply (double precision, 2x64-bit)
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.df[0] = src1.df[0] * src2.df[0];
-		dst.df[1] = src1.df[1] * src2.df[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::FMul<double>>(cpu, instr);
 	}
 
 	static void VFTINTRZ_W_S(cpu_t& cpu, la_instruction instr) {
@@ -2897,25 +2549,12 @@ struct InstrImpl {
 
 	static void VOR_V(cpu_t& cpu, la_instruction instr) {
 		// VOR.V: Vector OR
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = src1.du[0] | src2.du[0];
-		dst.du[1] = src1.du[1] | src2.du[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Or>(cpu, instr);
 	}
 
 	static void VXOR_V(cpu_t& cpu, la_instruction instr) {
 		// VXOR.V: Vector XOR
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = src1.du[0] ^ src2.du[0];
-		dst.du[1] = src1.du[1] ^ src2.du[1];
+		simd::lsx<simd::Xor, false>(cpu, instr);
 	}
 
 	static void VSEQI_B(cpu_t& cpu, la_instruction instr) {
@@ -3212,97 +2851,34 @@ struct InstrImpl {
 	static void VADD_B(cpu_t& cpu, la_instruction instr) {
 		// VADD.B vd, vj, vk
 		// Add corresponding bytes in vj and vk
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 16; i++) {
-			dst.bu[i] = src1.bu[i] + src2.bu[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Add<uint8_t>>(cpu, instr);
 	}
 
 	static void VADD_H(cpu_t& cpu, la_instruction instr) {
 		// VADD.H vd, vj, vk
 		// Add corresponding halfwords in vj and vk
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		for (int i = 0; i < 8; i++) {
-			dst.hu[i] = src1.hu[i] + src2.hu[i];
-		}
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Add<uint16_t>>(cpu, instr);
 	}
 
 	static void VADD_W(cpu_t& cpu, la_instruction instr) {
 		// VADD.W vd, vj, vk
 		// Add corresponding words in vj and vk
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.wu[0] = src1.wu[0] + src2.wu[0];
-		dst.wu[1] = src1.wu[1] + src2.wu[1];
-		dst.wu[2] = src1.wu[2] + src2.wu[2];
-		dst.wu[3] = src1.wu[3] + src2.wu[3];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.wu[4] = 0;
-		dst.wu[5] = 0;
-		dst.wu[6] = 0;
-		dst.wu[7] = 0;
+		simd::lsx<simd::Add<uint32_t>>(cpu, instr);
 	}
 
 	static void VADD_D(cpu_t& cpu, la_instruction instr) {
 		// VADD.D vd, vj, vk
 		// Add corresponding doublewords in vj and vk
-		const auto& src1 = cpu.registers().getvr(instr.r3.rj);
-		const auto& src2 = cpu.registers().getvr(instr.r3.rk);
-		auto& dst = cpu.registers().getvr(instr.r3.rd);
-
-		dst.du[0] = src1.du[0] + src2.du[0];
-		dst.du[1] = src1.du[1] + src2.du[1];
-		// LSX instructions zero-extend to 256 bits (clear upper 128 bits for LASX compatibility)
-		dst.du[2] = 0;
-		dst.du[3] = 0;
+		simd::lsx<simd::Add<uint64_t>>(cpu, instr);
 	}
 
 	static void VSHUF_B(cpu_t& cpu, la_instruction instr) {
 		// VSHUF.B vd, vj, vk, va
 		// Shuffle bytes: for each byte in va, use low 5 bits as index into concatenated vk:vj
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		uint32_t va = (instr.whole >> 15) & 0x1F;
-
-		const auto& src_j = cpu.registers().getvr(vj);
-		const auto& src_k = cpu.registers().getvr(vk);
-		const auto& idx = cpu.registers().getvr(va);
-		auto& dst = cpu.registers().getvr(vd);
-
-		// Build combined 32-byte array: [vk[15:0], vj[15:0]]
-		uint8_t combined[32];
-		for (int i = 0; i < 8; i++) {
-			combined[i] = (src_k.du[0] >> (i * 8)) & 0xFF;
-			combined[i + 8] = (src_k.du[1] >> (i * 8)) & 0xFF;
-			combined[i + 16] = (src_j.du[0] >> (i * 8)) & 0xFF;
-			combined[i + 24] = (src_j.du[1] >> (i * 8)) & 0xFF;
-		}
-
-		// Shuffle based on index
-		for (int i = 0; i < 2; i++) {
-			uint64_t result = 0;
-			for (int j = 0; j < 8; j++) {
-				uint8_t index = (idx.du[i] >> (j * 8)) & 0x1F;
-				uint8_t byte = combined[index];
-				result |= (uint64_t)byte << (j * 8);
-			}
-			dst.du[i] = result;
-		}
+		const auto& src_j = cpu.registers().getvr(instr.r4.rj);
+		const auto& src_k = cpu.registers().getvr(instr.r4.rk);
+		const auto& idx = cpu.registers().getvr(instr.r4.ra);
+		simd::vshuf_b(cpu.registers().getvr(instr.r4.rd), src_j, src_k, idx);
 	}
 
 	static void VBITSEL_V(cpu_t& cpu, la_instruction instr) {
@@ -3331,179 +2907,67 @@ struct InstrImpl {
 	// === VMAX/VMIN instructions ===
 
 	static void VMAX_B(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 16; i++)
-			dst.b[i] = (src1.b[i] > src2.b[i]) ? src1.b[i] : src2.b[i];
+		simd::lsx<simd::Max<int8_t>, false>(cpu, instr);
 	}
 
 	static void VMAX_H(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 8; i++)
-			dst.h[i] = (src1.h[i] > src2.h[i]) ? src1.h[i] : src2.h[i];
+		simd::lsx<simd::Max<int16_t>, false>(cpu, instr);
 	}
 
 	static void VMAX_W(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 4; i++)
-			dst.w[i] = (src1.w[i] > src2.w[i]) ? src1.w[i] : src2.w[i];
+		simd::lsx<simd::Max<int32_t>, false>(cpu, instr);
 	}
 
 	static void VMAX_D(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 2; i++)
-			dst.d[i] = (src1.d[i] > src2.d[i]) ? src1.d[i] : src2.d[i];
+		simd::lsx<simd::Max<int64_t>, false>(cpu, instr);
 	}
 
 	static void VMAX_BU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 16; i++)
-			dst.bu[i] = (src1.bu[i] > src2.bu[i]) ? src1.bu[i] : src2.bu[i];
+		simd::lsx<simd::Max<uint8_t>, false>(cpu, instr);
 	}
 
 	static void VMAX_HU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 8; i++)
-			dst.hu[i] = (src1.hu[i] > src2.hu[i]) ? src1.hu[i] : src2.hu[i];
+		simd::lsx<simd::Max<uint16_t>, false>(cpu, instr);
 	}
 
 	static void VMAX_WU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 4; i++)
-			dst.wu[i] = (src1.wu[i] > src2.wu[i]) ? src1.wu[i] : src2.wu[i];
+		simd::lsx<simd::Max<uint32_t>, false>(cpu, instr);
 	}
 
 	static void VMAX_DU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 2; i++)
-			dst.du[i] = (src1.du[i] > src2.du[i]) ? src1.du[i] : src2.du[i];
+		simd::lsx<simd::Max<uint64_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_B(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 16; i++)
-			dst.b[i] = (src1.b[i] < src2.b[i]) ? src1.b[i] : src2.b[i];
+		simd::lsx<simd::Min<int8_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_H(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 8; i++)
-			dst.h[i] = (src1.h[i] < src2.h[i]) ? src1.h[i] : src2.h[i];
+		simd::lsx<simd::Min<int16_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_W(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 4; i++)
-			dst.w[i] = (src1.w[i] < src2.w[i]) ? src1.w[i] : src2.w[i];
+		simd::lsx<simd::Min<int32_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_D(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 2; i++)
-			dst.d[i] = (src1.d[i] < src2.d[i]) ? src1.d[i] : src2.d[i];
+		simd::lsx<simd::Min<int64_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_BU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 16; i++)
-			dst.bu[i] = (src1.bu[i] < src2.bu[i]) ? src1.bu[i] : src2.bu[i];
+		simd::lsx<simd::Min<uint8_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_HU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 8; i++)
-			dst.hu[i] = (src1.hu[i] < src2.hu[i]) ? src1.hu[i] : src2.hu[i];
+		simd::lsx<simd::Min<uint16_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_WU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 4; i++)
-			dst.wu[i] = (src1.wu[i] < src2.wu[i]) ? src1.wu[i] : src2.wu[i];
+		simd::lsx<simd::Min<uint32_t>, false>(cpu, instr);
 	}
 
 	static void VMIN_DU(cpu_t& cpu, la_instruction instr) {
-		uint32_t vd = instr.whole & 0x1F;
-		uint32_t vj = (instr.whole >> 5) & 0x1F;
-		uint32_t vk = (instr.whole >> 10) & 0x1F;
-		const auto& src1 = cpu.registers().getvr(vj);
-		const auto& src2 = cpu.registers().getvr(vk);
-		auto& dst = cpu.registers().getvr(vd);
-		for (int i = 0; i < 2; i++)
-			dst.du[i] = (src1.du[i] < src2.du[i]) ? src1.du[i] : src2.du[i];
+		simd::lsx<simd::Min<uint64_t>, false>(cpu, instr);
 	}
 
 
@@ -3532,75 +2996,24 @@ struct InstrImpl {
 	static void XVXOR_V(cpu_t& cpu, la_instruction instr) {
 		// XVXOR.V xd, xj, xk
 		// Bitwise XOR of 256-bit vectors
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		dst.du[0] = src1.du[0] ^ src2.du[0];
-		dst.du[1] = src1.du[1] ^ src2.du[1];
-		dst.du[2] = src1.du[2] ^ src2.du[2];
-		dst.du[3] = src1.du[3] ^ src2.du[3];
+		simd::lasx<simd::Xor>(cpu, instr);
 	}
 
 	static void XVSUB_W(cpu_t& cpu, la_instruction instr) {
 		// XVSUB.W: LASX vector subtract word (256-bit, 8x32-bit)
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		// Subtract each 32-bit word (8 words in 256-bit vector)
-		dst.w[0] = src1.w[0] - src2.w[0];
-		dst.w[1] = src1.w[1] - src2.w[1];
-		dst.w[2] = src1.w[2] - src2.w[2];
-		dst.w[3] = src1.w[3] - src2.w[3];
-		dst.w[4] = src1.w[4] - src2.w[4];
-		dst.w[5] = src1.w[5] - src2.w[5];
-		dst.w[6] = src1.w[6] - src2.w[6];
-		dst.w[7] = src1.w[7] - src2.w[7];
+		simd::lasx<simd::Sub<uint32_t>>(cpu, instr);
 	}
 
 	static void XVMIN_BU(cpu_t& cpu, la_instruction instr) {
 		// XVMIN.BU xd, xj, xk
 		// Unsigned minimum of corresponding bytes (256-bit)
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		for (int i = 0; i < 32; i++) {
-			const uint8_t b1 = src1.bu[i];
-			const uint8_t b2 = src2.bu[i];
-			dst.bu[i] = (b1 < b2) ? b1 : b2;
-		}
+		simd::lasx<simd::Min<uint8_t>>(cpu, instr);
 	}
 
 	static void XVMAX_BU(cpu_t& cpu, la_instruction instr) {
 		// XVMAX.BU xd, xj, xk
 		// Unsigned maximum of corresponding bytes (256-bit)
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		for (int i = 0; i < 32; i++) {
-			const uint8_t b1 = src1.bu[i];
-			const uint8_t b2 = src2.bu[i];
-			dst.bu[i] = (b1 > b2) ? b1 : b2;
-		}
+		simd::lasx<simd::Max<uint8_t>>(cpu, instr);
 	}
 
 	static void XVMSKNZ_B(cpu_t& cpu, la_instruction instr) {
@@ -3682,24 +3095,7 @@ struct InstrImpl {
 	static void XVSEQ_B(cpu_t& cpu, la_instruction instr) {
 		// XVSEQ.B xd, xj, xk
 		// Set each byte to 0xFF if equal, 0x00 if not
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		for (int i = 0; i < 4; i++) {
-			uint64_t result = 0;
-			for (int j = 0; j < 8; j++) {
-				uint8_t b1 = (src1.du[i] >> (j * 8)) & 0xFF;
-				uint8_t b2 = (src2.du[i] >> (j * 8)) & 0xFF;
-				uint8_t cmp = (b1 == b2) ? 0xFF : 0x00;
-				result |= (uint64_t)cmp << (j * 8);
-			}
-			dst.du[i] = result;
-		}
+		simd::lasx<simd::Seq<uint8_t>>(cpu, instr);
 	}
 
 	static void XVSETEQZ_V(cpu_t& cpu, la_instruction instr) {
@@ -3765,66 +3161,22 @@ struct InstrImpl {
 
 	static void XVFADD_D(cpu_t& cpu, la_instruction instr) {
 		// XVFADD.D: LASX vector floating-point add (double precision, 4x64-bit)
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		dst.df[0] = src1.df[0] + src2.df[0];
-		dst.df[1] = src1.df[1] + src2.df[1];
-		dst.df[2] = src1.df[2] + src2.df[2];
-		dst.df[3] = src1.df[3] + src2.df[3];
+		simd::lasx<simd::FAdd<double>>(cpu, instr);
 	}
 
 	static void XVFMUL_D(cpu_t& cpu, la_instruction instr) {
 		// XVFMUL.D: LASX vector floating-point multiply (double precision, 4x64-bit)
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		dst.df[0] = src1.df[0] * src2.df[0];
-		dst.df[1] = src1.df[1] * src2.df[1];
-		dst.df[2] = src1.df[2] * src2.df[2];
-		dst.df[3] = src1.df[3] * src2.df[3];
+		simd::lasx<simd::FMul<double>>(cpu, instr);
 	}
 
 	static void XVFDIV_D(cpu_t& cpu, la_instruction instr) {
 		// XVFDIV.D: LASX vector floating-point divide (double precision, 4x64-bit)
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		dst.df[0] = src1.df[0] / src2.df[0];
-		dst.df[1] = src1.df[1] / src2.df[1];
-		dst.df[2] = src1.df[2] / src2.df[2];
-		dst.df[3] = src1.df[3] / src2.df[3];
+		simd::lasx<simd::FDiv<double>>(cpu, instr);
 	}
 
 	static void XVFSUB_D(cpu_t& cpu, la_instruction instr) {
 		// XVFSUB.D: LASX vector floating-point subtract (double precision, 4x64-bit)
-		uint32_t xd = instr.whole & 0x1F;
-		uint32_t xj = (instr.whole >> 5) & 0x1F;
-		uint32_t xk = (instr.whole >> 10) & 0x1F;
-
-		const auto& src1 = cpu.registers().getvr(xj);
-		const auto& src2 = cpu.registers().getvr(xk);
-		auto& dst = cpu.registers().getvr(xd);
-
-		dst.df[0] = src1.df[0] - src2.df[0];
-		dst.df[1] = src1.df[1] - src2.df[1];
-		dst.df[2] = src1.df[2] - src2.df[2];
-		dst.df[3] = src1.df[3] - src2.df[3];
+		simd::lasx<simd::FSub<double>>(cpu, instr);
 	}
 
 	static void XVBITREVI_D(cpu_t& cpu, la_instruction instr) {
@@ -4316,8 +3668,8 @@ struct InstrImpl {
 			uint64_t val = (bit7 << 63) | ((1 - bit6) << 62) | ((bit6 * 0xFF) << 54) | (bits5_0 << 48);
 			for (int i = 0; i < 4; i++) dst.du[i] = val;
 		} else {
-			throw MachineException(ILLEGAL_OPCODE,
-				"XVLDI: Unknown mode", top5);
+			cpu.trigger_exception(ILLEGAL_OPCODE, top5,
+				"XVLDI: Unknown mode");
 		}
 	}
 
@@ -0,0 +1,458 @@
+#pragma once
+#include "cpu.hpp"
+#include "la_instr.hpp"
+#include "util/simd.hpp"
+#include <cstring>
+#include <type_traits>
+#if LA_SIMD_X86
+#include <immintrin.h>
+#endif
+
+#if LA_SIMD_X86
+#define LA_TARGET_SSE4 __attribute__((target("ssse3,sse4.1,sse4.2")))
+#define LA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace loongarch::simd
+{
+	// Host SIMD implementations of LSX/LASX operations
+	//
+	// Every operation has a portable scalar() reference, which is also the
+	// fallback, and on x86-64 an sse() and an avx2() variant. The variants
+	// must produce bit-identical results, which the unit tests verify by
+	// running each instruction at every util::SimdLevel.
+	// All inputs are read before the destination is written, so any of
+	// vd, vj and vk may be the same register.
+	using vreg_t = Registers::VectorReg256;
+
+	// Element-wise operation, Derived::lane() is the reference for one element
+	template <typename Derived, typename T>
+	struct Lanewise {
+		template <size_t Bytes>
+		static void scalar(vreg_t& dst, const vreg_t& j, const vreg_t& k) {
+			constexpr size_t N = Bytes / sizeof(T);
+			T a[N], b[N];
+			std::memcpy(a, &j, Bytes);
+			std::memcpy(b, &k, Bytes);
+			for (size_t i = 0; i < N; i++)
+				a[i] = Derived::lane(a[i], b[i]);
+			std::memcpy(&dst, a, Bytes);
+		}
+	};
+
+#if LA_SIMD_X86
+	// SSE2 is part of x86-64, so sse() uses it directly and is inlined into the
+	// handler. Newer instructions live in target functions, which cost a call.
+	LA_TARGET_SSE4 static inline __m128i mullo32_sse4(__m128i a, __m128i b) { return _mm_mullo_epi32(a, b); }
+	LA_TARGET_SSE4 static inline __m128i cmpeq64_sse4(__m128i a, __m128i b) { return _mm_cmpeq_epi64(a, b); }
+	LA_TARGET_SSE4 static inline __m128i cmpgt64_sse4(__m128i a, __m128i b) { return _mm_cmpgt_epi64(a, b); }
+#endif
+
+	template <typename T>
+	struct Add : Lanewise<Add<T>, T> {
+		static T lane(T a, T b) { return T(a + b); }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			if constexpr (sizeof(T) == 1) return _mm_add_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm_add_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm_add_epi32(a, b);
+			else return _mm_add_epi64(a, b);
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			if constexpr (sizeof(T) == 1) return _mm256_add_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm256_add_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm256_add_epi32(a, b);
+			else return _mm256_add_epi64(a, b);
+		}
+#endif
+	};
+
+	template <typename T>
+	struct Sub : Lanewise<Sub<T>, T> {
+		static T lane(T a, T b) { return T(a - b); }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			if constexpr (sizeof(T) == 1) return _mm_sub_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm_sub_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm_sub_epi32(a, b);
+			else return _mm_sub_epi64(a, b);
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			if constexpr (sizeof(T) == 1) return _mm256_sub_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm256_sub_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm256_sub_epi32(a, b);
+			else return _mm256_sub_epi64(a, b);
+		}
+#endif
+	};
+
+	// Low half of the product (halfwords and words only)
+	template <typename T>
+	struct Mul : Lanewise<Mul<T>, T> {
+		static_assert(sizeof(T) == 2 || sizeof(T) == 4);
+		// Promote to unsigned, as uint16_t * uint16_t would be a signed int multiplication
+		static T lane(T a, T b) { return T(uint32_t(a) * uint32_t(b)); }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			if constexpr (sizeof(T) == 2) return _mm_mullo_epi16(a, b);
+			else return mullo32_sse4(a, b);
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			if constexpr (sizeof(T) == 2) return _mm256_mullo_epi16(a, b);
+			else return _mm256_mullo_epi32(a, b);
+		}
+#endif
+	};
+
+#if LA_SIMD_X86
+	// Signed a > b for every element, as an all-ones mask
+	template <typename T>
+	static inline __m128i cmpgt_sse(__m128i a, __m128i b) {
+		if constexpr (std::is_unsigned_v<T>) {
+			// Flip the sign bits to compare unsigned as signed
+			const __m128i bias = _mm_set1_epi64x(int64_t(1) << 63);
+			a = _mm_xor_si128(a, bias);
+			b = _mm_xor_si128(b, bias);
+		}
+		if constexpr (sizeof(T) == 1) return _mm_cmpgt_epi8(a, b);
+		else if constexpr (sizeof(T) == 2) return _mm_cmpgt_epi16(a, b);
+		else if constexpr (sizeof(T) == 4) return _mm_cmpgt_epi32(a, b);
+		else return cmpgt64_sse4(a, b);
+	}
+	template <typename T>
+	LA_TARGET_AVX2 static inline __m256i cmpgt_avx2(__m256i a, __m256i b) {
+		if constexpr (std::is_unsigned_v<T>) {
+			const __m256i bias = _mm256_set1_epi64x(int64_t(1) << 63);
+			a = _mm256_xor_si256(a, bias);
+			b = _mm256_xor_si256(b, bias);
+		}
+		if constexpr (sizeof(T) == 1) return _mm256_cmpgt_epi8(a, b);
+		else if constexpr (sizeof(T) == 2) return _mm256_cmpgt_epi16(a, b);
+		else if constexpr (sizeof(T) == 4) return _mm256_cmpgt_epi32(a, b);
+		else return _mm256_cmpgt_epi64(a, b);
+	}
+#endif
+
+	template <typename T>
+	struct Max : Lanewise<Max<T>, T> {
+		static T lane(T a, T b) { return (a > b) ? a : b; }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			if constexpr (std::is_same_v<T, int16_t>) return _mm_max_epi16(a, b);
+			else if constexpr (std::is_same_v<T, uint8_t>) return _mm_max_epu8(a, b);
+			else return sse4(a, b);
+		}
+		LA_TARGET_SSE4 static __m128i sse4(__m128i a, __m128i b) {
+			if constexpr (std::is_same_v<T, int8_t>) return _mm_max_epi8(a, b);
+			else if constexpr (std::is_same_v<T, int32_t>) return _mm_max_epi32(a, b);
+			else if constexpr (std::is_same_v<T, uint16_t>) return _mm_max_epu16(a, b);
+			else if constexpr (std::is_same_v<T, uint32_t>) return _mm_max_epu32(a, b);
+			else return _mm_blendv_epi8(b, a, cmpgt_sse<T>(a, b));
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			if constexpr (std::is_same_v<T, int8_t>) return _mm256_max_epi8(a, b);
+			else if constexpr (std::is_same_v<T, int16_t>) return _mm256_max_epi16(a, b);
+			else if constexpr (std::is_same_v<T, int32_t>) return _mm256_max_epi32(a, b);
+			else if constexpr (std::is_same_v<T, uint8_t>) return _mm256_max_epu8(a, b);
+			else if constexpr (std::is_same_v<T, uint16_t>) return _mm256_max_epu16(a, b);
+			else if constexpr (std::is_same_v<T, uint32_t>) return _mm256_max_epu32(a, b);
+			else return _mm256_blendv_epi8(b, a, cmpgt_avx2<T>(a, b));
+		}
+#endif
+	};
+
+	template <typename T>
+	struct Min : Lanewise<Min<T>, T> {
+		static T lane(T a, T b) { return (a < b) ? a : b; }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			if constexpr (std::is_same_v<T, int16_t>) return _mm_min_epi16(a, b);
+			else if constexpr (std::is_same_v<T, uint8_t>) return _mm_min_epu8(a, b);
+			else return sse4(a, b);
+		}
+		LA_TARGET_SSE4 static __m128i sse4(__m128i a, __m128i b) {
+			if constexpr (std::is_same_v<T, int8_t>) return _mm_min_epi8(a, b);
+			else if constexpr (std::is_same_v<T, int32_t>) return _mm_min_epi32(a, b);
+			else if constexpr (std::is_same_v<T, uint16_t>) return _mm_min_epu16(a, b);
+			else if constexpr (std::is_same_v<T, uint32_t>) return _mm_min_epu32(a, b);
+			else return _mm_blendv_epi8(b, a, cmpgt_sse<T>(b, a));
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			if constexpr (std::is_same_v<T, int8_t>) return _mm256_min_epi8(a, b);
+			else if constexpr (std::is_same_v<T, int16_t>) return _mm256_min_epi16(a, b);
+			else if constexpr (std::is_same_v<T, int32_t>) return _mm256_min_epi32(a, b);
+			else if constexpr (std::is_same_v<T, uint8_t>) return _mm256_min_epu8(a, b);
+			else if constexpr (std::is_same_v<T, uint16_t>) return _mm256_min_epu16(a, b);
+			else if constexpr (std::is_same_v<T, uint32_t>) return _mm256_min_epu32(a, b);
+			else return _mm256_blendv_epi8(b, a, cmpgt_avx2<T>(b, a));
+		}
+#endif
+	};
+
+	// All ones where a == b
+	template <typename T>
+	struct Seq : Lanewise<Seq<T>, T> {
+		static T lane(T a, T b) { return (a == b) ? T(~T(0)) : T(0); }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			if constexpr (sizeof(T) == 1) return _mm_cmpeq_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm_cmpeq_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm_cmpeq_epi32(a, b);
+			else return cmpeq64_sse4(a, b);
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			if constexpr (sizeof(T) == 1) return _mm256_cmpeq_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(a, b);
+			else return _mm256_cmpeq_epi64(a, b);
+		}
+#endif
+	};
+
+	// All ones where a < b (signed)
+	template <typename T>
+	struct Slt : Lanewise<Slt<T>, T> {
+		static_assert(std::is_signed_v<T>);
+		static T lane(T a, T b) { return (a < b) ? T(-1) : T(0); }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) { return cmpgt_sse<T>(b, a); }
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) { return cmpgt_avx2<T>(b, a); }
+#endif
+	};
+
+	struct And : Lanewise<And, uint64_t> {
+		static uint64_t lane(uint64_t a, uint64_t b) { return a & b; }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#endif
+	};
+
+	struct Or : Lanewise<Or, uint64_t> {
+		static uint64_t lane(uint64_t a, uint64_t b) { return a | b; }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#endif
+	};
+
+	struct Xor : Lanewise<Xor, uint64_t> {
+		static uint64_t lane(uint64_t a, uint64_t b) { return a ^ b; }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#endif
+	};
+
+	struct Nor : Lanewise<Nor, uint64_t> {
+		static uint64_t lane(uint64_t a, uint64_t b) { return ~(a | b); }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			return _mm_xor_si128(_mm_or_si128(a, b), _mm_set1_epi32(-1));
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			return _mm256_xor_si256(_mm256_or_si256(a, b), _mm256_set1_epi32(-1));
+		}
+#endif
+	};
+
+	// a | ~b
+	struct Orn : Lanewise<Orn, uint64_t> {
+		static uint64_t lane(uint64_t a, uint64_t b) { return a | ~b; }
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			return _mm_or_si128(a, _mm_xor_si128(b, _mm_set1_epi32(-1)));
+		}
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) {
+			return _mm256_or_si256(a, _mm256_xor_si256(b, _mm256_set1_epi32(-1)));
+		}
+#endif
+	};
+
+	// IEEE-754 arithmetic in the default rounding mode, same as the scalar FPU handlers
+#if LA_SIMD_X86
+#define LA_SIMD_FP_OP(Name, op, ps, pd) \
+	template <typename T> \
+	struct Name : Lanewise<Name<T>, T> { \
+		static T lane(T a, T b) { return a op b; } \
+		static __m128i sse(__m128i a, __m128i b) { \
+			if constexpr (sizeof(T) == 4) return _mm_castps_si128(_mm_##ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); \
+			else return _mm_castpd_si128(_mm_##pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); \
+		} \
+		LA_TARGET_AVX2 static __m256i avx2(__m256i a, __m256i b) { \
+			if constexpr (sizeof(T) == 4) return _mm256_castps_si256(_mm256_##ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b))); \
+			else return _mm256_castpd_si256(_mm256_##pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b))); \
+		} \
+	};
+#else
+#define LA_SIMD_FP_OP(Name, op, ps, pd) \
+	template <typename T> \
+	struct Name : Lanewise<Name<T>, T> { \
+		static T lane(T a, T b) { return a op b; } \
+	};
+#endif
+	LA_SIMD_FP_OP(FAdd, +, add_ps, add_pd)
+	LA_SIMD_FP_OP(FSub, -, sub_ps, sub_pd)
+	LA_SIMD_FP_OP(FMul, *, mul_ps, mul_pd)
+	LA_SIMD_FP_OP(FDiv, /, div_ps, div_pd)
+#undef LA_SIMD_FP_OP
+
+	// VILVL: interleave the low halves, k first: [k0, j0, k1, j1, ...]
+	template <typename T>
+	struct InterleaveLow {
+		template <size_t Bytes>
+		static void scalar(vreg_t& dst, const vreg_t& j, const vreg_t& k) {
+			static_assert(Bytes == 16);
+			constexpr size_t N = Bytes / sizeof(T);
+			T a[N], b[N], r[N];
+			std::memcpy(a, &j, Bytes);
+			std::memcpy(b, &k, Bytes);
+			for (size_t i = 0; i < N / 2; i++) {
+				r[i * 2] = b[i];
+				r[i * 2 + 1] = a[i];
+			}
+			std::memcpy(&dst, r, Bytes);
+		}
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			if constexpr (sizeof(T) == 1) return _mm_unpacklo_epi8(b, a);
+			else if constexpr (sizeof(T) == 2) return _mm_unpacklo_epi16(b, a);
+			else if constexpr (sizeof(T) == 4) return _mm_unpacklo_epi32(b, a);
+			else return _mm_unpacklo_epi64(b, a);
+		}
+#endif
+	};
+
+	// VILVH.D: [k1, j1]
+	struct InterleaveHigh64 {
+		template <size_t Bytes>
+		static void scalar(vreg_t& dst, const vreg_t& j, const vreg_t& k) {
+			static_assert(Bytes == 16);
+			const uint64_t r0 = k.du[1], r1 = j.du[1];
+			dst.du[0] = r0;
+			dst.du[1] = r1;
+		}
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) { return _mm_unpackhi_epi64(b, a); }
+#endif
+	};
+
+	// VPICKEV.W: [k0, k2, j0, j2]
+	struct PickEven32 {
+		template <size_t Bytes>
+		static void scalar(vreg_t& dst, const vreg_t& j, const vreg_t& k) {
+			static_assert(Bytes == 16);
+			const uint32_t r[4] = { k.wu[0], k.wu[2], j.wu[0], j.wu[2] };
+			std::memcpy(&dst, r, sizeof(r));
+		}
+#if LA_SIMD_X86
+		static __m128i sse(__m128i a, __m128i b) {
+			return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(b), _mm_castsi128_ps(a), _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+#endif
+	};
+
+#if LA_SIMD_X86
+	template <typename Op>
+	static inline void run_sse(vreg_t& dst, const vreg_t& j, const vreg_t& k, size_t offset) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&j.bu[offset]));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&k.bu[offset]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst.bu[offset]), Op::sse(a, b));
+	}
+	template <typename Op>
+	LA_TARGET_AVX2 static inline void run_avx2(vreg_t& dst, const vreg_t& j, const vreg_t& k) {
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&j));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&k));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&dst), Op::avx2(a, b));
+	}
+#endif
+
+	// 128-bit LSX operation vd = Op(vj, vk)
+	// ZeroUpper clears bits 255:128 of vd, as most LSX handlers do.
+	template <typename Op, bool ZeroUpper = true>
+	static inline void lsx(Registers& regs, unsigned vd, unsigned vj, unsigned vk) {
+		const auto& j = regs.getvr(vj);
+		const auto& k = regs.getvr(vk);
+		auto& dst = regs.getvr(vd);
+#if LA_SIMD_X86
+		if (util::simd_level() != util::SimdLevel::Scalar)
+			run_sse<Op>(dst, j, k, 0);
+		else
+#endif
+			Op::template scalar<16>(dst, j, k);
+		if constexpr (ZeroUpper) {
+			dst.du[2] = 0;
+			dst.du[3] = 0;
+		}
+	}
+
+	// 256-bit LASX operation xd = Op(xj, xk)
+	template <typename Op>
+	static inline void lasx(Registers& regs, unsigned xd, unsigned xj, unsigned xk) {
+		const auto& j = regs.getvr(xj);
+		const auto& k = regs.getvr(xk);
+		auto& dst = regs.getvr(xd);
+#if LA_SIMD_X86
+		switch (util::simd_level()) {
+		case util::SimdLevel::AVX2:
+			run_avx2<Op>(dst, j, k);
+			return;
+		case util::SimdLevel::SSE4:
+			// The upper half of the result only depends on the upper halves
+			run_sse<Op>(dst, j, k, 0);
+			run_sse<Op>(dst, j, k, 16);
+			return;
+		case util::SimdLevel::Scalar:
+			break;
+		}
+#endif
+		Op::template scalar<32>(dst, j, k);
+	}
+
+	// Instruction handler forms, for the 3R encodings
+	template <typename Op, bool ZeroUpper = true>
+	static inline void lsx(CPU& cpu, la_instruction instr) {
+		lsx<Op, ZeroUpper>(cpu.registers(), instr.r3.rd, instr.r3.rj, instr.r3.rk);
+	}
+	template <typename Op>
+	static inline void lasx(CPU& cpu, la_instruction instr) {
+		lasx<Op>(cpu.registers(), instr.r3.rd, instr.r3.rj, instr.r3.rk);
+	}
+
+	// VSHUF.B vd, vj, vk, va: vd[i] = [vk, vj][va[i] & 0x1F]
+	static inline void vshuf_b_scalar(vreg_t& dst, const vreg_t& j, const vreg_t& k, const vreg_t& idx) {
+		uint8_t combined[32];
+		uint8_t result[16];
+		std::memcpy(&combined[0], &k, 16);
+		std::memcpy(&combined[16], &j, 16);
+		for (int i = 0; i < 16; i++)
+			result[i] = combined[idx.bu[i] & 0x1F];
+		std::memcpy(&dst, result, 16);
+	}
+#if LA_SIMD_X86
+	LA_TARGET_SSE4 static inline void vshuf_b_sse(vreg_t& dst, const vreg_t& j, const vreg_t& k, const vreg_t& idx) {
+		const __m128i index = _mm_and_si128(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(&idx)), _mm_set1_epi8(0x1F));
+		// PSHUFB only looks at the low 4 bits (bit 7 is clear), bit 4 selects the source
+		const __m128i from_k = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&k)), index);
+		const __m128i from_j = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&j)), index);
+		const __m128i select_j = _mm_cmpgt_epi8(index, _mm_set1_epi8(15));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&dst), _mm_blendv_epi8(from_k, from_j, select_j));
+	}
+#endif
+	static inline void vshuf_b(vreg_t& dst, const vreg_t& j, const vreg_t& k, const vreg_t& idx) {
+#if LA_SIMD_X86
+		if (util::simd_level() != util::SimdLevel::Scalar) {
+			vshuf_b_sse(dst, j, k, idx);
+			return;
+		}
+#endif
+		vshuf_b_scalar(dst, j, k, idx);
+	}
+
+} // namespace loongarch::simd
+
+#if LA_SIMD_X86
+#undef LA_TARGET_SSE4
+#undef LA_TARGET_AVX2
+#endif
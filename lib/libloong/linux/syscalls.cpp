@@ -16,6 +16,9 @@ namespace loongarch
 	static constexpr int64_t LA_EAGAIN = 11;
 	static constexpr int64_t LA_ENOTTY = 25;
 
+	// Memory protection flags
+	static constexpr int LA_PROT_EXEC = 0x4;
+
 	// Syscall numbers (LoongArch Linux ABI)
 	enum [[maybe_unused]] LA_Syscalls {
 		LA_SYS_ioctl = 29,
@@ -215,9 +218,15 @@ namespace loongarch
 	// Mprotect syscall
 	static void syscall_mprotect(Machine& machine)
 	{
-		(void)machine;
-		// Always succeed (memory protections not enforced in emulator)
+		auto [addr, length, prot] =
+			machine.template sysargs<address_t, size_t, int>();
+		// Memory protections are not enforced in the emulator, but
+		// executable ranges are tracked for guest-generated code
+		machine.memory.set_executable(addr, length, (prot & LA_PROT_EXEC) != 0);
 		machine.set_result(0);
+		sysprint(machine, "mprotect(addr=0x%llx, len=%llu, prot=0x%x) = %d\n",
+			static_cast<uint64_t>(addr), static_cast<uint64_t>(length), prot,
+			machine.template return_value<int>());
 	}
 
 	// Madvise syscall
@@ -609,6 +618,11 @@ namespace loongarch
 			machine.set_result(-1);
 		}
 
+		const auto result = machine.template return_value<address_t>();
+		if ((prot & LA_PROT_EXEC) && result != static_cast<address_t>(-1)) {
+			machine.memory.set_executable(result, length, true);
+		}
+
 		// Anonymous mapping: zero out the memory
 		if (false && machine.template return_value<address_t>() != static_cast<address_t>(-1)) {
 			if (flags & 0x20) { // MAP_ANONYMOUS
@@ -626,6 +640,7 @@ namespace loongarch
 		const auto addr  = machine.cpu.reg(REG_A0);
 		const auto length = machine.cpu.reg(REG_A1);
 
+		machine.memory.set_executable(addr, length, false);
 		machine.memory.mmap_deallocate(addr, length);
 		machine.set_result(0);
 		sysprint(machine, "munmap(addr=0x%llx, len=%llu) = %d\n",
@@ -5,7 +5,9 @@
 #include <cstring>
 #include <mutex>
 #include <algorithm>
+#include <bit>
 #include "native/heap.hpp"
+#include "util/watchdog.hpp"
 
 namespace loongarch
 {
@@ -14,10 +16,21 @@ namespace loongarch
 		  m_arena(nullptr)
 	{
 		cpu.reset();  // Reset CPU after memory is loaded
+#ifdef LA_BINARY_TRANSLATION
+		if (options.translate_enabled && options.translate_hot_threshold != 0)
+			m_translate_hot_mask = std::bit_ceil(std::max<uint64_t>(options.translate_hot_threshold, 2)) - 1;
+#endif
 		// Initialize all system call handlers to a throwing stub on first creation (thread-safe)
 		static std::once_flag init_flag;
 		std::call_once(init_flag, []() {
 			m_unknown_syscall_handler = [](Machine& m, int sysnum) {
+				if (CPU::FaultTrap* trap = m.fault_trap()) {
+					// Reported by try_simulate(), without unwinding
+					trap->fault = GuestFault{UNIMPLEMENTED_SYSCALL, uint64_t(sysnum),
+						m.cpu.pc(), "Unimplemented system call"};
+					m.stop();
+					return;
+				}
 				throw MachineException(UNIMPLEMENTED_SYSCALL,
 					"Unimplemented system call", sysnum);
 			};
@@ -40,6 +53,58 @@ namespace loongarch
 	{
 	}
 
+	bool Machine::simulate_for(std::chrono::nanoseconds timeout)
+	{
+		// A stop requested before the call is not lost. The flag is cleared
+		// on exit instead, in case the timer fired after the program stopped.
+		if (m_stop_flag.exchange(false, std::memory_order_relaxed))
+			return false;
+		const auto timer = util::Watchdog::arm(m_stop_flag, timeout);
+		try {
+			const bool stopped = cpu.simulate_watchdog(cpu.pc());
+			util::Watchdog::disarm(timer);
+			m_stop_flag.store(false, std::memory_order_relaxed);
+			return stopped;
+		} catch (...) {
+			util::Watchdog::disarm(timer);
+			m_stop_flag.store(false, std::memory_order_relaxed);
+			throw;
+		}
+	}
+
+	GuestFault Machine::try_simulate(uint64_t max_instructions, uint64_t counter)
+	{
+		CPU::FaultTrap trap;
+		CPU::FaultTrap* const outer_trap = m_fault_trap;
+		CPU::FaultTrap* const outer_armed = CPU::arm_fault_trap(&trap);
+		CPU::ExecutePin* const outer_pins = cpu.execute_pins();
+		m_fault_trap = &trap;
+		auto restore = [&] {
+			CPU::arm_fault_trap(outer_armed);
+			m_fault_trap = outer_trap;
+		};
+
+		if (setjmp(trap.jump) == 0) {
+			try {
+				const bool stopped = cpu.simulate_trapping(cpu.pc(), counter, max_instructions);
+				if (!stopped && !trap.fault)
+					trap.fault = GuestFault{MACHINE_TIMEOUT, 0, cpu.pc(), "Instruction limit reached"};
+			} catch (const MachineException& e) {
+				trap.fault = GuestFault{e.type(), e.data(), cpu.pc(), CPU::exception_message(e.type())};
+			} catch (...) {
+				restore();
+				throw;
+			}
+		} else {
+			// A fault site recorded the fault and jumped back here
+			cpu.restore_execute_pins(outer_pins);
+			trap.fault.pc = cpu.pc_of(trap.decoder);
+			cpu.aligned_jump(trap.fault.pc);
+		}
+		restore();
+		return trap.fault;
+	}
+
 	void Machine::set_options(const std::shared_ptr<MachineOptions> options)
 	{
 		this->m_options = std::move(options);
@@ -2,6 +2,8 @@
 #include "common.hpp"
 #include "cpu.hpp"
 #include "memory.hpp"
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <functional>
@@ -13,12 +15,14 @@ namespace loongarch
 	struct Signals;
 	struct SignalAction;
 	struct MultiThreading;
+	struct SampleProfiler;
 
 	struct alignas(LA_MACHINE_ALIGNMENT) Machine
 	{
 		using syscall_t = void(Machine&);
 		using unknown_syscall_t = void(Machine&, int);
 		using rdtime_callback_t = uint64_t(Machine&);
+		using dispatch_tracer_t = void(Machine&, address_t pc);
 
 		// Construction
 		Machine(std::string_view binary, const MachineOptions& options = {});
@@ -48,11 +52,47 @@ namespace loongarch
 			const std::vector<std::string>& env);
 		static void setup_minimal_syscalls();
 		static void setup_linux_syscalls();
-		void setup_accelerated_syscalls(); // Warning: modifies decoder cache
+		void setup_accelerated_syscalls(); // Patches a private copy of the decoder cache
 		void set_options(const std::shared_ptr<MachineOptions> options); // Non-owning reference
 
 		// Execution
 		bool simulate(uint64_t max_instructions = UINT64_MAX, uint64_t counter = 0);
+		// Block profiling runs simulate() with a dispatch variant that counts every
+		// block entry, see collect_block_profile(). The regular dispatch is unaffected.
+		void set_block_profiling(bool enabled) noexcept { m_block_profiling = enabled; }
+		bool is_block_profiling() const noexcept { return m_block_profiling; }
+		// While a dispatch tracer is set, simulate() runs a dispatch variant that
+		// calls it with the PC of every block it enters (nullptr disables).
+		// Takes precedence over block profiling.
+		void set_dispatch_tracer(dispatch_tracer_t* tracer) noexcept { m_dispatch_tracer = tracer; }
+		dispatch_tracer_t* dispatch_tracer() const noexcept { return m_dispatch_tracer; }
+		// Block entry count mask of tiered binary translation, zero when disabled
+		// A block is translated when its count is a multiple of the mask + 1.
+		uint64_t translate_hot_mask() const noexcept { return m_translate_hot_mask; }
+		// While a sample profiler is attached, simulate() stops every interval
+		// instructions to record a stack sample. Not owned by the machine.
+		void set_sample_profiler(SampleProfiler* profiler) noexcept { m_sample_profiler = profiler; }
+		SampleProfiler* sample_profiler() const noexcept { return m_sample_profiler; }
+
+		// Run without instruction counting until the program stops or the
+		// wall-clock timeout runs out (see CPU::simulate_watchdog).
+		// Returns false on timeout, with PC at the next block to execute.
+		bool simulate_for(std::chrono::nanoseconds timeout);
+		// Asynchronous stop, safe to call from any thread. Only the watchdog
+		// dispatch polls the flag, and it clears the flag when it stops.
+		// A stop requested before simulate_for() makes it return right away.
+		void request_stop() noexcept { m_stop_flag.store(true, std::memory_order_relaxed); }
+		std::atomic<bool>& stop_flag() noexcept { return m_stop_flag; }
+
+		// simulate() that returns guest faults instead of throwing them
+		// Faults inside the interpreter longjmp straight back here (see
+		// CPU::FaultTrap), and an unimplemented system call just stops. Other
+		// exceptions from system call handlers are caught and converted, so
+		// they still unwind. Reaching the instruction limit is a MACHINE_TIMEOUT
+		// fault. Exceptions that are not MachineException are not caught.
+		GuestFault try_simulate(uint64_t max_instructions = UINT64_MAX, uint64_t counter = 0);
+		// The fault trap of the running try_simulate(), or nullptr
+		CPU::FaultTrap* fault_trap() const noexcept { return m_fault_trap; }
 
 		void stop() noexcept { m_max_instructions = 0; }
 		bool stopped() const noexcept { return m_counter >= m_max_instructions; }
@@ -108,6 +148,13 @@ namespace loongarch
 		// Use Machine::return_value<T>() to get typed return values
 		template <typename... Args>
 		void timed_vmcall(address_t func_addr, uint64_t max_instructions, Args&&... args);
+		// Timed function call with a wall-clock limit, see simulate_for()
+		template <typename... Args>
+		void timed_vmcall(address_t func_addr, std::chrono::nanoseconds timeout, Args&&... args);
+		// Function call that returns guest faults instead of throwing them,
+		// see try_simulate(). Use Machine::return_value<T>() for the result.
+		template <typename... Args>
+		GuestFault try_vmcall(address_t func_addr, uint64_t max_instructions, Args&&... args);
 
 		// Preemptible function calls with instruction limit
 		template <bool Throw = true, bool StoreRegs = false, typename... Args>
@@ -127,6 +174,7 @@ namespace loongarch
 		const Symbol* lookup_symbol(address_t addr) const;
 		std::string lookup_demangled_symbol(address_t addr, bool with_offset = true) const;
 		std::string backtrace(address_t initial = 0) const;
+		std::vector<address_t> backtrace_addresses(address_t initial = 0, bool code_only = false, size_t max_depth = 64) const;
 
 		// Components
 		CPU cpu;
@@ -157,6 +205,29 @@ namespace loongarch
 			uint32_t sample_instruction; // Sample instruction bits for fallback bytecodes
 		};
 		std::vector<BytecodeStats> collect_bytecode_statistics() const;
+		// Dynamic per-instruction execution counts, sorted by count
+		// Only available with LA_INSTRUCTION_PROFILING, otherwise empty.
+		struct InstructionProfile {
+			InstrId id;
+			uint8_t bytecode;            // Bytecode the instruction is dispatched as
+			uint32_t sample_instruction; // Original instruction bits
+			uint64_t count;
+		};
+		std::vector<InstructionProfile> collect_instruction_profile() const;
+		// Executed blocks, sorted by the number of instructions executed in them
+		struct BlockProfile {
+			address_t pc;
+			uint64_t count;        // Times the block was entered at pc
+			uint32_t instructions; // Instructions from pc to the end of the block, chained blocks excluded
+			std::string symbol;    // Symbol and offset, if known
+		};
+		// The counts live in the execute segments: machines sharing a segment
+		// add up their counts, and a cached shared segment keeps them for the
+		// next machine. reset_block_profile() zeroes the counts of the segments
+		// of this machine, for every machine using them. Tiered translation
+		// counts block entries in the same place, and starts over too.
+		std::vector<BlockProfile> collect_block_profile() const;
+		void reset_block_profile();
 		bool is_binary_translation_enabled() const noexcept;
 
 		// Signal handling
@@ -185,11 +256,20 @@ namespace loongarch
 		std::unique_ptr<Signals> m_signals;
 		std::unique_ptr<MultiThreading> m_mt;
 		std::exception_ptr m_current_exception = nullptr;
+		bool m_block_profiling = false;
+		dispatch_tracer_t* m_dispatch_tracer = nullptr;
+		uint64_t m_translate_hot_mask = 0;
+		SampleProfiler* m_sample_profiler = nullptr;
+		std::atomic<bool> m_stop_flag = false;
+		CPU::FaultTrap* m_fault_trap = nullptr;
 		static inline std::array<syscall_t*, LA_SYSCALLS_MAX> m_syscall_handlers = {};
 		static inline unknown_syscall_t* m_unknown_syscall_handler = nullptr;
 		static inline rdtime_callback_t* m_rdtime_handler = nullptr;
 
 		void push_argument(address_t& sp, address_t value);
+		bool simulate_sampled(uint64_t max_instructions, uint64_t counter);
+		// Runs the dispatch variant selected by the diagnostics settings
+		bool simulate_dispatch(uint64_t max_instructions, uint64_t counter);
 
 		// Helper for sysargs
 		template<typename... Args, std::size_t... Indices>
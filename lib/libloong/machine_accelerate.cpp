@@ -40,9 +40,11 @@ static inline void patch(Machine& machine, const std::vector<std::string> symbol
 			entry.handler_idx = 0; // Invalid
 			entry.block_bytes = 0; // Diverges here
 			entry.instr = syscall_number;
-			// Install into decoder cache
-			auto& exec_seg = *machine.memory.exec_segment_for(addr);
-			exec_seg.set(addr, entry);
+			// Install into this machine's decoder cache
+			auto* exec_seg = machine.memory.private_execute_segment_for(addr);
+			if (exec_seg != nullptr) {
+				exec_seg->set(addr, entry);
+			}
 		}
 	}
 }
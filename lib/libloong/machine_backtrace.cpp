@@ -40,39 +40,84 @@ std::string Machine::lookup_demangled_symbol(address_t addr, bool with_offset) c
 // This is a remote backtrace, so we obviously cannot use native stack unwinding.
 // Instead, we will simulate a backtrace by walking the saved return addresses
 // on the stack. This is inherently unreliable, but it's better than nothing.
-std::string Machine::backtrace(address_t initial) const
+std::vector<address_t> Machine::backtrace_addresses(address_t initial, bool code_only, size_t max_depth) const
 {
 	if (initial == 0) {
 		initial = cpu.pc();
 	}
-	char buffer[4096];
-	int n = snprintf(buffer, sizeof(buffer),
-		"#-: 0x%016lx %s\n",
-		(unsigned long)initial,
-		lookup_demangled_symbol(initial).c_str());
+	std::vector<address_t> result;
+	result.push_back(initial);
 
-	std::string result;
-	if (n > 0) {
-		result.append(buffer, static_cast<size_t>(n));
-	} else {
-		return result;
-	}
+	// The function containing addr, when the symbol table says so
+	auto function_at = [this](address_t addr) -> const Symbol* {
+		const Symbol* symbol = memory.lookup_symbol(addr);
+		if (symbol != nullptr && addr >= symbol->address && addr - symbol->address < symbol->size)
+			return symbol;
+		return nullptr;
+	};
+	// A return address follows the call that made it, from inside a function:
+	// BL, or JIRL $ra. A direct call, BL or PCADDU18I + JIRL, must also have
+	// called the function of the frame before it: old return addresses stay
+	// on the stack after their calls have returned, and usually fail that
+	// test. Frames left by tail calls fail it too, and are dropped. Without
+	// symbols, any call is accepted.
+	auto is_return_address = [&](address_t addr, address_t callee) -> bool {
+		if ((addr & 3) != 0 || memory.find_execute_segment(addr - 4) == nullptr)
+			return false;
+		uint32_t call, prev = 0;
+		try {
+			call = memory.template read<uint32_t>(addr - 4);
+			if (memory.find_execute_segment(addr - 8) != nullptr)
+				prev = memory.template read<uint32_t>(addr - 8);
+		} catch (...) {
+			return false;
+		}
+		address_t target = 0;
+		if ((call >> 26) == 0x15) { // BL: offs[15:0] in bits 25:10, offs[25:16] in bits 9:0
+			const int32_t offs26 = int32_t((((call & 0x3FF) << 16) | ((call >> 10) & 0xFFFF)) << 6) >> 6;
+			target = addr - 4 + (int64_t(offs26) << 2);
+		} else if ((call >> 26) == 0x13 && (call & 0x1F) == REG_RA) { // JIRL $ra, rj, offs16
+			const uint32_t rj = (call >> 5) & 0x1F;
+			if ((prev >> 25) == 0x0F && (prev & 0x1F) == rj) { // PCADDU18I rj, si20
+				const int32_t si20 = int32_t(prev << 7) >> 12;
+				const int32_t offs16 = int32_t(call << 6) >> 16;
+				target = addr - 8 + (int64_t(si20) << 18) + (int64_t(offs16) << 2);
+			}
+		} else {
+			return false;
+		}
+		const Symbol* callee_function = function_at(callee);
+		if (callee_function == nullptr)
+			return true;
+		if (function_at(addr - 4) == nullptr)
+			return false;
+		// Indirect calls, and calls through unnamed stubs, are not checked
+		const Symbol* target_function = (target != 0) ? function_at(target) : nullptr;
+		return target_function == nullptr || target_function == callee_function;
+	};
 
 	/// XXX: If the binary has unwinding information, we could use that here
 	/// to do a more reliable backtrace. For now, we will just read the return
-	/// addresses from the stack.
+	/// addresses from the stack. With code_only, stack words that are not
+	/// return addresses are skipped, which turns the walk into a stack scan.
 	address_t sp = cpu.reg(REG_SP);
 	address_t ra = cpu.reg(REG_RA);
-	size_t depth = 0;
-	while (ra != 0 && depth < 64) {
-		int n = snprintf(buffer, sizeof(buffer),
-			"#%zu: 0x%016lx %s\n",
-			depth,
-			(unsigned long)ra,
-			lookup_demangled_symbol(ra).c_str());
-		if (n > 0) {
-			result.append(buffer, static_cast<size_t>(n));
-		} else {
+	// With code_only, the first copy of RA on the stack is where the current
+	// function saved it, not another frame
+	address_t saved_ra = 0;
+	size_t scanned = 0;
+	for (bool in_register = true; result.size() <= max_depth; in_register = false) {
+		if (!code_only) {
+			if (ra == 0)
+				break;
+			result.push_back(ra);
+		} else if (ra != 0 && ra == saved_ra) {
+			saved_ra = 0;
+		} else if (is_return_address(ra, result.back())) {
+			if (in_register)
+				saved_ra = ra;
+			result.push_back(ra);
+		} else if (++scanned > 16 * max_depth) {
 			break;
 		}
 		// Read next return address from stack
@@ -82,7 +127,27 @@ std::string Machine::backtrace(address_t initial) const
 		} catch (...) {
 			break; // Unable to read memory
 		}
-		depth++;
+	}
+	return result;
+}
+
+std::string Machine::backtrace(address_t initial) const
+{
+	const auto addresses = backtrace_addresses(initial);
+	std::string result;
+	char buffer[4096];
+	for (size_t i = 0; i < addresses.size(); i++) {
+		int n;
+		if (i == 0) {
+			n = snprintf(buffer, sizeof(buffer), "#-: 0x%016lx %s\n",
+				(unsigned long)addresses[i], lookup_demangled_symbol(addresses[i]).c_str());
+		} else {
+			n = snprintf(buffer, sizeof(buffer), "#%zu: 0x%016lx %s\n",
+				i - 1, (unsigned long)addresses[i], lookup_demangled_symbol(addresses[i]).c_str());
+		}
+		if (n <= 0)
+			break;
+		result.append(buffer, static_cast<size_t>(n));
 	}
 	return result;
 }
@@ -82,4 +82,88 @@ namespace loongarch
 		return stats;
 	}
 
+	std::vector<typename Machine::InstructionProfile> Machine::collect_instruction_profile() const
+	{
+		std::vector<InstructionProfile> profile;
+#ifdef LA_INSTRUCTION_PROFILING
+		// Accumulate counts per instruction ID across all execute segments
+		std::unordered_map<InstrId, size_t> index_of;
+		memory.for_each_execute_segment([&](const DecodedExecuteSegment& segment) {
+			const auto* execution = segment.execution_profile();
+			if (execution == nullptr)
+				return;
+			const auto* cache = segment.decoder_cache();
+			for (size_t i = 0; i < execution->counts.size(); ++i) {
+				const uint64_t count = execution->counts[i];
+				if (count == 0)
+					continue;
+				const uint32_t instr = execution->instructions[i];
+				const InstrId id = CPU::decode(la_instruction{instr}).id;
+
+				auto it = index_of.find(id);
+				if (it == index_of.end()) {
+					it = index_of.emplace(id, profile.size()).first;
+					profile.push_back({id, cache[i].get_bytecode(), instr, 0});
+				}
+				profile[it->second].count += count;
+			}
+		});
+
+		std::sort(profile.begin(), profile.end(), [](const InstructionProfile& a, const InstructionProfile& b) {
+			return a.count > b.count;
+		});
+#endif
+		return profile;
+	}
+
+	// Instructions from entry i to the end of its own block, as the dispatch
+	// counts them. A chained branch ends it: its block_bytes also cover the
+	// target block, which the profiling dispatch enters and counts on its own.
+	// The invalid entry after the last one always ends a block.
+	static uint32_t own_instruction_count(const DecoderData* cache, size_t i)
+	{
+		size_t end = i;
+		while (cache[end].block_bytes != 0) {
+			const uint8_t bytecode = cache[end].get_bytecode();
+			if (bytecode == LA64_BC_B_CHAINED || bytecode == LA64_BC_BL_CHAINED)
+				break;
+			end++;
+		}
+		return uint32_t(end - i + 1);
+	}
+
+	std::vector<typename Machine::BlockProfile> Machine::collect_block_profile() const
+	{
+		std::vector<BlockProfile> profile;
+		memory.for_each_execute_segment([&](const DecodedExecuteSegment& segment) {
+			const uint64_t* counts = segment.block_counts();
+			if (counts == nullptr)
+				return;
+			const auto* cache = segment.decoder_cache();
+			for (size_t i = 0; i < segment.decoder_cache_size(); ++i) {
+				// Other machines may still be counting
+				const uint64_t count = __atomic_load_n(&counts[i], __ATOMIC_RELAXED);
+				if (count == 0)
+					continue;
+				const address_t pc = segment.exec_begin() + (i << DecoderCache::SHIFT);
+				profile.push_back({pc, count, own_instruction_count(cache, i), {}});
+			}
+		});
+
+		// Hottest blocks first, by instructions executed in them
+		std::sort(profile.begin(), profile.end(), [](const BlockProfile& a, const BlockProfile& b) {
+			return a.count * a.instructions > b.count * b.instructions;
+		});
+		for (auto& block : profile)
+			block.symbol = lookup_demangled_symbol(block.pc, true);
+		return profile;
+	}
+
+	void Machine::reset_block_profile()
+	{
+		memory.for_each_execute_segment([](DecodedExecuteSegment& segment) {
+			segment.reset_block_counts();
+		});
+	}
+
 } // loongarch
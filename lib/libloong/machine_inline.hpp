@@ -6,6 +6,21 @@ namespace loongarch
 
 	inline bool Machine::simulate(uint64_t max_instructions, uint64_t counter)
 	{
+		if (LA_UNLIKELY(m_sample_profiler != nullptr))
+			return simulate_sampled(max_instructions, counter);
+		return simulate_dispatch(max_instructions, counter);
+	}
+
+	inline bool Machine::simulate_dispatch(uint64_t max_instructions, uint64_t counter)
+	{
+		if (LA_UNLIKELY(m_dispatch_tracer != nullptr))
+			return cpu.simulate_tracing(cpu.pc(), counter, max_instructions);
+		if (LA_UNLIKELY(m_block_profiling))
+			return cpu.simulate_block_profiling(cpu.pc(), counter, max_instructions);
+#ifdef LA_BINARY_TRANSLATION
+		if (LA_UNLIKELY(m_translate_hot_mask != 0))
+			return cpu.simulate_tiering(cpu.pc(), counter, max_instructions);
+#endif
 		return cpu.simulate(cpu.pc(), counter, max_instructions);
 	}
 
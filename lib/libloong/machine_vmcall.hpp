@@ -174,6 +174,44 @@ namespace loongarch
 		}
 	}
 
+	template <typename... Args>
+	inline void Machine::timed_vmcall(address_t func_addr, std::chrono::nanoseconds timeout, Args&&... args)
+	{
+		// Use the exit address set via memory.set_exit_address()
+		const address_t exit_addr = memory.exit_address();
+
+		// Setup the call with arguments
+		setup_call(*this, exit_addr, std::forward<Args>(args)...);
+
+		// Set PC to the function address
+		cpu.registers().pc = func_addr;
+
+		// Execute until the function returns and calls exit
+		if (!this->simulate_for(timeout)) {
+			throw MachineException(MACHINE_TIMEOUT,
+				"timed_vmcall: Time limit reached", func_addr);
+		}
+	}
+
+	template <typename... Args>
+	inline GuestFault Machine::try_vmcall(address_t func_addr, uint64_t max_instructions, Args&&... args)
+	{
+		// Use the exit address set via memory.set_exit_address()
+		const address_t exit_addr = memory.exit_address();
+
+		// Setup the call with arguments
+		setup_call(*this, exit_addr, std::forward<Args>(args)...);
+
+		// Set PC to the function address
+		cpu.registers().pc = func_addr;
+
+		// Execute until the function returns, or until it faults
+		GuestFault fault = this->try_simulate(max_instructions, 0);
+		if (fault && fault.type == MACHINE_TIMEOUT)
+			fault.data = func_addr; // Like timed_vmcall()
+		return fault;
+	}
+
 	// preempt: Call a guest function with instruction limit and optional register save
 	template <bool Throw, bool StoreRegs, typename... Args>
 	inline address_t Machine::preempt(uint64_t max_instr, address_t func_addr, Args&&... args)
@@ -34,16 +34,28 @@ Memory::Memory(Machine& machine, const Machine& other, const MachineOptions& opt
 
 Memory::~Memory()
 {
-	machine().cpu.set_execute_segment(*CPU::empty_execute_segment());
 #ifdef LA_BINARY_TRANSLATION
 	// If the main execute segment is currently background compiling,
 	// wait for it to finish in asynchronously
-	if (m_main_exec_segment && m_main_exec_segment->is_background_compiling()) {
+	std::shared_ptr<DecodedExecuteSegment> compiling_segment;
+	if (m_main_exec_segment) {
+		// Overlays are never compiled, but their base segment may be
+		auto& segment = m_main_exec_segment->is_overlay()
+			? m_main_exec_segment->overlay_base() : m_main_exec_segment;
+		if (segment->is_background_compiling())
+			compiling_segment = segment;
+	}
+#endif
+	// Hand our execute segments back to the shared cache (if used)
+	// while the arena size is still known, as it's part of the key
+	evict_execute_segments();
+#ifdef LA_BINARY_TRANSLATION
+	if (compiling_segment) {
 		// Delay freeing the arena until after compilation is done
 		// as the binary translator may be reading from it.
 		auto* arena_ptr = m_arena;
 		const auto arena_size = m_arena_size;
-		std::thread([seg = m_main_exec_segment, arena_ptr, arena_size]() {
+		std::thread([seg = std::move(compiling_segment), arena_ptr, arena_size]() {
 			seg->wait_for_compilation_complete();
 			free_arena_internal(arena_ptr, arena_size);
 		}).detach();
@@ -302,7 +314,6 @@ DecodedExecuteSegment& Memory::create_execute_segment(
 	const MachineOptions& options, const void* data, address_t addr, size_t len,
 	bool is_initial, bool is_likely_jit)
 {
-	(void)is_likely_jit;
 	if (len % 4 != 0) {
 		throw MachineException(INVALID_PROGRAM, "Execute segment length is not 4-byte aligned");
 	}
@@ -310,33 +321,23 @@ DecodedExecuteSegment& Memory::create_execute_segment(
 	std::shared_ptr<DecodedExecuteSegment> segment;
 
 	// Check if we should use shared execute segments
-	if (options.use_shared_execute_segments) {
+	// Guest-generated code is private to this machine, and short-lived
+	if (options.use_shared_execute_segments && !is_likely_jit) {
 		// Compute CRC32-C hash of the segment data
 		uint32_t crc32c = util::crc32c(static_cast<const uint8_t*>(data), len);
 
 		// Create segment key
 		SegmentKey key = SegmentKey::from(addr, crc32c, m_arena_size);
 
-		// Try to get existing shared segment
-		auto& shared_cache = get_shared_execute_segments();
-		auto& entry = shared_cache.get_segment(key);
-
-		// Lock the segment entry and check if it exists
-		std::shared_ptr<DecodedExecuteSegment> existing = entry.get();
-
-		if (existing) {
-			// Reuse existing shared segment
-			segment = existing;
-		} else {
-			// No existing segment, use the one we just created
-			std::lock_guard<std::mutex> lock(entry.mutex);
-			// Double-check in case another thread created it
-			if (!entry.segment) {
-				entry.segment = std::make_shared<DecodedExecuteSegment>(addr, addr + len);
-				populate_decoder_cache(m_machine, options, entry.segment, addr, static_cast<const uint8_t*>(data), len, is_initial);
-			}
-			segment = entry.segment;
-		}
+		m_uses_shared_segments = true;
+		// Get the existing shared segment, or decode a new one
+		segment = get_shared_execute_segments().get_or_create(key, [&] {
+			auto seg = std::make_shared<DecodedExecuteSegment>(addr, addr + len);
+			// Shared segments are never patched, see private_execute_segment_for()
+			seg->set_shared(true);
+			populate_decoder_cache(m_machine, options, seg, addr, static_cast<const uint8_t*>(data), len, is_initial);
+			return seg;
+		});
 	} else {
 		// Not using shared segments, create a new one
 		segment = std::make_shared<DecodedExecuteSegment>(addr, addr + len);
@@ -346,44 +347,236 @@ DecodedExecuteSegment& Memory::create_execute_segment(
 	if (is_initial) {
 		m_main_exec_segment = segment;
 	} else {
-		m_exec.push_back(segment);
+		// Keep the list sorted by start address for binary search
+		auto it = std::upper_bound(m_exec.begin(), m_exec.end(), addr,
+			[](address_t addr, const auto& seg) { return addr < seg->exec_begin(); });
+		m_exec.insert(it, segment);
 	}
 
 	return *segment;
 }
 
-std::shared_ptr<DecodedExecuteSegment> Memory::exec_segment_for(address_t pc) const
+std::vector<std::shared_ptr<DecodedExecuteSegment>>::const_iterator
+Memory::exec_segment_iterator_for(address_t pc) const noexcept
+{
+	// Find the last segment that begins at or before pc
+	auto it = std::upper_bound(m_exec.begin(), m_exec.end(), pc,
+		[](address_t pc, const auto& seg) { return pc < seg->exec_begin(); });
+	if (it != m_exec.begin() && (*std::prev(it))->is_within(pc)) {
+		return std::prev(it);
+	}
+	return m_exec.end();
+}
+
+DecodedExecuteSegment* Memory::find_execute_segment_slowpath(address_t pc) const noexcept
+{
+	auto it = exec_segment_iterator_for(pc);
+	if (it != m_exec.end()) {
+		return it->get();
+	}
+	return nullptr;
+}
+
+DecodedExecuteSegment* Memory::private_execute_segment_for(address_t pc)
+{
+	std::shared_ptr<DecodedExecuteSegment>* slot = nullptr;
+	if (m_main_exec_segment && m_main_exec_segment->is_within(pc)) {
+		slot = &m_main_exec_segment;
+	} else {
+		auto it = exec_segment_iterator_for(pc);
+		if (it == m_exec.end())
+			return nullptr;
+		slot = &m_exec[it - m_exec.cbegin()];
+	}
+	auto& segment = *slot;
+	if (!segment->is_shared() || segment->is_overlay())
+		return segment.get();
+
+	// Other machines may be executing the shared segment, so instead
+	// we replace it with an overlay that privately copies the pages it patches.
+	auto overlay = DecodedExecuteSegment::create_overlay(segment);
+	auto& cpu = machine().cpu;
+	if (&cpu.current_execute_segment() == segment.get()) {
+		cpu.set_execute_segment(*overlay);
+	}
+	cpu.reset_execute_segment_cache();
+	segment = std::move(overlay);
+	return segment.get();
+}
+
+const std::shared_ptr<DecodedExecuteSegment>& Memory::exec_segment_for(address_t pc) const
 {
 	if (m_main_exec_segment && m_main_exec_segment->is_within(pc)) {
 		return m_main_exec_segment;
 	}
-	for (auto& seg : m_exec) {
-		if (seg->is_within(pc)) return seg;
+	auto it = exec_segment_iterator_for(pc);
+	if (it != m_exec.end()) {
+		return *it;
 	}
 	return CPU::empty_execute_segment();
 }
 
+void Memory::set_executable(address_t addr, size_t len, bool executable)
+{
+	const address_t begin = addr & ~address_t(Page::SIZE - 1);
+	const address_t end = (addr + len + Page::SIZE - 1) & ~address_t(Page::SIZE - 1);
+	if (end <= begin)
+		return;
+
+	// Remove [begin, end) from the executable ranges, splitting as needed
+	auto it = m_jit_ranges.upper_bound(begin);
+	if (it != m_jit_ranges.begin())
+		--it;
+	while (it != m_jit_ranges.end() && it->first < end) {
+		const address_t r_begin = it->first;
+		const address_t r_end = it->second;
+		if (r_end <= begin) {
+			++it;
+			continue;
+		}
+		it = m_jit_ranges.erase(it);
+		if (r_begin < begin)
+			m_jit_ranges.emplace(r_begin, begin);
+		if (r_end > end)
+			it = m_jit_ranges.emplace(end, r_end).first;
+	}
+
+	if (executable) {
+		// Insert and merge with adjacent ranges
+		address_t new_begin = begin;
+		address_t new_end = end;
+		auto next = m_jit_ranges.find(end);
+		if (next != m_jit_ranges.end()) {
+			new_end = next->second;
+			m_jit_ranges.erase(next);
+		}
+		auto prev = m_jit_ranges.lower_bound(begin);
+		if (prev != m_jit_ranges.begin() && std::prev(prev)->second == begin) {
+			--prev;
+			new_begin = prev->first;
+			m_jit_ranges.erase(prev);
+		}
+		m_jit_ranges.emplace(new_begin, new_end);
+	}
+
+	// Whatever was decoded from this range may no longer be valid
+	invalidate_execute_segments(begin, end);
+}
+
+bool Memory::is_jit_executable(address_t addr) const noexcept
+{
+	auto it = m_jit_ranges.upper_bound(addr);
+	if (it == m_jit_ranges.begin())
+		return false;
+	--it;
+	return addr < it->second;
+}
+
+void Memory::invalidate_execute_segments(address_t begin, address_t end)
+{
+	auto& cpu = machine().cpu;
+	for (auto it = m_exec.begin(); it != m_exec.end(); ) {
+		auto& seg = *it;
+		if (seg->exec_begin() < end && seg->exec_end() > begin) {
+			// A dispatch loop may still be inside this segment (eg. a
+			// system call made from JIT code), so it must stay alive until
+			// the dispatch notices that it's stale.
+			seg->set_stale(true);
+			if (&cpu.current_execute_segment() == seg.get()) {
+				cpu.set_execute_segment(*CPU::empty_execute_segment());
+			}
+			m_jit_retired.push_back(std::move(seg));
+			it = m_exec.erase(it);
+		} else {
+			++it;
+		}
+	}
+	cpu.reset_execute_segment_cache();
+
+	// Keep only the newest retired segments for re-protection of unchanged
+	// code, except those that dispatch loops (nested ones included) are in
+	for (auto rit = m_jit_retired.begin(); rit != m_jit_retired.end() && m_jit_retired.size() > JIT_RETIRED_MAX; ) {
+		if (cpu.is_execute_pinned(**rit))
+			++rit;
+		else
+			rit = m_jit_retired.erase(rit);
+	}
+}
+
+DecodedExecuteSegment* Memory::create_jit_segment_for(address_t pc)
+{
+	auto it = m_jit_ranges.upper_bound(pc);
+	if (it == m_jit_ranges.begin())
+		return nullptr;
+	--it;
+	if (pc >= it->second)
+		return nullptr;
+
+	// Decode a bounded window around pc, and don't overlap
+	// with segments that have already been decoded
+	address_t begin = std::max(it->first, pc & ~(JIT_SEGMENT_MAX - 1));
+	address_t end = std::min(it->second, (pc & ~(JIT_SEGMENT_MAX - 1)) + JIT_SEGMENT_MAX);
+	if (m_main_exec_segment && m_main_exec_segment->exec_end() <= pc)
+		begin = std::max(begin, m_main_exec_segment->exec_end());
+	if (m_main_exec_segment && m_main_exec_segment->exec_begin() > pc)
+		end = std::min(end, m_main_exec_segment->exec_begin());
+	auto next = std::upper_bound(m_exec.begin(), m_exec.end(), pc,
+		[](address_t pc, const auto& seg) { return pc < seg->exec_begin(); });
+	if (next != m_exec.end())
+		end = std::min(end, (*next)->exec_begin());
+	if (next != m_exec.begin())
+		begin = std::max(begin, (*std::prev(next))->exec_end());
+	if (pc < begin || pc >= end || end > m_arena_size)
+		return nullptr;
+
+	const uint8_t* data = m_arena + begin;
+	const size_t len = end - begin;
+
+	// Re-protecting unchanged code is common, and only costs a checksum
+	const uint32_t crc = util::crc32c(data, len);
+	for (auto rit = m_jit_retired.begin(); rit != m_jit_retired.end(); ++rit) {
+		auto& seg = *rit;
+		if (seg->exec_begin() == begin && seg->exec_end() == end && seg->crc32c_hash() == crc) {
+			seg->set_stale(false);
+			auto pos = std::upper_bound(m_exec.begin(), m_exec.end(), begin,
+				[](address_t addr, const auto& seg) { return addr < seg->exec_begin(); });
+			auto* result = m_exec.insert(pos, std::move(seg))->get();
+			m_jit_retired.erase(rit);
+			return result;
+		}
+	}
+
+	static const MachineOptions default_options;
+	const auto& options = machine().has_options() ? machine().options() : default_options;
+	return &create_execute_segment(options, data, begin, len, false, true);
+}
+
 void Memory::evict_execute_segments()
 {
 	machine().cpu.set_execute_segment(*CPU::empty_execute_segment());
+	machine().cpu.reset_execute_segment_cache();
+	m_jit_retired.clear();
 
-	// If using shared segments, notify the cache before releasing our references
-	if (machine().has_options() && machine().options().use_shared_execute_segments) {
-		auto& shared_cache = get_shared_execute_segments();
-
-		// Remove main segment if unique
+	if (m_uses_shared_segments) {
+		// Release our references first, so that the shared cache can
+		// tell which segments are no longer used by anyone
+		std::vector<SegmentKey> keys;
 		if (m_main_exec_segment) {
-			SegmentKey key = SegmentKey::from(*m_main_exec_segment, m_arena_size);
-			shared_cache.remove_if_unique(key);
+			keys.push_back(SegmentKey::from(*m_main_exec_segment, m_arena_size));
 		}
-
-		// Remove other segments if unique
 		for (auto& seg : m_exec) {
 			if (seg) {
-				SegmentKey key = SegmentKey::from(*seg, m_arena_size);
-				shared_cache.remove_if_unique(key);
+				keys.push_back(SegmentKey::from(*seg, m_arena_size));
 			}
 		}
+		m_exec.clear();
+		m_main_exec_segment.reset();
+
+		auto& shared_cache = get_shared_execute_segments();
+		for (const auto& key : keys) {
+			shared_cache.remove_if_unique(key);
+		}
+		return;
 	}
 
 	m_exec.clear();
@@ -399,6 +592,7 @@ void Memory::reset()
 		std::memset(m_arena, 0, m_arena_size);
 #endif
 	}
+	m_jit_ranges.clear();
 	evict_execute_segments();
 }
 
@@ -3,6 +3,8 @@
 #include "page.hpp"
 #include "decoded_exec_segment.hpp"
 #include "elf.hpp"
+#include <deque>
+#include <map>
 #include <vector>
 #include <memory>
 #include <string_view>
@@ -28,6 +30,14 @@ namespace loongarch
 		template <typename T, bool EnableSegReg = false>
 		void write(address_t addr, T value);
 
+		// Stack accesses (sp + imm12) are validated once for a whole run of
+		// them, after which they need no further checks (see LA64_BC_LD_D_SP)
+		bool is_stack_accessible(address_t sp) const noexcept;
+		template <typename T>
+		T read_stack(address_t sp, int32_t offset) const noexcept;
+		template <typename T>
+		void write_stack(address_t sp, int32_t offset, T value) noexcept;
+
 		// Memory arena operations
 		void copy_to_guest(address_t dest, const void* src, size_t len);
 		void copy_from_guest(void* dest, address_t src, size_t len) const;
@@ -51,10 +61,34 @@ namespace loongarch
 			const void* data, address_t addr, size_t len,
 			bool is_initial, bool is_likely_jit = false);
 
-		std::shared_ptr<DecodedExecuteSegment> exec_segment_for(address_t pc) const;
+		const std::shared_ptr<DecodedExecuteSegment>& exec_segment_for(address_t pc) const;
+		// Raw-pointer lookup used on the dispatch hot path, nullptr when not executable
+		DecodedExecuteSegment* find_execute_segment(address_t pc) const noexcept {
+			if (LA_LIKELY(m_main_exec_segment != nullptr && m_main_exec_segment->is_within(pc)))
+				return m_main_exec_segment.get();
+			return find_execute_segment_slowpath(pc);
+		}
+		// Segment that may be patched by this machine only, nullptr when not executable
+		// Shared segments are replaced with a copy-on-write overlay on first use.
+		DecodedExecuteSegment* private_execute_segment_for(address_t pc);
 		size_t execute_segments_count() const noexcept { return m_exec.size() + (m_main_exec_segment ? 1 : 0); }
+		template <typename Callback>
+		void for_each_execute_segment(Callback&& callback) const {
+			if (m_main_exec_segment)
+				callback(*m_main_exec_segment);
+			for (const auto& segment : m_exec)
+				callback(*segment);
+		}
 		void evict_execute_segments();
 
+		// Guest-generated code (JIT)
+		// Page ranges made executable by mmap/mprotect are decoded lazily on
+		// first execution. Changing the protection of a range (eg. making it
+		// writable again) invalidates the execute segments decoded from it.
+		void set_executable(address_t addr, size_t len, bool executable);
+		bool is_jit_executable(address_t addr) const noexcept;
+		DecodedExecuteSegment* create_jit_segment_for(address_t pc);
+
 		// Binary info
 		const auto& binary() const noexcept { return m_binary; }
 		address_t start_address() const noexcept { return m_start_address; }
@@ -111,9 +145,20 @@ namespace loongarch
 		Machine& m_machine;
 		std::string_view m_binary; // Non-owning reference to binary data
 
-		// Execute segments
+		// Execute segments (m_exec is kept sorted by exec_begin)
 		std::shared_ptr<DecodedExecuteSegment> m_main_exec_segment;
 		std::vector<std::shared_ptr<DecodedExecuteSegment>> m_exec;
+		bool m_uses_shared_segments = false;
+		// Executable page ranges for guest-generated code (begin -> end)
+		std::map<address_t, address_t> m_jit_ranges;
+		// Recently invalidated JIT segments, kept alive in case the current
+		// dispatch is still inside one, and for cheap re-activation
+		std::deque<std::shared_ptr<DecodedExecuteSegment>> m_jit_retired;
+		static constexpr size_t JIT_RETIRED_MAX = 4;
+		static constexpr address_t JIT_SEGMENT_MAX = 2ull << 20; // 2 MiB decode window
+		void invalidate_execute_segments(address_t begin, address_t end);
+		std::vector<std::shared_ptr<DecodedExecuteSegment>>::const_iterator exec_segment_iterator_for(address_t pc) const noexcept;
+		DecodedExecuteSegment* find_execute_segment_slowpath(address_t pc) const noexcept;
 
 		// Memory layout
 		address_t m_start_address = 0;
@@ -41,6 +41,35 @@ inline void Memory::write(address_t addr, T value)
 	*reinterpret_cast<T*>(&m_arena[addr]) = value;
 }
 
+inline bool Memory::is_stack_accessible(address_t sp) const noexcept
+{
+	if constexpr (LA_MASKED_MEMORY_MASK) {
+		return true; // Stack accesses are masked instead
+	}
+	// The writable area is contiguous, so this covers every 12-bit offset
+	return is_writable(sp - 2048) && is_writable(sp + 2047);
+}
+
+template <typename T>
+inline T Memory::read_stack(address_t sp, int32_t offset) const noexcept
+{
+	address_t addr = sp + offset;
+	if constexpr (LA_MASKED_MEMORY_MASK) {
+		addr &= LA_MASKED_MEMORY_MASK;
+	}
+	return *reinterpret_cast<const T*>(&m_arena[addr]);
+}
+
+template <typename T>
+inline void Memory::write_stack(address_t sp, int32_t offset, T value) noexcept
+{
+	address_t addr = sp + offset;
+	if constexpr (LA_MASKED_MEMORY_MASK) {
+		addr &= LA_MASKED_MEMORY_MASK;
+	}
+	*reinterpret_cast<T*>(&m_arena[addr]) = value;
+}
+
 template <typename T>
 inline const T* Memory::memarray(address_t addr, size_t count) const
 {
@@ -63,7 +63,7 @@ namespace loongarch
 
 	void Memory::protection_fault(address_t addr, const char* message)
 	{
-		throw MachineException(PROTECTION_FAULT, message, addr);
+		CPU::trigger_exception(PROTECTION_FAULT, addr, message);
 	}
 
 	void Memory::copy_into_arena_unsafe(address_t dest, const void* src, size_t len)
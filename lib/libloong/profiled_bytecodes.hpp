@@ -0,0 +1,36 @@
+// Profile-guided bytecodes
+// Generated by emulator/generate_bytecodes.sh - do not edit by hand
+//
+// LA64_PROFILED_BYTECODE(InstrId, name) becomes the bytecode LA64_BC_<InstrId>,
+// which calls InstrImpl::<InstrId> directly instead of going through the
+// LA64_BC_FUNCTION handler table. Ordered by dynamic execution count.
+// This file is included several times, with different definitions of the macro.
+//
+// Profiles:
+//   physics.prof
+//   strings.prof
+//   stream.prof
+//   vecbench_run.prof
+//   coremark.prof
+LA64_PROFILED_BYTECODE(FLDX_S,          "FLDX.S") // 27600001
+LA64_PROFILED_BYTECODE(MOVGR2FR_W,      "MOVGR2FR.W") // 16560001
+LA64_PROFILED_BYTECODE(ADDU16I_D,       "ADDU16I.D") // 16560000
+LA64_PROFILED_BYTECODE(MOVFR2GR_S,      "MOVFR2GR.S") // 16560000
+LA64_PROFILED_BYTECODE(FSTX_S,          "FSTX.S") // 11040000
+LA64_PROFILED_BYTECODE(FSUB_D,          "FSUB.D") // 10587612
+LA64_PROFILED_BYTECODE(LD_W,            "LD.W") // 6553603
+LA64_PROFILED_BYTECODE(VINSGR2VR_D,     "VINSGR2VR.D") // 6553600
+LA64_PROFILED_BYTECODE(FABS_D,          "FABS.D") // 5560004
+LA64_PROFILED_BYTECODE(MOVCF2GR,        "MOVCF2GR") // 3840009
+LA64_PROFILED_BYTECODE(VINSGR2VR_W,     "VINSGR2VR.W") // 3276800
+LA64_PROFILED_BYTECODE(FSEL,            "FSEL") // 2760000
+LA64_PROFILED_BYTECODE(MULH_DU,         "MULH.DU") // 2435447
+LA64_PROFILED_BYTECODE(MOVGR2FR_D,      "MOVGR2FR.D") // 1553929
+LA64_PROFILED_BYTECODE(MOVFR2GR_D,      "MOVFR2GR.D") // 1480032
+LA64_PROFILED_BYTECODE(FFINT_D_L,       "FFINT.D.L") // 1333096
+LA64_PROFILED_BYTECODE(FTINTRZ_L_D,     "FTINTRZ.L.D") // 1280004
+LA64_PROFILED_BYTECODE(VADDI_DU,        "VADDI.DU") // 819200
+LA64_PROFILED_BYTECODE(VMADD_W,         "VMADD.W") // 819200
+LA64_PROFILED_BYTECODE(VSLLI_D,         "VSLLI.D") // 819200
+LA64_PROFILED_BYTECODE(FDIV_D,          "FDIV.D") // 800087
+LA64_PROFILED_BYTECODE(LDX_WU,          "LDX.WU") // 388479
@@ -0,0 +1,91 @@
+#include "sample_profiler.hpp"
+#include "machine.hpp"
+#include <cstdio>
+#include <unordered_map>
+
+namespace loongarch
+{
+	SampleProfiler::SampleProfiler(uint64_t interval)
+		: m_interval(interval > 0 ? interval : 1), m_remaining(m_interval) {}
+
+	void SampleProfiler::clear()
+	{
+		m_stacks.clear();
+		m_samples = 0;
+		m_remaining = m_interval;
+	}
+
+	void SampleProfiler::record(const Machine& machine)
+	{
+		// Only return addresses of calls into the frame before them are kept,
+		// see Machine::backtrace_addresses()
+		auto stack = machine.backtrace_addresses(0, true, 32);
+		m_stacks[std::move(stack)]++;
+		m_samples++;
+	}
+
+	// Reuses the instruction limit of the dispatch as the sampling timer: each
+	// slice ends at the next sample point, where the stack is recorded.
+	bool Machine::simulate_sampled(uint64_t max_instructions, uint64_t counter)
+	{
+		auto& profiler = *m_sample_profiler;
+		while (true) {
+			const uint64_t slice_end = (counter < max_instructions && max_instructions - counter > profiler.m_remaining)
+				? counter + profiler.m_remaining : max_instructions;
+			const bool stopped = simulate_dispatch(slice_end, counter);
+
+			const uint64_t executed = m_counter - counter;
+			counter = m_counter;
+			if (executed < profiler.m_remaining) {
+				profiler.m_remaining -= executed;
+				return stopped;
+			}
+			profiler.m_remaining = profiler.m_interval;
+			if (stopped)
+				return true;
+			profiler.record(*this);
+			if (counter >= max_instructions)
+				return false;
+		}
+	}
+
+	std::string SampleProfiler::folded_stacks(const Machine& machine) const
+	{
+		std::unordered_map<address_t, std::string> names;
+		auto name_of = [&](address_t addr) -> const std::string& {
+			auto it = names.find(addr);
+			if (it == names.end()) {
+				std::string name = machine.lookup_demangled_symbol(addr, false);
+				if (name.empty()) {
+					char buffer[32];
+					snprintf(buffer, sizeof(buffer), "0x%lx", (unsigned long)addr);
+					name = buffer;
+				}
+				it = names.emplace(addr, std::move(name)).first;
+			}
+			return it->second;
+		};
+
+		// Different return sites in the same functions fold into one stack
+		std::map<std::string, uint64_t> folded;
+		for (const auto& [stack, count] : m_stacks) {
+			std::string line;
+			for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+				if (!line.empty())
+					line += ';';
+				line += name_of(*it);
+			}
+			folded[line] += count;
+		}
+
+		std::string result;
+		for (const auto& [line, count] : folded) {
+			result += line;
+			result += ' ';
+			result += std::to_string(count);
+			result += '\n';
+		}
+		return result;
+	}
+
+} // loongarch
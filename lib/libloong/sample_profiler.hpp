@@ -0,0 +1,43 @@
+#pragma once
+#include "common.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace loongarch
+{
+	struct Machine;
+
+	// Sampling profiler
+	// Attached with Machine::set_sample_profiler(), after which simulate() runs
+	// in slices of interval() instructions and records a guest stack between
+	// slices. The dispatch loops are unaffected, and with binary translation
+	// enabled the instruction limit must not be ignored.
+	struct SampleProfiler
+	{
+		// Roughly 1 kHz when interpreting
+		static constexpr uint64_t DEFAULT_INTERVAL = 500'000;
+
+		explicit SampleProfiler(uint64_t interval = DEFAULT_INTERVAL);
+
+		uint64_t interval() const noexcept { return m_interval; }
+		uint64_t samples() const noexcept { return m_samples; }
+		void clear();
+
+		// Record the current stack of the machine, innermost frame first
+		void record(const Machine& machine);
+
+		// Samples aggregated as flamegraph folded stacks, one line per stack:
+		//   main;compute;inner 42
+		// Frames are function names, or addresses when there is no symbol.
+		std::string folded_stacks(const Machine& machine) const;
+
+	private:
+		friend struct Machine;
+		uint64_t m_interval;
+		uint64_t m_remaining; // Instructions until the next sample
+		uint64_t m_samples = 0;
+		std::map<std::vector<address_t>, uint64_t> m_stacks;
+	};
+
+} // loongarch
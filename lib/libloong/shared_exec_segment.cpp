@@ -22,27 +22,184 @@ namespace loongarch
 
 	// SharedExecuteSegments implementation
 
+	SharedExecuteSegments::SharedExecuteSegments()
+	{
+	}
+
+	std::shared_ptr<SharedExecuteSegments::Segment> SharedExecuteSegments::get_segment(key_t key) const
+	{
+		const auto index = shard_for(key).index.load(std::memory_order_acquire);
+		auto it = index->find(key);
+		if (it != index->end())
+			return it->second;
+		return nullptr;
+	}
+
+	std::shared_ptr<DecodedExecuteSegment> SharedExecuteSegments::find_published(key_t key)
+	{
+		// The snapshot keeps its entries alive while we look at them
+		const auto index = shard_for(key).index.load(std::memory_order_acquire);
+		auto it = index->find(key);
+		if (it == index->end())
+			return nullptr;
+		auto result = it->second->get();
+		if (result)
+			record_lookup(*it->second, false);
+		return result;
+	}
+
+	std::shared_ptr<SharedExecuteSegments::Segment> SharedExecuteSegments::acquire_entry(key_t key)
+	{
+		Shard& shard = shard_for(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		// Someone else may have inserted it since the lock-free lookup
+		const auto index = shard.index.load(std::memory_order_relaxed);
+		auto it = index->find(key);
+		if (it != index->end())
+			return it->second;
+
+		// Copy-on-write: readers keep using the previous snapshot
+		auto next = std::make_shared<index_t>(*index);
+		auto entry = std::make_shared<Segment>();
+		next->emplace(key, entry);
+		shard.index.store(std::move(next), std::memory_order_release);
+		return entry;
+	}
+
+	void SharedExecuteSegments::record_lookup(Segment& entry, bool created)
+	{
+		if (created)
+			m_misses.fetch_add(1, std::memory_order_relaxed);
+		else
+			m_hits.fetch_add(1, std::memory_order_relaxed);
+
+		// The caller holds a reference, so the segment cannot be
+		// added to the LRU list after this point, only before.
+		if (entry.in_lru.load(std::memory_order_acquire)) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			unlocked_touch(entry);
+		}
+	}
+
 	void SharedExecuteSegments::remove_if_unique(key_t key)
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
-		// We are not able to remove the Segment itself, as the mutex
-		// may be locked by another thread. We can, however, lock the
-		// Segment's mutex and set the segment to nullptr if it's the last reference.
-		auto it = m_segments.find(key);
-		if (it != m_segments.end()) {
-			std::lock_guard<std::mutex> seg_lock(it->second.mutex);
-			if (it->second.segment && it->second.segment.use_count() == 1) {
-				it->second.segment = nullptr;
+		// We don't remove the Segment itself, as other threads may be
+		// using it. We can, however, lock the Segment's mutex and move it
+		// to the LRU list if it's the last reference. It stays alive
+		// until it's evicted by the byte budget.
+		{
+			const auto entry_ref = get_segment(key);
+			if (!entry_ref)
+				return;
+			auto& entry = *entry_ref;
+			std::lock_guard<std::mutex> seg_lock(entry.mutex);
+			const auto segment = entry.get();
+			if (!segment || entry.unlocked_use_count() != 1 || entry.in_lru)
+				return;
+			m_lru.push_front(key);
+			entry.lru_it = m_lru.begin();
+			entry.lru_bytes = segment->memory_usage();
+			entry.in_lru.store(true, std::memory_order_release);
+			m_unreferenced_bytes += entry.lru_bytes;
+		}
+		unlocked_evict_over_budget();
+	}
+
+	void SharedExecuteSegments::unlocked_touch(Segment& entry)
+	{
+		if (entry.in_lru) {
+			m_lru.erase(entry.lru_it);
+			m_unreferenced_bytes -= entry.lru_bytes;
+			entry.in_lru.store(false, std::memory_order_release);
+		}
+	}
+
+	void SharedExecuteSegments::unlocked_evict_over_budget()
+	{
+		while (m_unreferenced_bytes > m_byte_budget && !m_lru.empty()) {
+			const key_t key = m_lru.back();
+			Shard& shard = shard_for(key);
+			std::lock_guard<std::mutex> shard_lock(shard.mutex);
+			const auto index = shard.index.load(std::memory_order_relaxed);
+			// Keeps the entry alive when its key is erased below
+			const std::shared_ptr<Segment> entry_ref = index->at(key);
+			auto& entry = *entry_ref;
+
+			std::lock_guard<std::mutex> seg_lock(entry.mutex);
+			unlocked_touch(entry);
+			// The segment may have been picked up again without
+			// going through get_or_create(), so check once more.
+			if (entry.unlocked_use_count() == 0) {
+				entry.unlocked_set(nullptr);
+				m_evictions++;
+				// Evicted keys leave the index, unless a lookup in
+				// progress holds the entry and is about to refill it.
+				// Older snapshots still being read count as holders too.
+				if (entry_ref.use_count() == 2) {
+					auto next = std::make_shared<index_t>(*index);
+					next->erase(key);
+					shard.index.store(std::move(next), std::memory_order_release);
+				}
 			}
 		}
 	}
 
-	SharedExecuteSegments::Segment& SharedExecuteSegments::get_segment(key_t key)
+	void SharedExecuteSegments::set_byte_budget(size_t bytes)
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
-		auto& entry = m_segments[key];
-		return entry;
+		m_byte_budget = bytes;
+		unlocked_evict_over_budget();
+	}
+
+	void SharedExecuteSegments::clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		// Entries stay alive for as long as a lookup holds them
+		for (Shard& shard : m_shards) {
+			std::lock_guard<std::mutex> shard_lock(shard.mutex);
+			shard.index.store(std::make_shared<const index_t>(), std::memory_order_release);
+		}
+		m_lru.clear();
+		m_unreferenced_bytes = 0;
+	}
+
+	SharedExecuteSegments::Stats SharedExecuteSegments::stats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Stats stats;
+		stats.hits = m_hits.load(std::memory_order_relaxed);
+		stats.misses = m_misses.load(std::memory_order_relaxed);
+		stats.evictions = m_evictions;
+		stats.unreferenced_segments = m_lru.size();
+		stats.unreferenced_bytes = m_unreferenced_bytes;
+		return stats;
+	}
+
+	std::vector<SharedExecuteSegments::SegmentUsage> SharedExecuteSegments::segment_usage() const
+	{
+		std::vector<SegmentUsage> result;
+		for (const Shard& shard : m_shards) {
+			const auto index = shard.index.load(std::memory_order_acquire);
+			for (auto& [key, entry] : *index) {
+				std::lock_guard<std::mutex> seg_lock(entry->mutex);
+				if (const auto segment = entry->get()) {
+					// Not counting the copy held here, nor the entry itself
+					result.push_back({key, segment->memory_usage(),
+						segment.use_count() - 2});
+				}
+			}
+		}
+		return result;
+	}
+
+	size_t SharedExecuteSegments::size() const
+	{
+		size_t total = 0;
+		for (const Shard& shard : m_shards)
+			total += shard.index.load(std::memory_order_acquire)->size();
+		return total;
 	}
 
 	// Global singleton
@@ -1,9 +1,13 @@
 #pragma once
 #include "common.hpp"
 #include "decoded_exec_segment.hpp"
+#include <atomic>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <array>
 #include <unordered_map>
+#include <vector>
 
 namespace loongarch
 {
@@ -21,11 +25,23 @@ namespace loongarch
 		static SegmentKey from(const DecodedExecuteSegment& segment, uint64_t arena_size);
 
 		bool operator==(const SegmentKey& other) const {
-			return pc == other.pc && crc == other.crc;
+			return pc == other.pc && crc == other.crc && arena_size == other.arena_size;
 		}
 
 		bool operator<(const SegmentKey& other) const {
-			return pc < other.pc || (pc == other.pc && crc < other.crc);
+			if (pc != other.pc) return pc < other.pc;
+			if (crc != other.crc) return crc < other.crc;
+			return arena_size < other.arena_size;
+		}
+
+		// 64-bit mix of all fields (splitmix64 finalizer)
+		size_t hash() const noexcept {
+			uint64_t h = pc * 0x9E3779B97F4A7C15ull;
+			h ^= (uint64_t(crc) << 32) | (arena_size >> 12);
+			h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+			h ^= h >> 27; h *= 0x94D049BB133111EBull;
+			h ^= h >> 31;
+			return size_t(h);
 		}
 	};
 
@@ -36,7 +52,7 @@ namespace std {
 	template <>
 	struct hash<loongarch::SegmentKey> {
 		size_t operator()(const loongarch::SegmentKey& key) const {
-			return key.pc ^ key.crc ^ key.arena_size;
+			return key.hash();
 		}
 	};
 }
@@ -46,8 +62,16 @@ namespace loongarch
 	// Thread-safe shared execute segment storage
 	// Manages a global cache of decoded execute segments that can be shared
 	// across multiple Machine instances running the same program.
+	// Segments that are no longer referenced by any Machine are retained in
+	// LRU order for as long as they fit within the configured byte budget.
+	//
+	// The index is split into shards by key hash. Each shard publishes an
+	// immutable snapshot of its index, and each entry publishes its decoded
+	// segment, so a hit takes no lock at all. Writers copy the shard index
+	// under the shard mutex, which only happens when a key is inserted or
+	// evicted. Decoding is serialized per key, never across keys.
 	struct SharedExecuteSegments {
-		SharedExecuteSegments() = default;
+		SharedExecuteSegments();
 		SharedExecuteSegments(const SharedExecuteSegments&) = delete;
 		SharedExecuteSegments& operator=(const SharedExecuteSegments&) = delete;
 
@@ -55,21 +79,33 @@ namespace loongarch
 
 		// Wrapper around a shared execute segment with its own mutex
 		// This allows fine-grained locking: the global map is locked only
-		// during lookup/insertion, while individual segments can be accessed
+		// during insertion, while individual segments can be accessed
 		// concurrently by different threads.
 		struct Segment {
-			std::shared_ptr<DecodedExecuteSegment> segment;
-			std::mutex mutex;
+			// Published for lock-free readers, written under the mutex
+			std::atomic<std::shared_ptr<DecodedExecuteSegment>> segment;
+			mutable std::mutex mutex;
+			// Position in the LRU list while unreferenced (guarded by the cache mutex)
+			std::list<key_t>::iterator lru_it;
+			size_t lru_bytes = 0;
+			// Written under both the cache mutex and the Segment mutex
+			std::atomic<bool> in_lru = false;
 
 			// Thread-safe getter
-			std::shared_ptr<DecodedExecuteSegment> get() {
-				std::lock_guard<std::mutex> lock(mutex);
-				return segment;
+			std::shared_ptr<DecodedExecuteSegment> get() const {
+				return segment.load(std::memory_order_acquire);
 			}
 
 			// Internal setter (caller must hold mutex)
 			void unlocked_set(std::shared_ptr<DecodedExecuteSegment> seg) {
-				this->segment = std::move(seg);
+				this->segment.store(std::move(seg), std::memory_order_release);
+			}
+
+			// References held outside of the cache (caller must hold mutex)
+			long unlocked_use_count() const {
+				// The loaded copy is one reference, the entry itself another
+				const auto seg = segment.load(std::memory_order_relaxed);
+				return seg ? seg.use_count() - 2 : 0;
 			}
 		};
 
@@ -79,27 +115,102 @@ namespace loongarch
 		// by other machines, it will be kept alive.
 		void remove_if_unique(key_t key);
 
-		// Get or create a segment entry
-		// Returns a reference to the Segment wrapper in the map.
-		// The caller should lock the Segment's mutex before accessing it.
-		Segment& get_segment(key_t key);
-
-		// Statistics
-		size_t size() const {
+		// Look up a segment entry without creating it
+		// Returns nullptr when the key is not in the cache. The entry stays
+		// valid for as long as it is held, even after the key is evicted.
+		// The caller should lock the Segment's mutex before modifying it.
+		std::shared_ptr<Segment> get_segment(key_t key) const;
+
+		// Look up a segment, creating it with the given function on a miss
+		// The segment is removed from the LRU list, and the hit/miss
+		// counters are updated.
+		template <typename Func>
+		std::shared_ptr<DecodedExecuteSegment> get_or_create(key_t key, Func&& create);
+
+		// Maximum number of bytes kept alive by unreferenced segments
+		// The default (0) releases segments as soon as they become unreferenced.
+		void set_byte_budget(size_t bytes);
+		size_t byte_budget() const {
 			std::lock_guard<std::mutex> lock(m_mutex);
-			return m_segments.size();
+			return m_byte_budget;
 		}
 
-		void clear() {
-			std::lock_guard<std::mutex> lock(m_mutex);
-			m_segments.clear();
-		}
+		struct Stats {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+			size_t unreferenced_segments = 0;
+			size_t unreferenced_bytes = 0;
+		};
+		Stats stats() const;
+
+		struct SegmentUsage {
+			key_t key;
+			size_t bytes;
+			long use_count; // References held outside of the cache
+		};
+		// Bytes held per live segment
+		std::vector<SegmentUsage> segment_usage() const;
+
+		// Statistics
+		size_t size() const;
+
+		void clear();
 
 	private:
-		std::unordered_map<key_t, Segment> m_segments;
+		using index_t = std::unordered_map<key_t, std::shared_ptr<Segment>>;
+		struct Shard {
+			// Serializes writers, readers use the published snapshot
+			std::mutex mutex;
+			std::atomic<std::shared_ptr<const index_t>> index = std::make_shared<const index_t>();
+		};
+		static constexpr size_t SHARDS = 16;
+		Shard& shard_for(const key_t& key) noexcept { return m_shards[(key.hash() >> 32) % SHARDS]; }
+		const Shard& shard_for(const key_t& key) const noexcept { return m_shards[(key.hash() >> 32) % SHARDS]; }
+
+		std::shared_ptr<DecodedExecuteSegment> find_published(key_t key);
+		std::shared_ptr<Segment> acquire_entry(key_t key);
+		void record_lookup(Segment& entry, bool created);
+		void unlocked_touch(Segment& entry);
+		void unlocked_evict_over_budget();
+
+		// Lock order: m_mutex, then a shard, then a Segment mutex
+		std::array<Shard, SHARDS> m_shards;
+		std::list<key_t> m_lru; // Unreferenced segments, most recently used first
+		size_t m_unreferenced_bytes = 0;
+		size_t m_byte_budget = 0;
+		std::atomic<uint64_t> m_hits = 0;
+		std::atomic<uint64_t> m_misses = 0;
+		uint64_t m_evictions = 0;
 		mutable std::mutex m_mutex;
 	};
 
+	template <typename Func>
+	inline std::shared_ptr<DecodedExecuteSegment>
+	SharedExecuteSegments::get_or_create(key_t key, Func&& create)
+	{
+		// Fast path: no locks are taken when the segment is published
+		if (auto result = find_published(key))
+			return result;
+
+		auto entry = acquire_entry(key);
+
+		std::shared_ptr<DecodedExecuteSegment> result;
+		bool created = false;
+		{
+			std::lock_guard<std::mutex> seg_lock(entry->mutex);
+			result = entry->get();
+			if (!result) {
+				result = create();
+				entry->unlocked_set(result);
+				created = true;
+			}
+		}
+
+		record_lookup(*entry, created);
+		return result;
+	}
+
 	// Global shared segment cache
 	// This is a singleton that manages all shared execute segments
 	SharedExecuteSegments& get_shared_execute_segments();
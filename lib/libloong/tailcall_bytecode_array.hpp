@@ -85,17 +85,40 @@
 [LA64_BC_VFADD_D]   = la64_vfadd_d,
 [LA64_BC_VFMADD_D]  = la64_vfmadd_d,
 [LA64_BC_VHADDW_D_W] = la64_vhaddw_d_w,
+[LA64_BC_VORI_B]    = la64_vori_b,
+[LA64_BC_VREPLGR2VR_W] = la64_vreplgr2vr_w,
+[LA64_BC_VREPLGR2VR_D] = la64_vreplgr2vr_d,
+[LA64_BC_VPICKVE2GR_W] = la64_vpickve2gr_w,
+[LA64_BC_VPICKVE2GR_D] = la64_vpickve2gr_d,
+[LA64_BC_VSHUF_B]   = la64_vshuf_b,
 
 // LASX (256-bit) instructions
 [LA64_BC_XVLD]      = la64_xvld,
 [LA64_BC_XVST]      = la64_xvst,
 [LA64_BC_XVLDX]     = la64_xvldx,
 [LA64_BC_XVSTX]     = la64_xvstx,
+[LA64_BC_XVFMADD_D] = la64_xvfmadd_d,
+#define LA64_VECTOR_BYTECODE(id, name, ...) [LA64_BC_##id] = la64_vector_##id,
+#include "vector_bytecodes.hpp"
+#undef LA64_VECTOR_BYTECODE
 
 // Floating-point instructions
 [LA64_BC_FMADD_D]   = la64_fmadd_d,
 [LA64_BC_FLDX_D]    = la64_fldx_d,
 [LA64_BC_FSTX_D]    = la64_fstx_d,
+[LA64_BC_FLD_S]     = la64_fld_s,
+[LA64_BC_FST_S]     = la64_fst_s,
+[LA64_BC_FADD_S]    = la64_fadd_s,
+[LA64_BC_FSUB_S]    = la64_fsub_s,
+[LA64_BC_FMUL_S]    = la64_fmul_s,
+[LA64_BC_FDIV_S]    = la64_fdiv_s,
+[LA64_BC_FMADD_S]   = la64_fmadd_s,
+[LA64_BC_FMOV_S]    = la64_fmov_s,
+[LA64_BC_FMOV_D]    = la64_fmov_d,
+[LA64_BC_FCVT_S_D]  = la64_fcvt_s_d,
+[LA64_BC_FCVT_D_S]  = la64_fcvt_d_s,
+[LA64_BC_FCMP_COND_S] = la64_fcmp_cond_s,
+[LA64_BC_FCMP_COND_D] = la64_fcmp_cond_d,
 
 [LA64_BC_BEQZ]      = la64_beqz,
 [LA64_BC_BNEZ]      = la64_bnez,
@@ -110,6 +133,28 @@
 [LA64_BC_BGE]       = la64_bge,
 [LA64_BC_BLTU]      = la64_bltu,
 [LA64_BC_BGEU]      = la64_bgeu,
+[LA64_BC_B_CHAINED] = la64_b_chained,
+[LA64_BC_BL_CHAINED] = la64_bl_chained,
+[LA64_BC_RET]       = la64_ret,
+
+[LA64_BC_SLT_BEQZ]  = la64_slt_beqz,
+[LA64_BC_SLT_BNEZ]  = la64_slt_bnez,
+[LA64_BC_SLTU_BEQZ] = la64_sltu_beqz,
+[LA64_BC_SLTU_BNEZ] = la64_sltu_bnez,
+[LA64_BC_ADDI_D_LD_D] = la64_addi_d_ld_d,
+[LA64_BC_ALSL_D_LDX_D] = la64_alsl_d_ldx_d,
+[LA64_BC_LD_D_LD_D] = la64_ld_d_ld_d,
+[LA64_BC_FCMP_S_BCEQZ] = la64_fcmp_s_bceqz,
+[LA64_BC_FCMP_S_BCNEZ] = la64_fcmp_s_bcnez,
+[LA64_BC_FCMP_D_BCEQZ] = la64_fcmp_d_bceqz,
+[LA64_BC_FCMP_D_BCNEZ] = la64_fcmp_d_bcnez,
+[LA64_BC_LD_D_SP]   = la64_ld_d_sp,
+[LA64_BC_ST_D_SP]   = la64_st_d_sp,
+[LA64_BC_CONST]     = la64_const,
+[LA64_BC_CONST_LD_D] = la64_const_ld_d,
+#define LA64_PROFILED_BYTECODE(id, name) [LA64_BC_##id] = la64_profiled_##id,
+#include "profiled_bytecodes.hpp"
+#undef LA64_PROFILED_BYTECODE
 
 [LA64_BC_FUNCTION]  = execute_decoded_function,
 [LA64_BC_FUNCTION2] = execute_function_extended,
@@ -1,8 +1,10 @@
 #include "cpu.hpp"
 #include "machine.hpp"
 #include "threaded_bytecodes.hpp"
+#include "la_instr_impl.hpp"
 #include "instruction_counter.hpp"
 
+// Guaranteed tail call, on Clang and GCC 15+ (checked by CMake)
 #define MUSTTAIL __attribute__((musttail))
 #define MUNUSED  [[maybe_unused]]
 #define DISPATCH_MODE_TAILCALL
@@ -39,7 +41,15 @@ namespace loongarch {
 #define EXECUTE_INSTR() \
 	computed_opcode[d->get_bytecode()](d, exec, cpu, pc, counter)
 
+#define DISPATCH_FUNCTION simulate
+#ifdef LA_INSTRUCTION_PROFILING
+#define PROFILE_INSTR() exec->record_execution(d);
+#else
+#define PROFILE_INSTR() /* */
+#endif
+
 #define EXECUTE_CURRENT() \
+	PROFILE_INSTR() \
 	MUSTTAIL return EXECUTE_INSTR();
 
 #define RECONSTRUCT_PC() (pc - d->block_bytes)
@@ -51,6 +61,11 @@ namespace loongarch {
 	} \
 	EXECUTE_CURRENT()
 
+#define SKIP_INSTR() \
+	d += 1;
+#define SKIP_INSTRS(n) \
+	d += (n);
+
 #define RETURN_VALUES() pc
 
 #define BEGIN_BLOCK() \
@@ -101,6 +116,18 @@ namespace loongarch {
 	BEGIN_BLOCK() \
 	EXECUTE_CURRENT()
 
+#define CHAINED_BRANCH(offset) \
+	pc = RECONSTRUCT_PC() + (offset); \
+	d += (offset) >> DecoderCache::SHIFT; \
+	pc += d->block_bytes; \
+	EXECUTE_CURRENT()
+
+#define PREDICTED_RETURN(entry) \
+	d = (entry); \
+	OVERFLOW_CHECK() \
+	BEGIN_BLOCK() \
+	EXECUTE_CURRENT()
+
 #define OVERFLOW_CHECKED_JUMP() \
 	OVERFLOW_CHECK(); \
 	UNCHECKED_JUMP();
@@ -136,7 +163,10 @@ namespace loongarch
 		// Make the instruction counter visible
 		counter.apply(MACHINE());
 		// Invoke system call
-		cpu.machine().system_call(cpu.reg(REG_A7));
+		{
+			CPU::ExecutePin pin(cpu, exec);
+			cpu.machine().system_call(cpu.reg(REG_A7));
+		}
 		// Restore counters
 		counter.retrieve_counters(MACHINE());
 		// System calls can change PC
@@ -145,21 +175,40 @@ namespace loongarch
 			pc = cpu.registers().pc;
 			OVERFLOW_CHECKED_JUMP();
 		}
+		// The system call may have invalidated the current segment
+		if (LA_UNLIKELY(exec->is_stale()))
+		{
+			pc += 4;
+			OVERFLOW_CHECK();
+			MUSTTAIL return next_execute_segment(d, exec, cpu, pc, counter);
+		}
 		NEXT_BLOCK(4);
 	}
 
 	INSTRUCTION(LA64_BC_SYSCALLIMM, la64_syscall_imm)
 	{
-		VIEW_INSTR();
 		// Make the current PC visible
 		cpu.registers().pc = pc;
 		counter.apply(MACHINE());
 		// Execute syscall from verified immediate
-		cpu.machine().system_call(d->instr);
+		{
+			CPU::ExecutePin pin(cpu, exec);
+			cpu.machine().system_call(d->instr);
+		}
 		// Restore max counter
 		counter.retrieve_counters(MACHINE());
-		// Return immediately using REG_RA
+		// Return immediately using REG_RA, popping the prediction of the call
 		pc = REG(REG_RA);
+		DecoderData* entry = cpu.predict_return(pc);
+		// The system call may have invalidated the current segment
+		if (LA_UNLIKELY(exec->is_stale()))
+		{
+			OVERFLOW_CHECK();
+			MUSTTAIL return next_execute_segment(d, exec, cpu, pc, counter);
+		}
+		if (LA_LIKELY(entry != nullptr)) {
+			PREDICTED_RETURN(entry);
+		}
 		OVERFLOW_CHECKED_JUMP();
 	}
 
@@ -183,12 +232,12 @@ namespace loongarch
 
 	// Bytecode function table for tailcall dispatch
 	namespace {
-		static const DecoderFunc computed_opcode[BYTECODES_MAX] = {
+		const DecoderFunc computed_opcode[BYTECODES_MAX] = {
 			#include "tailcall_bytecode_array.hpp"
 		};
 	}
 
-	bool CPU::simulate(address_t pc, uint64_t inscounter, uint64_t maxcounter)
+	bool CPU::DISPATCH_FUNCTION(address_t pc, uint64_t inscounter, uint64_t maxcounter)
 	{
 		InstrCounter counter{inscounter, maxcounter};
 
@@ -207,6 +256,7 @@ namespace loongarch
 
 		BEGIN_BLOCK();
 
+		PROFILE_INSTR();
 		const address_t new_pc = EXECUTE_INSTR();
 
 		cpu.registers().pc = new_pc;
@@ -1,18 +1,28 @@
 #include "cpu.hpp"
 #include "machine.hpp"
 #include "threaded_bytecodes.hpp"
+#include "la_instr_impl.hpp"
 
+// Guaranteed tail call, on Clang and GCC 15+ (checked by CMake)
 #define MUSTTAIL __attribute__((musttail))
 #define MUNUSED  [[maybe_unused]]
 #define DISPATCH_MODE_TAILCALL
+// Handlers keep nothing in callee-saved registers (Clang 19+)
+#if defined(__has_attribute) && __has_attribute(preserve_none)
+#define PRESERVE_NONE __attribute__((preserve_none))
+#else
+#define PRESERVE_NONE
+#endif
 
 namespace loongarch {
 	static constexpr bool TRACING = false;
 	// Return type for tailcall dispatch
 	using TcoRet = address_t;
+	// Returned by the handlers when the watchdog stopped execution
+	static constexpr TcoRet WATCHDOG_STOPPED = ~address_t(0);
 
 	// Function pointer type for bytecode handlers (inaccurate doesn't need counter)
-	using DecoderFunc = __attribute__((preserve_none))
+	using DecoderFunc = PRESERVE_NONE
 		TcoRet(*)(DecoderData* d, DecodedExecuteSegment* exec, CPU& cpu, address_t pc);
 
 	namespace {
@@ -22,7 +32,7 @@ namespace loongarch {
 
 // Macro definitions for tailcall dispatch (inaccurate version)
 #define INSTRUCTION(bytecode, name) \
-	static __attribute__((preserve_none)) \
+	static PRESERVE_NONE \
 	TcoRet name(DecoderData* d, MUNUSED DecodedExecuteSegment* exec, MUNUSED CPU& cpu, MUNUSED address_t pc)
 
 #define DECODER()   (*d)
@@ -37,7 +47,14 @@ namespace loongarch {
 #define EXECUTE_INSTR() \
 	computed_opcode[d->get_bytecode()](d, exec, cpu, pc)
 
+#ifdef LA_INSTRUCTION_PROFILING
+#define PROFILE_INSTR() exec->record_execution(d);
+#else
+#define PROFILE_INSTR() /* */
+#endif
+
 #define EXECUTE_CURRENT() \
+	PROFILE_INSTR() \
 	MUSTTAIL return EXECUTE_INSTR();
 
 #define RECONSTRUCT_PC() (pc - d->block_bytes)
@@ -49,8 +66,30 @@ namespace loongarch {
 	} \
 	EXECUTE_CURRENT()
 
+#define SKIP_INSTR() \
+	d += 1;
+#define SKIP_INSTRS(n) \
+	d += (n);
+
 #define RETURN_VALUES() pc
 
+// The watchdog variant (CPU::simulate_watchdog) polls Machine::stop_flag()
+// on backward branches, indirect jumps and returns
+#ifdef DISPATCH_MODE_WATCHDOG
+#define WATCHDOG_CHECK() \
+	if (LA_UNLIKELY(MACHINE().stop_flag().load(std::memory_order_relaxed))) { \
+		REGISTERS().pc = pc; \
+		return WATCHDOG_STOPPED; \
+	}
+#define WATCHDOG_BACKWARD_CHECK(offset) \
+	if ((offset) <= 0) { \
+		WATCHDOG_CHECK() \
+	}
+#else
+#define WATCHDOG_CHECK() /* */
+#define WATCHDOG_BACKWARD_CHECK(offset) /* */
+#endif
+
 #define BEGIN_BLOCK() \
 	pc += d->block_bytes; \
 	if constexpr (TRACING) { \
@@ -62,6 +101,7 @@ namespace loongarch {
 		printf("TRACE: NEXT_BLOCK PC=0x%lx to 0x%lx (offset %ld)\n", pc, pc+offset, long(offset)); \
 	} \
 	pc += (offset); \
+	WATCHDOG_CHECK() \
 	d = exec->pc_relative_decoder_cache(pc); \
 	QUICK_EXEC_CHECK() \
 	BEGIN_BLOCK() \
@@ -85,6 +125,7 @@ namespace loongarch {
 
 #define PERFORM_BRANCH(offset) \
 	pc += (offset); \
+	WATCHDOG_BACKWARD_CHECK(offset) \
 	d += (offset) >> DecoderCache::SHIFT; \
 	if constexpr (TRACING) { \
 		printf("TRACE: Branch taken. New PC=0x%lx\n", pc); \
@@ -92,6 +133,18 @@ namespace loongarch {
 	BEGIN_BLOCK() \
 	EXECUTE_CURRENT()
 
+#define CHAINED_BRANCH(offset) \
+	pc = RECONSTRUCT_PC() + (offset); \
+	d += (offset) >> DecoderCache::SHIFT; \
+	pc += d->block_bytes; \
+	EXECUTE_CURRENT()
+
+#define PREDICTED_RETURN(entry) \
+	WATCHDOG_CHECK() \
+	d = (entry); \
+	BEGIN_BLOCK() \
+	EXECUTE_CURRENT()
+
 namespace loongarch
 {
 	static inline DecodedExecuteSegment* resolve_execute_segment(CPU& cpu, address_t& pc)
@@ -120,7 +173,10 @@ namespace loongarch
 		// Make the current PC visible
 		cpu.registers().pc = pc;
 		// Invoke system call
-		cpu.machine().system_call(cpu.reg(REG_A7));
+		{
+			CPU::ExecutePin pin(cpu, exec);
+			cpu.machine().system_call(cpu.reg(REG_A7));
+		}
 		if (LA_UNLIKELY(cpu.machine().max_instructions() == 0))
 			return RETURN_VALUES();
 		// System calls can change PC
@@ -129,20 +185,35 @@ namespace loongarch
 			pc = cpu.registers().pc;
 			UNCHECKED_JUMP();
 		}
+		// The system call may have invalidated the current segment
+		if (LA_UNLIKELY(exec->is_stale()))
+		{
+			pc += 4;
+			MUSTTAIL return next_execute_segment(d, exec, cpu, pc);
+		}
 		NEXT_BLOCK_UNCHECKED(4);
 	}
 
 	INSTRUCTION(LA64_BC_SYSCALLIMM, la64_syscall_imm)
 	{
-		VIEW_INSTR();
 		// Make the current PC visible
 		cpu.registers().pc = pc;
 		// Execute syscall from verified immediate
-		cpu.machine().system_call(d->instr);
-		// Return immediately using REG_RA
+		{
+			CPU::ExecutePin pin(cpu, exec);
+			cpu.machine().system_call(d->instr);
+		}
+		// Return immediately using REG_RA, popping the prediction of the call
 		pc = REG(REG_RA);
+		DecoderData* entry = cpu.predict_return(pc);
 		if (LA_UNLIKELY(MACHINE().max_instructions() == 0))
 			return RETURN_VALUES();
+		// The system call may have invalidated the current segment
+		if (LA_UNLIKELY(exec->is_stale()))
+			MUSTTAIL return next_execute_segment(d, exec, cpu, pc);
+		if (LA_LIKELY(entry != nullptr)) {
+			PREDICTED_RETURN(entry);
+		}
 		UNCHECKED_JUMP();
 	}
 
@@ -166,12 +237,16 @@ namespace loongarch
 
 	// Bytecode function table for tailcall dispatch
 	namespace {
-		static const DecoderFunc computed_opcode[BYTECODES_MAX] = {
+		const DecoderFunc computed_opcode[BYTECODES_MAX] = {
 			#include "tailcall_bytecode_array.hpp"
 		};
 	}
 
+#ifdef DISPATCH_MODE_WATCHDOG
+	bool CPU::simulate_watchdog(address_t pc)
+#else
 	void CPU::simulate_inaccurate(address_t pc)
+#endif
 	{
 		machine().set_max_instructions(~0ull);
 
@@ -190,9 +265,20 @@ namespace loongarch
 
 		BEGIN_BLOCK();
 
+		PROFILE_INSTR();
 		const address_t new_pc = EXECUTE_INSTR();
 
+#ifdef DISPATCH_MODE_WATCHDOG
+		if (new_pc == WATCHDOG_STOPPED) {
+			// PC was stored by the handler that saw the flag
+			machine().stop_flag().store(false, std::memory_order_relaxed);
+			return false;
+		}
+		cpu.registers().pc = new_pc;
+		return true;
+#else
 		cpu.registers().pc = new_pc;
+#endif
 	}
 
 } // loongarch
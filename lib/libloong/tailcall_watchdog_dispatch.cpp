@@ -0,0 +1,5 @@
+// Watchdog variant of the inaccurate tail-call dispatch (CPU::simulate_watchdog)
+// Polls the machine stop flag, so that a host timer can end execution
+// without the cost of instruction counting. See Machine::simulate_for.
+#define DISPATCH_MODE_WATCHDOG
+#include "tailcall_inaccurate_dispatch.cpp"
@@ -93,17 +93,42 @@ namespace loongarch
 		LA64_BC_VFADD_D,           // Vector floating-point add double (11 in stream)
 		LA64_BC_VFMADD_D,          // Vector fused multiply-add double
 		LA64_BC_VHADDW_D_W,        // Vector horizontal add with widening (word to doubleword)
+		LA64_BC_VORI_B,            // Vector OR immediate (vori.b vd, vj, 0 is a vector move)
+		LA64_BC_VREPLGR2VR_W,      // Broadcast word from a general register
+		LA64_BC_VREPLGR2VR_D,      // Broadcast doubleword from a general register
+		LA64_BC_VPICKVE2GR_W,      // Vector element to general register (word, sign-extended)
+		LA64_BC_VPICKVE2GR_D,      // Vector element to general register (doubleword)
+		LA64_BC_VSHUF_B,           // Vector byte shuffle
 
 		// LASX (256-bit) instructions
 		LA64_BC_XVLD,              // Vector load 256-bit LASX
 		LA64_BC_XVST,              // Vector store 256-bit LASX
 		LA64_BC_XVLDX,             // Vector indexed load 256-bit LASX
 		LA64_BC_XVSTX,             // Vector indexed store 256-bit LASX
+		LA64_BC_XVFMADD_D,         // Vector fused multiply-add double LASX
+
+		// LSX/LASX 3R bytecodes (see vector_bytecodes.hpp)
+#define LA64_VECTOR_BYTECODE(id, name, ...) LA64_BC_##id,
+#include "vector_bytecodes.hpp"
+#undef LA64_VECTOR_BYTECODE
 
 		// Floating-point instructions
 		LA64_BC_FMADD_D,           // Fused multiply-add double
 		LA64_BC_FLDX_D,            // Floating-point indexed load double
 		LA64_BC_FSTX_D,            // Floating-point indexed store double
+		LA64_BC_FLD_S,             // Floating-point load word
+		LA64_BC_FST_S,             // Floating-point store word
+		LA64_BC_FADD_S,            // Floating-point add single
+		LA64_BC_FSUB_S,            // Floating-point subtract single
+		LA64_BC_FMUL_S,            // Floating-point multiply single
+		LA64_BC_FDIV_S,            // Floating-point divide single
+		LA64_BC_FMADD_S,           // Fused multiply-add single
+		LA64_BC_FMOV_S,            // Floating-point move single
+		LA64_BC_FMOV_D,            // Floating-point move double
+		LA64_BC_FCVT_S_D,          // Convert double to single
+		LA64_BC_FCVT_D_S,          // Convert single to double
+		LA64_BC_FCMP_COND_S,       // Floating-point compare single, sets a condition flag
+		LA64_BC_FCMP_COND_D,       // Floating-point compare double, sets a condition flag
 
 		// Branch instructions
 		LA64_BC_BEQZ,              // Branch if equal to zero
@@ -119,6 +144,31 @@ namespace loongarch
 		LA64_BC_BGE,               // Branch if greater than or equal
 		LA64_BC_BLTU,              // Branch if less than unsigned
 		LA64_BC_BGEU,              // Branch if greater than or equal unsigned
+		LA64_BC_B_CHAINED,         // Forward B, target block counted with this one
+		LA64_BC_BL_CHAINED,        // Forward BL, target block counted with this one
+		LA64_BC_RET,               // JIRL zero, ra, 0 with return address prediction
+
+		// Superinstructions (fused adjacent pairs, the second slot is left intact)
+		LA64_BC_SLT_BEQZ,          // SLT rd + BEQZ rd
+		LA64_BC_SLT_BNEZ,          // SLT rd + BNEZ rd
+		LA64_BC_SLTU_BEQZ,         // SLTU rd + BEQZ rd
+		LA64_BC_SLTU_BNEZ,         // SLTU rd + BNEZ rd
+		LA64_BC_ADDI_D_LD_D,       // ADDI.D rd + LD.D from rd
+		LA64_BC_ALSL_D_LDX_D,      // ALSL.D rd + LDX.D indexed by rd
+		LA64_BC_LD_D_LD_D,         // LD.D + LD.D from the same base
+		LA64_BC_FCMP_S_BCEQZ,      // FCMP.cond.S cd + BCEQZ cd
+		LA64_BC_FCMP_S_BCNEZ,      // FCMP.cond.S cd + BCNEZ cd
+		LA64_BC_FCMP_D_BCEQZ,      // FCMP.cond.D cd + BCEQZ cd
+		LA64_BC_FCMP_D_BCNEZ,      // FCMP.cond.D cd + BCNEZ cd
+		LA64_BC_LD_D_SP,           // LD.D from sp, runs the following stack accesses
+		LA64_BC_ST_D_SP,           // ST.D to sp, runs the following stack accesses
+		LA64_BC_CONST,             // Folded constant/address (LU12I.W+ORI+LU32I.D+LU52I.D, PCALAU12I+ADDI.D)
+		LA64_BC_CONST_LD_D,        // Folded address + LD.D (PCALAU12I+LD.D)
+
+		// Profile-guided bytecodes (generated, see profiled_bytecodes.hpp)
+#define LA64_PROFILED_BYTECODE(id, name) LA64_BC_##id,
+#include "profiled_bytecodes.hpp"
+#undef LA64_PROFILED_BYTECODE
 
 		// Generic handlers
 		LA64_BC_FUNCTION,          // Non-PC-modifying instruction (simple handler call)
@@ -223,13 +273,36 @@ namespace loongarch
 		case LA64_BC_VSTX: return "VSTX";
 		case LA64_BC_VFMADD_D: return "VFMADD.D";
 		case LA64_BC_VHADDW_D_W: return "VHADDW.D.W";
+		case LA64_BC_VORI_B: return "VORI.B";
+		case LA64_BC_VREPLGR2VR_W: return "VREPLGR2VR.W";
+		case LA64_BC_VREPLGR2VR_D: return "VREPLGR2VR.D";
+		case LA64_BC_VPICKVE2GR_W: return "VPICKVE2GR.W";
+		case LA64_BC_VPICKVE2GR_D: return "VPICKVE2GR.D";
+		case LA64_BC_VSHUF_B: return "VSHUF.B";
 		case LA64_BC_XVLD: return "XVLD";
 		case LA64_BC_XVST: return "XVST";
 		case LA64_BC_XVLDX: return "XVLDX";
 		case LA64_BC_XVSTX: return "XVSTX";
+		case LA64_BC_XVFMADD_D: return "XVFMADD.D";
+#define LA64_VECTOR_BYTECODE(id, name, ...) case LA64_BC_##id: return name;
+#include "vector_bytecodes.hpp"
+#undef LA64_VECTOR_BYTECODE
 		case LA64_BC_FMADD_D: return "FMADD.D";
 		case LA64_BC_FLDX_D: return "FLDX.D";
 		case LA64_BC_FSTX_D: return "FSTX.D";
+		case LA64_BC_FLD_S: return "FLD.S";
+		case LA64_BC_FST_S: return "FST.S";
+		case LA64_BC_FADD_S: return "FADD.S";
+		case LA64_BC_FSUB_S: return "FSUB.S";
+		case LA64_BC_FMUL_S: return "FMUL.S";
+		case LA64_BC_FDIV_S: return "FDIV.S";
+		case LA64_BC_FMADD_S: return "FMADD.S";
+		case LA64_BC_FMOV_S: return "FMOV.S";
+		case LA64_BC_FMOV_D: return "FMOV.D";
+		case LA64_BC_FCVT_S_D: return "FCVT.S.D";
+		case LA64_BC_FCVT_D_S: return "FCVT.D.S";
+		case LA64_BC_FCMP_COND_S: return "FCMP.cond.S";
+		case LA64_BC_FCMP_COND_D: return "FCMP.cond.D";
 		case LA64_BC_BEQZ: return "BEQZ";
 		case LA64_BC_BNEZ: return "BNEZ";
 		case LA64_BC_BCEQZ: return "BCEQZ";
@@ -243,6 +316,27 @@ namespace loongarch
 		case LA64_BC_BGE: return "BGE";
 		case LA64_BC_BLTU: return "BLTU";
 		case LA64_BC_BGEU: return "BGEU";
+		case LA64_BC_B_CHAINED: return "B (chained)";
+		case LA64_BC_BL_CHAINED: return "BL (chained)";
+		case LA64_BC_RET: return "RET";
+		case LA64_BC_SLT_BEQZ: return "SLT+BEQZ";
+		case LA64_BC_SLT_BNEZ: return "SLT+BNEZ";
+		case LA64_BC_SLTU_BEQZ: return "SLTU+BEQZ";
+		case LA64_BC_SLTU_BNEZ: return "SLTU+BNEZ";
+		case LA64_BC_ADDI_D_LD_D: return "ADDI.D+LD.D";
+		case LA64_BC_ALSL_D_LDX_D: return "ALSL.D+LDX.D";
+		case LA64_BC_LD_D_LD_D: return "LD.D+LD.D";
+		case LA64_BC_FCMP_S_BCEQZ: return "FCMP.cond.S+BCEQZ";
+		case LA64_BC_FCMP_S_BCNEZ: return "FCMP.cond.S+BCNEZ";
+		case LA64_BC_FCMP_D_BCEQZ: return "FCMP.cond.D+BCEQZ";
+		case LA64_BC_FCMP_D_BCNEZ: return "FCMP.cond.D+BCNEZ";
+		case LA64_BC_LD_D_SP: return "LD.D (sp)";
+		case LA64_BC_ST_D_SP: return "ST.D (sp)";
+		case LA64_BC_CONST: return "CONST";
+		case LA64_BC_CONST_LD_D: return "CONST+LD.D";
+#define LA64_PROFILED_BYTECODE(id, name) case LA64_BC_##id: return name;
+#include "profiled_bytecodes.hpp"
+#undef LA64_PROFILED_BYTECODE
 		case LA64_BC_FUNCTION: return "FUNCTION";
 		case LA64_BC_FUNCTION2: return "FUNCTION";
 		case LA64_BC_SYSCALL: return "SYSCALL";
@@ -257,6 +351,25 @@ namespace loongarch
 		}
 	}
 
+	// Get the bytecode of the first instruction of a superinstruction
+	static inline uint8_t unfused_bytecode(uint8_t bytecode)
+	{
+		switch (bytecode) {
+		case LA64_BC_SLT_BEQZ:
+		case LA64_BC_SLT_BNEZ: return LA64_BC_SLT;
+		case LA64_BC_SLTU_BEQZ:
+		case LA64_BC_SLTU_BNEZ: return LA64_BC_SLTU;
+		case LA64_BC_ADDI_D_LD_D: return LA64_BC_ADDI_D;
+		case LA64_BC_ALSL_D_LDX_D: return LA64_BC_ALSL_D;
+		case LA64_BC_LD_D_LD_D: return LA64_BC_LD_D;
+		case LA64_BC_FCMP_S_BCEQZ:
+		case LA64_BC_FCMP_S_BCNEZ: return LA64_BC_FCMP_COND_S;
+		case LA64_BC_FCMP_D_BCEQZ:
+		case LA64_BC_FCMP_D_BCNEZ: return LA64_BC_FCMP_COND_D;
+		default: return bytecode;
+		}
+	}
+
 	// Optimized instruction formats for fast field access
 	union FasterLA64_RI12 {
 		uint32_t whole;
@@ -396,6 +509,15 @@ namespace loongarch
 		}
 	};
 
+	union FasterLA64_RI8 {
+		uint32_t whole;
+		struct {
+			uint8_t rd;     // bits [4:0]
+			uint8_t rj;     // bits [9:5]
+			uint8_t imm;    // bits [17:10] - 8-bit immediate or element index
+		};
+	};
+
 	union FasterLA64_4R {
 		uint32_t whole;
 		struct {
@@ -406,6 +528,26 @@ namespace loongarch
 		};
 	};
 
+	union FasterLA64_FCmp {
+		uint32_t whole;
+		struct {
+			uint8_t cd;     // bits [2:0] - condition flag to set
+			uint8_t fj;     // bits [9:5]
+			uint8_t fk;     // bits [14:10]
+			uint8_t cond;   // bits [19:15] - condition code
+		};
+	};
+
+	// Folded constant: the value is in the execute segment side table
+	union FasterLA64_Constant {
+		uint32_t whole;
+		struct {
+			uint8_t rd;      // destination register
+			uint8_t count;   // number of instructions folded
+			uint16_t index;  // index into the folded constants table
+		};
+	};
+
 	// Optimized format for conditional branches with 21-bit offset (BEQZ, BNEZ, BCEQZ, BCNEZ)
 	union FasterLA64_RI21_Branch {
 		uint32_t whole;
@@ -0,0 +1,6 @@
+// Diagnostic variants of the threaded dispatch, for tail-call builds
+// Only simulate_block_profiling(), simulate_tracing(), simulate_trapping()
+// and simulate_tiering() are defined here,
+// the other entry points come from the tail-call dispatch.
+#define DISPATCH_MODE_DIAGNOSTICS
+#include "threaded_dispatch.cpp"
@@ -1,7 +1,12 @@
 #include "cpu.hpp"
 #include "machine.hpp"
+#include "dispatch_policy.hpp"
 #include "threaded_bytecodes.hpp"
+#include "la_instr_impl.hpp"
 
+// One dispatch loop for all policies, see dispatch_policy.hpp.
+// The policy options are tested with if constexpr, so the instantiations
+// only contain the code for the options they enable.
 #define DECODER()   (*decoder)
 #define CPU()       (*this)
 #define REGISTERS() (m_regs)
@@ -10,33 +15,123 @@
 #define RECONSTRUCT_PC() (pc - DECODER().block_bytes)
 #define INSTRUCTION(bc, lbl) lbl:
 #define VIEW_INSTR() auto instr = la_instruction{decoder->instr};
+#define ENTER_BLOCK() \
+	if constexpr (Policy::block_profiling) \
+		exec->record_block_entry(pc); \
+	if constexpr (Policy::tracing) \
+		tracer(MACHINE(), pc); \
+	if constexpr (Policy::tiering) { \
+		if (LA_UNLIKELY((exec->record_block_entry(pc) & hot_mask) == 0)) \
+			translate_hot_block(MACHINE(), pc); \
+	}
+#define COUNT_BLOCK() \
+	if constexpr (Policy::counting && !Policy::stepping) \
+		counter += decoder->instruction_count();
+// Without counting, only an explicit stop sets max_counter to zero
+#define LIMIT_REACHED() \
+	(Policy::counting ? counter >= max_counter : max_counter == 0)
+// The watchdog polls Machine::stop_flag() on backward branches, indirect
+// jumps and returns. Loops can't avoid all of them, and straight-line code
+// always reaches one or the end.
+#define WATCHDOG_CHECK() \
+	if constexpr (Policy::watchdog) { \
+		if (LA_UNLIKELY(stop_flag.load(std::memory_order_relaxed))) \
+			goto watchdog_stop; \
+	}
+#define WATCHDOG_BACKWARD_CHECK(offset) \
+	if constexpr (Policy::watchdog) { \
+		if ((offset) <= 0 && LA_UNLIKELY(stop_flag.load(std::memory_order_relaxed))) { \
+			pc += (offset); \
+			goto watchdog_stop; \
+		} \
+	}
+// Faults longjmp out of the loop, so the trap needs to know where it was,
+// down to the member of a superinstruction (see SKIP_INSTR).
+// System call handlers run with the trap disarmed.
+#define TRAP_INSTR() \
+	if constexpr (Policy::trapping) \
+		trap->decoder = decoder;
+#define SYSCALL_BEGIN() \
+	if constexpr (Policy::trapping) \
+		arm_fault_trap(nullptr);
+#define SYSCALL_END() \
+	if constexpr (Policy::trapping) \
+		arm_fault_trap(trap);
+#ifdef LA_INSTRUCTION_PROFILING
+#define PROFILE_INSTR() exec->record_execution(decoder);
+#else
+#define PROFILE_INSTR() /* */
+#endif
+// Stepping counts every instruction before it runs, and stops in front of
+// the first one past the limit. PC is then the address of that instruction.
+#define STEP_INSTR() \
+	if constexpr (Policy::stepping) { \
+		if (LA_UNLIKELY(counter >= max_counter)) { \
+			pc -= decoder->block_bytes; \
+			goto stop_execution; \
+		} \
+		counter += 1; \
+		goto step_instruction; \
+	}
 #define EXECUTE_INSTR() \
+	PROFILE_INSTR() \
+	TRAP_INSTR() \
+	STEP_INSTR() \
 	goto *computed_opcode[decoder->get_bytecode()]
 #define NEXT_INSTR() \
 	decoder += 1; \
 	EXECUTE_INSTR();
+// Superinstructions and stack runs move on to their next member, which
+// is then the entry a fault is reported at
+#define SKIP_INSTR() \
+	decoder += 1; \
+	TRAP_INSTR()
+#define SKIP_INSTRS(n) \
+	decoder += (n); \
+	TRAP_INSTR()
 #define NEXT_BLOCK(len) \
 	pc += len; \
 	goto check_jump;
 #define NEXT_BLOCK_UNCHECKED(len) \
 	pc += len; \
 	decoder += len >> DecoderCache::SHIFT; \
+	ENTER_BLOCK() \
 	pc += decoder->block_bytes; \
-	counter += decoder->instruction_count(); \
+	COUNT_BLOCK() \
 	EXECUTE_INSTR();
 #define PERFORM_BRANCH(offset)           \
-	if (LA_LIKELY(counter < max_counter)) { \
+	WATCHDOG_BACKWARD_CHECK(offset)      \
+	if (!Policy::counting || LA_LIKELY(counter < max_counter)) { \
 		NEXT_BLOCK_UNCHECKED(offset);    \
 	}                                    \
 	pc += offset;                        \
 	goto check_jump;
+// The chained block was counted with the block ending here, but it is
+// still entered for profiling and tracing
+#define CHAINED_BRANCH(offset) \
+	pc = RECONSTRUCT_PC() + (offset); \
+	decoder += (offset) >> DecoderCache::SHIFT; \
+	ENTER_BLOCK() \
+	pc += decoder->block_bytes; \
+	EXECUTE_INSTR();
+#define PREDICTED_RETURN(entry) \
+	WATCHDOG_CHECK() \
+	if (!Policy::counting || LA_LIKELY(counter < max_counter)) { \
+		decoder = (entry); \
+		ENTER_BLOCK() \
+		pc += decoder->block_bytes; \
+		COUNT_BLOCK() \
+		EXECUTE_INSTR(); \
+	} \
+	goto check_jump;
 
 namespace loongarch
 {
-	bool CPU::simulate(address_t pc, uint64_t inscounter, uint64_t maxcounter)
+	template <typename Policy>
+	bool CPU::dispatch(address_t pc, uint64_t inscounter, uint64_t maxcounter)
 	{
-		constexpr bool TRACE_DISPATCH = false;  // Disable for normal execution
-		machine().set_max_instructions(UINT64_MAX);
+		if constexpr (Policy::counting)
+			machine().set_max_instructions(UINT64_MAX);
 
 		// Include computed goto table
 		#include "threaded_bytecode_array.hpp"
@@ -49,27 +144,27 @@ namespace loongarch
 		DecoderData* exec_decoder = exec->pc_relative_decoder_cache();
 		DecoderData* decoder;
 
+		// Without counting, counter stays at zero
 		uint64_t counter = inscounter;
 		uint64_t max_counter = maxcounter;
 
+		[[maybe_unused]] std::atomic<bool>& stop_flag = machine().stop_flag();
+		[[maybe_unused]] Machine::dispatch_tracer_t* tracer = machine().dispatch_tracer();
+		[[maybe_unused]] FaultTrap* const trap = armed_fault_trap();
+		[[maybe_unused]] const uint64_t hot_mask = machine().translate_hot_mask();
+
 		// We need an execute segment matching current PC
 		if (LA_UNLIKELY(!(pc >= current_begin && pc < current_end)))
 			goto new_execute_segment;
 
 continue_segment:
 		decoder = &exec_decoder[pc >> DecoderCache::SHIFT];
+		ENTER_BLOCK();
 
 		pc += decoder->block_bytes;
-		counter += decoder->instruction_count();
-
-		if constexpr (TRACE_DISPATCH) {
-			fprintf(stderr, "[accurate] PC=0x%lx block_bytes=%u num_instrs=%u counter=%lu max=%lu\n",
-				(unsigned long)(pc - decoder->block_bytes), decoder->block_bytes, decoder->instruction_count(),
-				(unsigned long)counter, (unsigned long)max_counter);
-			fflush(stderr);
-		}
+		COUNT_BLOCK();
 
-		goto *computed_opcode[decoder->get_bytecode()];
+		EXECUTE_INSTR();
 
 		/** Bytecode handlers **/
 		#include "bytecode_impl.cpp"
@@ -78,13 +173,21 @@ INSTRUCTION(LA64_BC_SYSCALL, la64_syscall)
 {
 	REGISTERS().pc = pc;
 	MACHINE().set_max_instructions(max_counter);
-	MACHINE().system_call(REG(REG_A7));
+	SYSCALL_BEGIN();
+	{
+		ExecutePin pin(CPU(), exec);
+		MACHINE().system_call(REG(REG_A7));
+	}
+	SYSCALL_END();
 	// Restore counters
 	max_counter = MACHINE().max_instructions();
 
-	if (LA_UNLIKELY(max_counter == 0 || pc != REGISTERS().pc))
+	if (LA_UNLIKELY(max_counter == 0 || pc != REGISTERS().pc || exec->is_stale()))
 	{
 		pc = REGISTERS().pc + 4;
+		// The system call may have invalidated the current segment
+		if (exec->is_stale())
+			current_end = current_begin;
 		goto check_jump;
 	}
 	// Syscall completed normally
@@ -96,12 +199,26 @@ INSTRUCTION(LA64_BC_SYSCALLIMM, la64_syscall_imm)
 	REGISTERS().pc = pc;
 	MACHINE().set_max_instructions(max_counter);
 	// Execute syscall from verified immediate
-	MACHINE().system_call(DECODER().instr);
+	SYSCALL_BEGIN();
+	{
+		ExecutePin pin(CPU(), exec);
+		MACHINE().system_call(DECODER().instr);
+	}
+	SYSCALL_END();
 	// Restore max counter
 	max_counter = MACHINE().max_instructions();
 
-	// Return immediately using REG_RA
+	// Return immediately using REG_RA, popping the prediction of the call
 	pc = REG(REG_RA);
+	{
+		DecoderData* entry = CPU().predict_return(pc);
+		// The system call may have invalidated the current segment
+		if (exec->is_stale()) {
+			current_end = current_begin;
+		} else if (LA_LIKELY(entry != nullptr && max_counter != 0)) {
+			PREDICTED_RETURN(entry);
+		}
+	}
 	goto check_jump;
 }
 
@@ -109,17 +226,23 @@ INSTRUCTION(LA64_BC_SYSCALLIMM, la64_syscall_imm)
 INSTRUCTION(LA64_BC_TRANSLATOR, execute_translated_block)
 {
 	// The instr field contains the index into the translator mappings array
-	const auto handler = exec->build_mapping(DECODER().instr);
+	// The entry may have been patched by another thread since it was decoded.
+	const auto handler = exec->build_mapping(DECODER().load_acquire().instr);
 
 	// Save PC for binary translated function
 	REGISTERS().pc = pc;
 
 	// Call the binary translated function
 	// It returns updated instruction counter values
+	ExecutePin pin(CPU(), exec);
 	const auto result = handler(CPU(), counter, max_counter, RECONSTRUCT_PC());
+	// Its system calls may have invalidated the current segment
+	if (exec->is_stale())
+		current_end = current_begin;
 
 	// Update instruction counter and max counter
-	counter = result.ic;
+	if constexpr (Policy::counting)
+		counter = result.ic;
 	max_counter = result.max_ic;
 
 	// Read updated PC from CPU
@@ -133,10 +256,63 @@ INSTRUCTION(LA64_BC_TRANSLATOR, execute_translated_block)
 INSTRUCTION(LA64_BC_STOP, la64_stop)
 {
 	REGISTERS().pc = pc + 4;
-	machine().set_instruction_counter(counter);
+	if constexpr (Policy::counting)
+		machine().set_instruction_counter(counter);
 	return true;
 }
 
+step_instruction: __attribute__((unused));
+	if constexpr (Policy::stepping) {
+		// Run one instruction per bytecode: superinstructions and stack
+		// runs as their first instruction, which continues into the next slot
+		const uint8_t bytecode = decoder->get_bytecode();
+		switch (bytecode) {
+		case LA64_BC_LD_D_SP:
+			goto *computed_opcode[LA64_BC_LD_D];
+		case LA64_BC_ST_D_SP:
+			goto *computed_opcode[LA64_BC_ST_D];
+		case LA64_BC_CONST:
+		case LA64_BC_CONST_LD_D: {
+			// The head of a folded constant keeps its own instruction bits
+			const uint32_t bits = decoder->instr;
+			const auto fc = *(const FasterLA64_Constant *)&bits;
+			REGISTERS().pc = RECONSTRUCT_PC();
+			execute(la_instruction{exec->folded_head(fc.index).instr});
+			NEXT_INSTR();
+		}
+		case LA64_BC_FUNCTION:
+		case LA64_BC_FUNCTION2:
+			goto *computed_opcode[bytecode];
+		case LA64_BC_LIVEPATCH:
+#ifdef LA_BINARY_TRANSLATION
+		case LA64_BC_TRANSLATOR:
+#endif
+			goto step_guest_instruction;
+		default:
+			// Accelerated functions have handler 0, and run the guest code
+			// they replaced
+			if (LA_UNLIKELY(decoder->handler_idx == 0))
+				goto step_guest_instruction;
+			goto *computed_opcode[unfused_bytecode(bytecode)];
+		}
+
+step_guest_instruction:
+		// Patched entries have no decoded instruction of their own
+		REGISTERS().pc = RECONSTRUCT_PC();
+		MACHINE().set_max_instructions(max_counter);
+		SYSCALL_BEGIN();
+		{
+			ExecutePin pin(CPU(), exec);
+			execute(read_current_instruction());
+		}
+		SYSCALL_END();
+		max_counter = MACHINE().max_instructions();
+		pc = REGISTERS().pc + 4;
+		if (exec->is_stale())
+			current_end = current_begin;
+		goto check_jump;
+	}
+
 		// Cleanup macros
 		#undef DECODER
 		#undef CPU
@@ -146,8 +322,17 @@ INSTRUCTION(LA64_BC_STOP, la64_stop)
 		#undef INSTRUCTION
 		#undef VIEW_INSTR
 		#undef NEXT_INSTR
+		#undef SKIP_INSTR
+		#undef SKIP_INSTRS
 		#undef NEXT_BLOCK
 		#undef EXECUTE_INSTR
+		#undef PROFILE_INSTR
+		#undef TRAP_INSTR
+		#undef STEP_INSTR
+		#undef SYSCALL_BEGIN
+		#undef SYSCALL_END
+		#undef ENTER_BLOCK
+		#undef COUNT_BLOCK
 
 new_execute_segment:
 		m_regs.pc = pc;
@@ -159,15 +344,16 @@ new_execute_segment:
 		current_begin = exec->exec_begin();
 		current_end   = exec->exec_end();
 		// Offset the cache pointer for the new segment
-		exec_decoder  = exec->decoder_cache() - (current_begin >> DecoderCache::SHIFT);
+		exec_decoder  = exec->pc_relative_decoder_cache();
 
-		if (counter < max_counter)
+		if (!LIMIT_REACHED())
 			goto continue_segment;
 		// Fall through
 
 stop_execution:
 		m_regs.pc = pc;
-		machine().set_instruction_counter(counter);
+		if constexpr (Policy::counting)
+			machine().set_instruction_counter(counter);
 		if (machine().has_current_exception()) {
 			const auto ex = machine().current_exception();
 			machine().clear_current_exception();
@@ -175,19 +361,18 @@ stop_execution:
 		}
 		return max_counter == 0;
 
-check_jump:
-		if constexpr (TRACE_DISPATCH) {
-			fprintf(stderr, "[check_jump] PC=0x%lx counter=%lu max=%lu\n",
-				(unsigned long)pc, (unsigned long)counter, (unsigned long)max_counter);
-			fflush(stderr);
+watchdog_stop: __attribute__((unused));
+		if constexpr (Policy::watchdog) {
+			// PC is the next block to execute, so simulate_for() can resume
+			m_regs.pc = pc;
+			stop_flag.store(false, std::memory_order_relaxed);
 		}
-		if (counter >= max_counter) {
-			if constexpr (TRACE_DISPATCH) {
-				fprintf(stderr, "[check_jump] STOPPING: counter >= max\n");
-				fflush(stderr);
-			}
+		return false;
+
+check_jump:
+		if (LIMIT_REACHED())
 			goto stop_execution;
-		}
+		WATCHDOG_CHECK();
 
 		if (LA_UNLIKELY(!(pc >= current_begin && pc < current_end)))
 			goto new_execute_segment;
@@ -195,4 +380,66 @@ check_jump:
 		goto continue_segment;
 	}
 
+	// The diagnostic and trapping variants are always threaded. Tail-call builds
+	// compile this file with DISPATCH_MODE_DIAGNOSTICS for them, and keep their own
+	// tail-call simulate(), simulate_inaccurate() and simulate_watchdog().
+#ifndef DISPATCH_MODE_DIAGNOSTICS
+	bool CPU::simulate(address_t pc, uint64_t icounter, uint64_t maxcounter)
+	{
+		return dispatch<AccurateDispatch>(pc, icounter, maxcounter);
+	}
+
+	void CPU::simulate_inaccurate(address_t pc)
+	{
+		dispatch<InaccurateDispatch>(pc, 0, UINT64_MAX);
+	}
+
+	bool CPU::simulate_watchdog(address_t pc)
+	{
+		return dispatch<WatchdogDispatch>(pc, 0, UINT64_MAX);
+	}
+#endif
+
+	bool CPU::simulate_block_profiling(address_t pc, uint64_t icounter, uint64_t maxcounter)
+	{
+		return dispatch<BlockProfilingDispatch>(pc, icounter, maxcounter);
+	}
+
+	bool CPU::simulate_trapping(address_t pc, uint64_t icounter, uint64_t maxcounter)
+	{
+		if (armed_fault_trap() == nullptr)
+			return simulate(pc, icounter, maxcounter);
+		return dispatch<TrappingDispatch>(pc, icounter, maxcounter);
+	}
+
+	bool CPU::simulate_tracing(address_t pc, uint64_t icounter, uint64_t maxcounter)
+	{
+		if (machine().dispatch_tracer() == nullptr)
+			return simulate(pc, icounter, maxcounter);
+		return dispatch<TracingDispatch>(pc, icounter, maxcounter);
+	}
+
+#ifdef LA_BINARY_TRANSLATION
+	bool CPU::simulate_tiering(address_t pc, uint64_t icounter, uint64_t maxcounter)
+	{
+		return dispatch<TieringDispatch>(pc, icounter, maxcounter);
+	}
+#endif
+
+	void CPU::simulate_precise()
+	{
+		dispatch<PreciseDispatch>(pc(), machine().instruction_counter(), machine().max_instructions());
+	}
+
+	void CPU::step_decoded(bool use_instruction_counter)
+	{
+		const uint64_t max_instructions = machine().max_instructions();
+		const uint64_t counter = machine().instruction_counter();
+		const bool stopped = dispatch<PreciseDispatch>(pc(), counter, counter + 1);
+		if (!use_instruction_counter)
+			machine().set_instruction_counter(counter);
+		// The dispatch replaces the limit, which only a stop should change
+		machine().set_max_instructions(stopped ? 0 : max_instructions);
+	}
+
 } // loongarch
@@ -1,7 +1,10 @@
 #include "decoded_exec_segment.hpp"
 
 #include "la_instr.hpp"
+#include "registers.hpp"
 #include "threaded_bytecodes.hpp"
+#include <algorithm>
+
 #define NOP_IF_RD_ZERO(fi_rd, bytecode) \
 	if (fi_rd == 0) {                   \
 		bytecode = LA64_BC_NOP;         \
@@ -226,6 +229,10 @@ uint32_t DecodedExecuteSegment::optimize_bytecode(uint8_t& bytecode, address_t p
 		case LA64_BC_PCADDI:
 		case LA64_BC_PCALAU12I:
 		case LA64_BC_LU12I_W:
+		// Profile-guided bytecodes call the regular instruction handler
+#define LA64_PROFILED_BYTECODE(id, name) case LA64_BC_##id:
+#include "profiled_bytecodes.hpp"
+#undef LA64_PROFILED_BYTECODE
 			// No optimization needed - use original instruction bits
 			return instruction_bits;
 		case LA64_BC_LDPTR_D: {
@@ -575,6 +582,53 @@ uint32_t DecodedExecuteSegment::optimize_bytecode(uint8_t& bytecode, address_t p
 			fi.rk = original.r3.rk;
 			return fi.whole;
 		} break;
+		case LA64_BC_XVFMADD_D:
+		case LA64_BC_VSHUF_B: {
+			// XVFMADD.D xd, xj, xk, xa / VSHUF.B vd, vj, vk, va - 4R-type format
+			auto fi = *(FasterLA64_4R *)&instruction_bits;
+			fi.rd = original.r4.rd;
+			fi.rj = original.r4.rj;
+			fi.rk = original.r4.rk;
+			fi.ra = original.r4.ra;
+			return fi.whole;
+		} break;
+		case LA64_BC_VORI_B: {
+			// VORI.B vd, vj, ui8
+			auto fi = *(FasterLA64_RI8 *)&instruction_bits;
+			fi.rd = original.whole & 0x1F;
+			fi.rj = (original.whole >> 5) & 0x1F;
+			fi.imm = (original.whole >> 10) & 0xFF;
+			return fi.whole;
+		} break;
+		case LA64_BC_VREPLGR2VR_W:
+		case LA64_BC_VREPLGR2VR_D: {
+			// VREPLGR2VR.W/D vd, rj - uses R2 format
+			auto fi = *(FasterLA64_R2 *)&instruction_bits;
+			fi.rd = original.r2.rd;
+			fi.rj = original.r2.rj;
+			return fi.whole;
+		} break;
+		case LA64_BC_VPICKVE2GR_W:
+		case LA64_BC_VPICKVE2GR_D: {
+			// VPICKVE2GR.W rd, vj, ui2 / VPICKVE2GR.D rd, vj, ui1
+			auto fi = *(FasterLA64_RI8 *)&instruction_bits;
+			fi.rd = original.whole & 0x1F;
+			fi.rj = (original.whole >> 5) & 0x1F;
+			fi.imm = (original.whole >> 10) & (bytecode == LA64_BC_VPICKVE2GR_W ? 0x3 : 0x1);
+			NOP_IF_RD_ZERO(fi.rd, bytecode);
+			return fi.whole;
+		} break;
+		// LSX/LASX 3R bytecodes: vd, vj, vk
+#define LA64_VECTOR_BYTECODE(id, name, ...) case LA64_BC_##id:
+#include "vector_bytecodes.hpp"
+#undef LA64_VECTOR_BYTECODE
+		{
+			auto fi = *(FasterLA64_R3 *)&instruction_bits;
+			fi.rd = original.r3.rd;
+			fi.rj = original.r3.rj;
+			fi.rk = original.r3.rk;
+			return fi.whole;
+		} break;
 		case LA64_BC_FMADD_D: {
 			// FMADD.D fd, fj, fk, fa - 4R-type format
 			auto fi = *(FasterLA64_4R *)&instruction_bits;
@@ -600,6 +654,55 @@ uint32_t DecodedExecuteSegment::optimize_bytecode(uint8_t& bytecode, address_t p
 			fi.rk = original.r3.rk;
 			return fi.whole;
 		} break;
+		case LA64_BC_FLD_S:
+		case LA64_BC_FST_S: {
+			// FLD.S/FST.S fd, rj, si12 - uses RI12 format
+			auto fi = *(FasterLA64_RI12 *)&instruction_bits;
+			fi.rd = original.ri12.rd;
+			fi.rj = original.ri12.rj;
+			fi.set_imm(original.ri12.imm);
+			return fi.whole;
+		} break;
+		case LA64_BC_FADD_S:
+		case LA64_BC_FSUB_S:
+		case LA64_BC_FMUL_S:
+		case LA64_BC_FDIV_S: {
+			// FADD.S/FSUB.S/FMUL.S/FDIV.S fd, fj, fk - uses R3 format
+			auto fi = *(FasterLA64_R3 *)&instruction_bits;
+			fi.rd = original.r3.rd;
+			fi.rj = original.r3.rj;
+			fi.rk = original.r3.rk;
+			return fi.whole;
+		} break;
+		case LA64_BC_FMADD_S: {
+			// FMADD.S fd, fj, fk, fa - 4R-type format
+			auto fi = *(FasterLA64_4R *)&instruction_bits;
+			fi.rd = original.r4.rd;
+			fi.rj = original.r4.rj;
+			fi.rk = original.r4.rk;
+			fi.ra = original.r4.ra;
+			return fi.whole;
+		} break;
+		case LA64_BC_FMOV_S:
+		case LA64_BC_FMOV_D:
+		case LA64_BC_FCVT_S_D:
+		case LA64_BC_FCVT_D_S: {
+			// FMOV.S/FMOV.D/FCVT.S.D/FCVT.D.S fd, fj - uses R2 format
+			auto fi = *(FasterLA64_R2 *)&instruction_bits;
+			fi.rd = original.r2.rd;
+			fi.rj = original.r2.rj;
+			return fi.whole;
+		} break;
+		case LA64_BC_FCMP_COND_S:
+		case LA64_BC_FCMP_COND_D: {
+			// FCMP.cond.S/D cd, fj, fk
+			auto fi = *(FasterLA64_FCmp *)&instruction_bits;
+			fi.cd = original.whole & 0x7;
+			fi.fj = (original.whole >> 5) & 0x1F;
+			fi.fk = (original.whole >> 10) & 0x1F;
+			fi.cond = (original.whole >> 15) & 0x1F;
+			return fi.whole;
+		} break;
 		case LA64_BC_SRLI_W: {
 			// SRLI.W rd, rj, ui5 - uses Shift format
 			auto fi = *(FasterLA64_Shift *)&instruction_bits;
@@ -765,6 +868,9 @@ uint32_t DecodedExecuteSegment::optimize_bytecode(uint8_t& bytecode, address_t p
 			fi.rd = original.ri16.rd;
 			fi.rj = original.ri16.rj;
 			fi.offset = original.ri16.imm;
+			// jirl zero, ra, 0 is a function return
+			if (fi.rd == 0 && fi.rj == REG_RA && fi.offset == 0)
+				bytecode = LA64_BC_RET;
 			return fi.whole;
 		} break;
 		case LA64_BC_BEQZ:
@@ -801,4 +907,321 @@ uint32_t DecodedExecuteSegment::optimize_bytecode(uint8_t& bytecode, address_t p
 	return instruction_bits;
 }
 
+static uint8_t fused_bytecode(const DecoderData& first, const DecoderData& second)
+{
+	const uint32_t first_bits = first.instr;
+	const uint32_t second_bits = second.instr;
+
+	switch (first.get_bytecode()) {
+		case LA64_BC_SLT:
+		case LA64_BC_SLTU: {
+			const auto fi = *(const FasterLA64_R3 *)&first_bits;
+			const auto bi = *(const FasterLA64_RI21_Branch *)&second_bits;
+			// The branch must test the comparison result
+			if (bi.rj != fi.rd)
+				break;
+			const bool is_unsigned = first.get_bytecode() == LA64_BC_SLTU;
+			if (second.get_bytecode() == LA64_BC_BEQZ)
+				return is_unsigned ? LA64_BC_SLTU_BEQZ : LA64_BC_SLT_BEQZ;
+			if (second.get_bytecode() == LA64_BC_BNEZ)
+				return is_unsigned ? LA64_BC_SLTU_BNEZ : LA64_BC_SLT_BNEZ;
+		} break;
+		case LA64_BC_ADDI_D: {
+			const auto fi = *(const FasterLA64_RI12 *)&first_bits;
+			const auto li = *(const FasterLA64_RI12 *)&second_bits;
+			// Load from the freshly computed address
+			if (second.get_bytecode() == LA64_BC_LD_D && li.rj == fi.rd)
+				return LA64_BC_ADDI_D_LD_D;
+		} break;
+		case LA64_BC_ALSL_D: {
+			const auto fi = *(const FasterLA64_R3SA2 *)&first_bits;
+			const auto li = *(const FasterLA64_R3 *)&second_bits;
+			// Indexed load using the scaled index (or base)
+			if (second.get_bytecode() == LA64_BC_LDX_D && (li.rj == fi.rd || li.rk == fi.rd))
+				return LA64_BC_ALSL_D_LDX_D;
+		} break;
+		case LA64_BC_LD_D: {
+			const auto fi = *(const FasterLA64_RI12 *)&first_bits;
+			const auto li = *(const FasterLA64_RI12 *)&second_bits;
+			// Both loads use the same base, which the first load must not overwrite
+			if (second.get_bytecode() == LA64_BC_LD_D && li.rj == fi.rj && fi.rd != fi.rj)
+				return LA64_BC_LD_D_LD_D;
+		} break;
+		case LA64_BC_FCMP_COND_S:
+		case LA64_BC_FCMP_COND_D: {
+			const auto fi = *(const FasterLA64_FCmp *)&first_bits;
+			const auto bi = *(const FasterLA64_RI21_Branch *)&second_bits;
+			// The branch must test the condition flag that was just set
+			if (bi.rj != fi.cd)
+				break;
+			const bool is_double = first.get_bytecode() == LA64_BC_FCMP_COND_D;
+			if (second.get_bytecode() == LA64_BC_BCEQZ)
+				return is_double ? LA64_BC_FCMP_D_BCEQZ : LA64_BC_FCMP_S_BCEQZ;
+			if (second.get_bytecode() == LA64_BC_BCNEZ)
+				return is_double ? LA64_BC_FCMP_D_BCNEZ : LA64_BC_FCMP_S_BCNEZ;
+		} break;
+	}
+	return LA64_BC_INVALID;
+}
+
+// Evaluate a constant or address materialisation sequence at decode time.
+// Returns the number of instructions covered, or 0 if cache[i] is not a head.
+static unsigned fold_constant(const DecoderData* cache, size_t i, size_t size,
+	address_t pc, uint64_t& value, uint8_t& rd)
+{
+	const la_instruction head{cache[i].instr};
+	switch (cache[i].get_bytecode()) {
+		case LA64_BC_LU12I_W:
+			value = (saddress_t)(int32_t)(head.ri20.imm << 12);
+			break;
+		case LA64_BC_PCALAU12I:
+			value = (pc & ~address_t(0xFFF)) + (saddress_t)(int32_t)(head.ri20.imm << 12);
+			break;
+		case LA64_BC_PCADDU12I:
+			value = pc + (saddress_t(InstructionHelpers::sign_extend_20(head.ri20.imm)) << 12);
+			break;
+		default:
+			return 0;
+	}
+	rd = head.ri20.rd;
+	if (rd == 0)
+		return 0;
+
+	// Follow the instructions that modify rd in-place, within the same block
+	unsigned count = 1;
+	while (count < 4 && i + count < size && cache[i + count - 1].block_bytes != 0) {
+		const uint32_t bits = cache[i + count].instr;
+		const auto fi = *(const FasterLA64_RI12 *)&bits;
+		switch (cache[i + count].get_bytecode()) {
+			case LA64_BC_ORI:
+				if (fi.rd != rd || fi.rj != rd)
+					return count;
+				value |= uint16_t(fi.imm) & 0xFFF;
+				break;
+			case LA64_BC_ADDI_D:
+				if (fi.rd != rd || fi.rj != rd)
+					return count;
+				value += fi.imm;
+				break;
+			case LA64_BC_LU32I_D: {
+				const auto ui = *(const FasterLA64_RI20 *)&bits;
+				if (ui.rd != rd)
+					return count;
+				value = uint32_t(value) | (uint64_t(uint32_t(ui.get_imm())) << 32);
+			} break;
+			case LA64_BC_LU52I_D:
+				if (fi.rd != rd || fi.rj != rd)
+					return count;
+				value = (value & 0x000FFFFFFFFFFFFFull) | (uint64_t(uint16_t(fi.imm) & 0xFFF) << 52);
+				break;
+			default:
+				return count;
+		}
+		count++;
+	}
+	return count;
+}
+
+void DecodedExecuteSegment::fuse_bytecodes()
+{
+#ifdef LA_INSTRUCTION_PROFILING
+	// Every instruction must be dispatched on its own to be counted
+	return;
+#endif
+	DecoderData* cache = m_decoder_cache.cache;
+	const size_t size = m_decoder_cache.size;
+
+	// Constant and PC-relative address materialisation is folded into one
+	// bytecode, with the final value in a side table. The remaining
+	// instructions keep their entries, so they are still valid jump targets.
+	for (size_t i = 0; i < size; i++) {
+		uint64_t value;
+		uint8_t rd;
+		unsigned count = fold_constant(cache, i, size, m_exec_begin + i * 4, value, rd);
+		if (count == 0 || m_folded_constants.size() > UINT16_MAX)
+			continue;
+
+		uint8_t bytecode = LA64_BC_CONST;
+		if (count == 1) {
+			// A lone address may still be followed by a load through it
+			if (cache[i].block_bytes == 0 || i + 1 >= size
+				|| cache[i + 1].get_bytecode() != LA64_BC_LD_D)
+				continue;
+			const uint32_t bits = cache[i + 1].instr;
+			const auto li = *(const FasterLA64_RI12 *)&bits;
+			if (li.rj != rd)
+				continue;
+			bytecode = LA64_BC_CONST_LD_D;
+			count = 2;
+		}
+
+		FasterLA64_Constant fc;
+		fc.rd = rd;
+		fc.count = count;
+		fc.index = m_folded_constants.size();
+		m_folded_constants.push_back(value);
+		m_folded_heads.push_back(cache[i]);
+		cache[i].set_bytecode(bytecode);
+		cache[i].instr = fc.whole;
+	}
+
+	// sp-relative LD.D/ST.D next to each other become stack accesses, which
+	// validate sp once for the whole run (see LA64_BC_LD_D_SP). A lone one
+	// is cheaper with the regular checked access.
+	auto is_stack_access = [cache](size_t i) {
+		const uint8_t bytecode = cache[i].get_bytecode();
+		if (bytecode != LA64_BC_LD_D && bytecode != LA64_BC_ST_D
+			&& bytecode != LA64_BC_LD_D_SP && bytecode != LA64_BC_ST_D_SP)
+			return false;
+		const uint32_t bits = cache[i].instr;
+		const auto fi = *(const FasterLA64_RI12 *)&bits;
+		// A load into sp ends the run
+		return fi.rj == REG_SP && !(bytecode == LA64_BC_LD_D && fi.rd == REG_SP);
+	};
+	for (size_t i = 0; i < size; i++) {
+		if (!is_stack_access(i))
+			continue;
+		if ((i > 0 && is_stack_access(i - 1)) || (i + 1 < size && is_stack_access(i + 1))) {
+			const uint8_t bytecode = cache[i].get_bytecode();
+			const bool is_load = bytecode == LA64_BC_LD_D || bytecode == LA64_BC_LD_D_SP;
+			cache[i].set_bytecode(is_load ? LA64_BC_LD_D_SP : LA64_BC_ST_D_SP);
+		}
+	}
+
+	// Superinstructions: hot adjacent pairs within a block are fused into
+	// the first slot. The second slot keeps its original entry, so that
+	// jumps into the middle of a pair still work.
+	for (size_t i = 0; i + 1 < size; i++) {
+		// The first instruction of a pair must not end the block
+		if (cache[i].block_bytes == 0)
+			continue;
+		const uint8_t fused = fused_bytecode(cache[i], cache[i + 1]);
+		if (fused != LA64_BC_INVALID)
+			cache[i].set_bytecode(fused);
+	}
+}
+
+// The entry index a forward B/BL at index i branches to, or zero
+static size_t forward_branch_target(const DecoderData* cache, size_t size, size_t i)
+{
+	switch (cache[i].get_bytecode()) {
+		case LA64_BC_B:
+		case LA64_BC_BL:
+		case LA64_BC_B_CHAINED:
+		case LA64_BC_BL_CHAINED: {
+			const int32_t offset = (int32_t)cache[i].instr;
+			const size_t target = i + (offset >> DecoderCache::SHIFT);
+			return (offset > 0 && target < size) ? target : 0;
+		}
+		default:
+			return 0;
+	}
+}
+
+// A forward B/BL takes block_bytes from its target, so that the block
+// ending with it also counts the target block, and every entry before
+// it in the block grows with it. Returns true when block_bytes changed.
+static bool chain_entry(DecoderData* cache, size_t size, size_t i)
+{
+	// Bounds the block_bytes of the entries before a chained branch
+	static constexpr unsigned MAX_CHAINED_BYTES = 4096;
+	DecoderData& entry = cache[i];
+	const uint8_t bytecode = entry.get_bytecode();
+	uint8_t new_bytecode = bytecode;
+	uint16_t block_bytes;
+	switch (bytecode) {
+		case LA64_BC_B:
+		case LA64_BC_BL:
+		case LA64_BC_B_CHAINED:
+		case LA64_BC_BL_CHAINED: {
+			const bool link = (bytecode == LA64_BC_BL || bytecode == LA64_BC_BL_CHAINED);
+			const size_t target = forward_branch_target(cache, size, i);
+			if (target != 0 && cache[target].block_bytes + 4u <= MAX_CHAINED_BYTES) {
+				new_bytecode = link ? LA64_BC_BL_CHAINED : LA64_BC_B_CHAINED;
+				block_bytes = cache[target].block_bytes + 4;
+			} else {
+				new_bytecode = link ? LA64_BC_BL : LA64_BC_B;
+				block_bytes = 0;
+			}
+		} break;
+		default:
+			if (entry.block_bytes == 0)
+				return false; // Ends a block
+			block_bytes = cache[i + 1].block_bytes + 4;
+	}
+	// Only changed entries are written, other threads may be executing them
+	const bool changed = (entry.block_bytes != block_bytes);
+	if (changed)
+		entry.block_bytes = block_bytes;
+	if (new_bytecode != bytecode)
+		entry.set_bytecode(new_bytecode);
+	return changed;
+}
+
+void DecodedExecuteSegment::chain_blocks()
+{
+	DecoderData* cache = m_decoder_cache.cache;
+	const size_t size = m_decoder_cache.size;
+	m_chained_blocks = true;
+	m_chain_sources.clear();
+
+	// Scanning backwards, the targets have already been updated
+	for (size_t i = size; i-- > 0; ) {
+		chain_entry(cache, size, i);
+		if (const size_t target = forward_branch_target(cache, size, i))
+			m_chain_sources.emplace_back(uint32_t(target), uint32_t(i));
+	}
+	std::sort(m_chain_sources.begin(), m_chain_sources.end());
+}
+
+void DecodedExecuteSegment::rechain_blocks(size_t index)
+{
+	DecoderData* cache = m_decoder_cache.cache;
+	const size_t size = m_decoder_cache.size;
+	// A patched-in forward branch is found from its target from now on
+	if (const size_t target = forward_branch_target(cache, size, index)) {
+		const std::pair<uint32_t, uint32_t> source { uint32_t(target), uint32_t(index) };
+		auto it = std::lower_bound(m_chain_sources.begin(), m_chain_sources.end(), source);
+		if (it == m_chain_sources.end() || *it != source)
+			m_chain_sources.insert(it, source);
+	}
+
+	// Only the blocks that reach the patched entry are updated: the entries
+	// before it in its block, and the chained branches into any of them
+	std::vector<size_t> pending { index };
+	bool patched = true;
+	while (!pending.empty()) {
+		size_t i = pending.back();
+		pending.pop_back();
+		while (chain_entry(cache, size, i) || patched) {
+			patched = false;
+			auto range = std::equal_range(m_chain_sources.begin(), m_chain_sources.end(),
+				std::pair<uint32_t, uint32_t>(uint32_t(i), 0),
+				[](const auto& a, const auto& b) { return a.first < b.first; });
+			for (auto it = range.first; it != range.second; ++it)
+				pending.push_back(it->second);
+			if (i-- == 0)
+				break;
+		}
+	}
+}
+
+void DecodedExecuteSegment::unfuse_before(size_t index) noexcept
+{
+	DecoderData* cache = m_decoder_cache.cache;
+	// Folded constants cover up to 4 instructions
+	for (size_t k = 1; k <= 3 && k <= index; k++) {
+		auto& entry = cache[index - k];
+		const uint8_t bytecode = entry.get_bytecode();
+		if (bytecode == LA64_BC_CONST || bytecode == LA64_BC_CONST_LD_D) {
+			const uint32_t bits = entry.instr;
+			const auto fc = *(const FasterLA64_Constant *)&bits;
+			if (fc.count > k)
+				entry = m_folded_heads[fc.index];
+		} else if (k == 1) {
+			entry.set_bytecode(unfused_bytecode(bytecode));
+		}
+	}
+}
+
 } // loongarch
@@ -155,6 +155,7 @@ static struct CallbackTable {
 	int (*ctzl) (uint64_t);
 	int (*cpop) (uint32_t);
 	int (*cpopl) (uint64_t);
+	uintptr_t host_base;
 } api;
 
 // Memory arena access
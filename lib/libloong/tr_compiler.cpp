@@ -2,9 +2,18 @@
 #include "decoder_cache.hpp"
 #include "threaded_bytecodes.hpp"
 #include "tr_types.hpp"
+#include "util/crc32.hpp"
 #include <cstring>
 #include <atomic>
+#include <fstream>
+#include <iterator>
 #include <mutex>
+#include <thread>
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #ifdef ENABLE_LIBTCC
 #include <libtcc.h>
@@ -19,7 +28,11 @@ namespace loongarch
 {
 	// Forward declarations
 	void binary_translate(const Machine& machine, const MachineOptions& options,
-		DecodedExecuteSegment& exec, TransOutput& output);
+		DecodedExecuteSegment& exec, std::vector<TransOutput>& units, const std::string& cache_key,
+		const TransTiering* tiering = nullptr);
+	// The arena offset the generated code is specialized for, or 0 when
+	// the arena is out of reach of the CPU
+	intptr_t translation_cpu_relative_offset(const Machine& machine);
 
 #ifdef ENABLE_LIBTCC
 	void* libtcc_compile(const std::string& code, const std::unordered_map<std::string, std::string>& defines, const std::string& libtcc1)
@@ -107,10 +120,13 @@ namespace loongarch
 #else
 		(void)is_libtcc;
 #endif
-		// For non-libtcc, we would use dlsym here
+#ifndef _WIN32
+		return dlsym(dylib, name);
+#else
 		(void)dylib;
 		(void)name;
 		return nullptr;
+#endif
 	}
 
 	void dylib_close(void* dylib, bool is_libtcc)
@@ -123,8 +139,247 @@ namespace loongarch
 #else
 		(void)is_libtcc;
 #endif
-		// For non-libtcc, we would use dlclose here
+#ifndef _WIN32
+		dlclose(dylib);
+#else
 		(void)dylib;
+#endif
+	}
+
+	// Bump when the generated code changes in a way the cache key doesn't cover
+	static constexpr unsigned TRANSLATION_CACHE_VERSION = 2;
+
+	uintptr_t translation_host_base() noexcept
+	{
+		return reinterpret_cast<uintptr_t>(&translation_host_base);
+	}
+
+	static std::string system_compiler(const MachineOptions& options)
+	{
+		if (!options.translate_compiler.empty())
+			return options.translate_compiler;
+		const char* cc = getenv("CC");
+		return (cc != nullptr && cc[0] != 0) ? cc : "cc";
+	}
+
+	// CRC32-C of the program or library that contains libloong. Translated
+	// code calls into it at fixed offsets, so a rebuilt host needs new
+	// translations. Zero when it can't be read, which disables the cache.
+	static uint32_t host_object_checksum()
+	{
+#ifndef _WIN32
+		static const uint32_t checksum = [] {
+			Dl_info info;
+			std::ifstream file;
+			if (dladdr((void*)&translation_host_base, &info) != 0 && info.dli_fname != nullptr)
+				file.open(info.dli_fname, std::ios::binary);
+#ifdef __linux__
+			if (!file.is_open())
+				file.open("/proc/self/exe", std::ios::binary);
+#endif
+			const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+			return data.empty() ? 0u : util::crc32c(data.data(), data.size());
+		}();
+		return checksum;
+#else
+		return 0;
+#endif
+	}
+
+	// Everything the generated code depends on, apart from the instructions,
+	// which the segment CRC covers. Exported by cached shared objects as
+	// translation_key, and compared in full before they are used.
+	static std::string translation_cache_key(const Machine& machine, const MachineOptions& options,
+		const DecodedExecuteSegment& exec)
+	{
+		const std::string compiler = system_compiler(options) + " " + options.translate_compiler_flags;
+		char buffer[512];
+		snprintf(buffer, sizeof(buffer),
+			"v%u host=%08X crc=%08X exec=%lX-%lX entry=%lX arena=%lX ro=%lX data=%lX cpu=%ld mask=%u "
+			"opts=%d%d%d%d%d%d%d max=%zu,%zu cc=%08X",
+			TRANSLATION_CACHE_VERSION, host_object_checksum(), exec.crc32c_hash(),
+			(long)exec.exec_begin(), (long)exec.exec_end(), (long)machine.memory.start_address(),
+			(long)machine.memory.arena_size(), (long)machine.memory.rodata_start(),
+			(long)machine.memory.data_start(),
+			(long)translation_cpu_relative_offset(machine),
+			unsigned(LA_MASKED_MEMORY_BITS),
+			options.translate_trace, options.translate_ignore_instruction_limit,
+			options.translate_use_register_caching, options.translate_automatic_nbit_address_space,
+			options.translate_unchecked_memory_accesses, options.translate_verbose_fallbacks,
+			options.use_shared_execute_segments,
+			options.translate_blocks_max, options.translate_instr_max,
+			util::crc32c(compiler.data(), compiler.size()));
+		return buffer;
+	}
+
+	static std::string translation_cache_path(const MachineOptions& options, const DecodedExecuteSegment& exec,
+		const std::string& key, size_t unit)
+	{
+		char filename[64];
+		snprintf(filename, sizeof(filename), "/libloong-%08X-%08X-%zu.so",
+			exec.crc32c_hash(), util::crc32c(key.data(), key.size()), unit);
+		return options.translate_cache_dir + filename;
+	}
+
+	// Loads the shared objects of all translation units. Returns nothing on
+	// a miss, or when a cached object has another key.
+	static std::vector<void*> load_cached_translation(const MachineOptions& options,
+		const DecodedExecuteSegment& exec, const std::string& key)
+	{
+		std::vector<void*> dylibs;
+#ifndef _WIN32
+		// The first unit knows how many units there are
+		size_t units = 1;
+		for (size_t unit = 0; unit < units; unit++) {
+			const std::string path = translation_cache_path(options, exec, key, unit);
+			void* dylib = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+			const char* cached_key = dylib ? (const char*)dlsym(dylib, "translation_key") : nullptr;
+			const auto* cached_units = dylib ? (const uint32_t*)dlsym(dylib, "translation_units") : nullptr;
+			if (cached_key == nullptr || key != cached_key || cached_units == nullptr
+				|| (unit == 0 ? *cached_units == 0 : *cached_units != units)) {
+				if (dylib != nullptr)
+					dlclose(dylib);
+				for (void* loaded : dylibs)
+					dlclose(loaded);
+				return {};
+			}
+			units = *cached_units;
+			dylibs.push_back(dylib);
+		}
+#else
+		(void)options;
+		(void)exec;
+		(void)key;
+#endif
+		return dylibs;
+	}
+
+	// Compile the translation with the system C compiler into a shared object,
+	// and load it. The shared object must export the checksum of the source it
+	// was built from. Without a cache path the files are removed right away,
+	// as the loaded mapping stays valid until dlclose. Otherwise the shared
+	// object is renamed into the cache, which is atomic for other processes.
+	static void* system_compile(const std::string& code, uint32_t checksum, const MachineOptions& options,
+		const std::string& cache_path)
+	{
+#ifndef _WIN32
+		const char* tmpdir = getenv("TMPDIR");
+		std::string source = std::string(tmpdir ? tmpdir : "/tmp") + "/libloong-XXXXXX.c";
+		std::string shared = (cache_path.empty() ? std::string(tmpdir ? tmpdir : "/tmp") : options.translate_cache_dir)
+			+ "/libloong-XXXXXX.so";
+		if (!cache_path.empty())
+			mkdir(options.translate_cache_dir.c_str(), 0755);
+
+		const int source_fd = mkstemps(source.data(), 2);
+		if (source_fd < 0)
+			return nullptr;
+		close(source_fd);
+		const int shared_fd = mkstemps(shared.data(), 3);
+		if (shared_fd < 0) {
+			unlink(source.c_str());
+			return nullptr;
+		}
+		close(shared_fd);
+
+		std::ofstream ofs(source, std::ios::out | std::ios::trunc);
+		ofs << code;
+		ofs.close();
+
+		const std::string command = system_compiler(options) + " " + options.translate_compiler_flags
+			+ " -std=c99 -fPIC -shared -w"
+			+ " -DARCH=HOST_UNKNOWN"
+			+ " -DLA_SYSCALLS_MAX=" + std::to_string(LA_SYSCALLS_MAX)
+			+ " -DLA_MACHINE_ALIGNMENT=" + std::to_string(LA_MACHINE_ALIGNMENT)
+			+ " -o '" + shared + "' '" + source + "'";
+		if (options.verbose_loader) {
+			printf("libloong: %s\n", command.c_str());
+		}
+		const bool compiled = ofs.good() && system(command.c_str()) == 0;
+		unlink(source.c_str());
+
+		if (compiled && !cache_path.empty() && rename(shared.c_str(), cache_path.c_str()) == 0)
+			shared = cache_path;
+		void* dylib = compiled ? dlopen(shared.c_str(), RTLD_NOW | RTLD_LOCAL) : nullptr;
+		if (shared != cache_path)
+			unlink(shared.c_str());
+		if (dylib == nullptr) {
+			if (compiled && options.verbose_loader) {
+				fprintf(stderr, "libloong: dlopen failed: %s\n", dlerror());
+			}
+			return nullptr;
+		}
+
+		const auto* crc = (const uint32_t*)dlsym(dylib, "translation_crc");
+		if (crc == nullptr || *crc != checksum) {
+			if (options.verbose_loader) {
+				fprintf(stderr, "libloong: Translation checksum mismatch\n");
+			}
+			dlclose(dylib);
+			return nullptr;
+		}
+		return dylib;
+#else
+		(void)code;
+		(void)checksum;
+		(void)options;
+		(void)cache_path;
+		return nullptr;
+#endif
+	}
+
+	static void* compile_translation(const TransOutput& output, const MachineOptions& options, bool is_libtcc,
+		const std::string& cache_path)
+	{
+#ifdef ENABLE_LIBTCC
+		if (is_libtcc) {
+			// libtcc uses global state while compiling, even with separate TCCStates
+			static std::mutex libtcc_mutex;
+			std::lock_guard<std::mutex> lock(libtcc_mutex);
+			return libtcc_compile(*output.code, {}, "");
+		}
+#else
+		(void)is_libtcc;
+#endif
+		return system_compile(*output.code, output.checksum, options, cache_path);
+	}
+
+	// Compile the translation units with up to one thread per core. The units
+	// are independent programs, so the threads only share the next unit index.
+	// A unit that fails to compile has no shared object (nullptr).
+	static std::vector<void*> compile_translation_units(const std::vector<TransOutput>& units,
+		const MachineOptions& options, bool is_libtcc, const DecodedExecuteSegment& exec,
+		const std::string& cache_key)
+	{
+		std::vector<void*> dylibs(units.size(), nullptr);
+		std::atomic<size_t> next_unit = 0;
+		auto worker = [&] {
+			for (size_t unit = next_unit++; unit < units.size(); unit = next_unit++) {
+				try {
+					const std::string cache_path = cache_key.empty() ? std::string()
+						: translation_cache_path(options, exec, cache_key, unit);
+					dylibs[unit] = compile_translation(units[unit], options, is_libtcc, cache_path);
+				} catch (const std::exception& e) {
+					if (options.verbose_loader) {
+						fprintf(stderr, "libloong: Translation unit %zu failed: %s\n", unit, e.what());
+					}
+				}
+			}
+		};
+
+		const size_t nthreads = std::min<size_t>(units.size(), std::max(1u, std::thread::hardware_concurrency()));
+		std::vector<std::thread> threads;
+		threads.reserve(nthreads);
+		for (size_t i = 1; i < nthreads; i++) {
+			try {
+				threads.emplace_back(worker);
+			} catch (const std::system_error&) {
+				break; // The remaining units are compiled by the other threads
+			}
+		}
+		worker();
+		for (auto& thread : threads)
+			thread.join();
+		return dylibs;
 	}
 
 	// Mapping structure from dylib
@@ -156,9 +411,9 @@ namespace loongarch
 			uint64_t ic;
 			uint64_t max_ic;
 		};
-		static struct CallbackTable {
+		struct CallbackTable {
 			Machine::syscall_t** syscalls;
-			Machine::unknown_syscall_t* unknown_syscall;
+			void (*unknown_syscall)(CPU&, address_t);
 			DecoderData::handler_t* handlers;
 			int  (*syscall)(CPU&, unsigned, uint64_t, address_t);
 			ReturnValues (*exception) (CPU&, address_t, address_t, int);
@@ -173,62 +428,90 @@ namespace loongarch
 			int (*ctzl) (uint64_t);
 			int (*cpop) (uint32_t);
 			int (*cpopl) (uint64_t);
-		} callback_table;
-
-		callback_table.syscalls = Machine::get_syscall_handlers();
-		callback_table.unknown_syscall = Machine::get_unknown_syscall_handler();
-		callback_table.syscall = [](CPU& cpu, unsigned sysnum, uint64_t max_ic, address_t pc) -> int {
-			try {
+			uintptr_t host_base;
+		};
+		// Built once, as segments may be initialized in several threads at once
+		static const CallbackTable callback_table = [] {
+			CallbackTable table;
+
+			table.syscalls = Machine::get_syscall_handlers();
+			// The handler can be replaced at any time, so read it on each call
+			table.unknown_syscall = [](CPU& cpu, address_t sysnum) {
+				Machine::get_unknown_syscall_handler()(cpu.machine(), int(sysnum));
+			};
+			table.syscall = [](CPU& cpu, unsigned sysnum, uint64_t max_ic, address_t pc) -> int {
+				CPU::FaultTrapPause pause;
+				try {
+					cpu.registers().pc = pc;
+					cpu.machine().set_max_instructions(max_ic);
+					cpu.machine().system_call(sysnum);
+					return cpu.machine().stopped() || (cpu.pc() != pc);
+				} catch (...) {
+					cpu.machine().set_current_exception(std::current_exception());
+					cpu.machine().stop();
+					return -1; // Indicate error
+				}
+			};
+			table.handlers = DecoderData::get_handlers_array();
+			table.exception = [](CPU& cpu, address_t pc, address_t data, int type) -> ReturnValues {
 				cpu.registers().pc = pc;
-				cpu.machine().set_max_instructions(max_ic);
-				cpu.machine().system_call(sysnum);
-				return cpu.machine().stopped() || (cpu.pc() != pc);
-			} catch (...) {
-				cpu.machine().set_current_exception(std::current_exception());
+				const char* reason =
+					(type == ExceptionType::PROTECTION_FAULT) ? "Protection fault" : "Exception triggered";
+				if (CPU::FaultTrap* trap = cpu.machine().fault_trap()) {
+					// Reported by try_simulate(), without an exception
+					trap->fault = GuestFault{static_cast<ExceptionType>(type), data, pc, reason};
+				} else {
+					cpu.machine().set_current_exception(
+						std::make_exception_ptr(MachineException(static_cast<ExceptionType>(type), reason, data))
+					);
+				}
 				cpu.machine().stop();
-				return -1; // Indicate error
-			}
-		};
-		callback_table.handlers = DecoderData::get_handlers_array();
-		callback_table.exception = [](CPU& cpu, address_t pc, address_t data, int type) -> ReturnValues {
-			cpu.registers().pc = pc;
-			const char* reason =
-				(type == ExceptionType::PROTECTION_FAULT) ? "Protection fault" : "Exception triggered";
-			cpu.machine().set_current_exception(
-				std::make_exception_ptr(MachineException(static_cast<ExceptionType>(type), reason, data))
-			);
-			cpu.machine().stop();
-			return ReturnValues{ cpu.machine().instruction_counter(), 0u };
-		};
-		callback_table.trace = [](CPU& cpu, const char* desc, address_t pc, uint32_t instr) {
-			char buffer[256];
-			(void)cpu.decode(la_instruction{instr}).printer(buffer, sizeof(buffer), cpu, la_instruction{instr}, pc);
-			printf("[trace] PC=0x%lx: %s (0x%08x): %s\n", (unsigned long)pc, desc, instr, buffer);
-		};
-		callback_table.log = [](CPU& cpu, address_t pc, const char* msg) {
-			printf("[trace] PC=0x%lx (0x%lX) %s\n", (unsigned long)pc, (unsigned long)cpu.pc(), msg);
-		};
-		callback_table.fallback = [](CPU& cpu, address_t pc, uint32_t instr) {
-			auto decoded = cpu.decode(la_instruction{instr});
-			char buffer[256];
-			decoded.printer(buffer, sizeof(buffer), cpu, la_instruction{instr}, pc);
-			printf("[trace] PC=0x%lx: fallback 0x%08x: %s\n", (unsigned long)pc, instr, buffer);
-		};
-		callback_table.sqrtf32 = [](float x) { return __builtin_sqrtf(x); };
-		callback_table.sqrtf64 = [](double x) { return __builtin_sqrt(x); };
-		callback_table.clz = [](uint32_t x) { return __builtin_clz(x); };
-		callback_table.clzl = [](uint64_t x) { return __builtin_clzl(x); };
-		callback_table.ctz = [](uint32_t x) { return __builtin_ctz(x); };
-		callback_table.ctzl = [](uint64_t x) { return __builtin_ctzl(x); };
-		callback_table.cpop = [](uint32_t x) { return __builtin_popcount(x); };
-		callback_table.cpopl = [](uint64_t x) { return __builtin_popcountl(x); };
+				return ReturnValues{ cpu.machine().instruction_counter(), 0u };
+			};
+			table.trace = [](CPU& cpu, const char* desc, address_t pc, uint32_t instr) {
+				char buffer[256];
+				(void)cpu.decode(la_instruction{instr}).printer(buffer, sizeof(buffer), cpu, la_instruction{instr}, pc);
+				printf("[trace] PC=0x%lx: %s (0x%08x): %s\n", (unsigned long)pc, desc, instr, buffer);
+			};
+			table.log = [](CPU& cpu, address_t pc, const char* msg) {
+				printf("[trace] PC=0x%lx (0x%lX) %s\n", (unsigned long)pc, (unsigned long)cpu.pc(), msg);
+			};
+			table.fallback = [](CPU& cpu, address_t pc, uint32_t instr) {
+				auto decoded = cpu.decode(la_instruction{instr});
+				char buffer[256];
+				decoded.printer(buffer, sizeof(buffer), cpu, la_instruction{instr}, pc);
+				printf("[trace] PC=0x%lx: fallback 0x%08x: %s\n", (unsigned long)pc, instr, buffer);
+			};
+			table.sqrtf32 = [](float x) { return __builtin_sqrtf(x); };
+			table.sqrtf64 = [](double x) { return __builtin_sqrt(x); };
+			table.clz = [](uint32_t x) { return __builtin_clz(x); };
+			table.clzl = [](uint64_t x) { return __builtin_clzl(x); };
+			table.ctz = [](uint32_t x) { return __builtin_ctz(x); };
+			table.ctzl = [](uint64_t x) { return __builtin_ctzl(x); };
+			table.cpop = [](uint32_t x) { return __builtin_popcount(x); };
+			table.cpopl = [](uint64_t x) { return __builtin_popcountl(x); };
+			table.host_base = translation_host_base();
+			return table;
+		}();
 
 		// Initialize the translated segment
-		init_func(&callback_table, arena_info.arena_offset, arena_info.ic_offset);
+		init_func((void*)&callback_table, arena_info.arena_offset, arena_info.ic_offset);
 
 		return true;
 	}
 
+	// Decoder entries may be executing in other threads while they are
+	// patched, so they are replaced as a whole, never field by field. The
+	// release store publishes the handlers they refer to, see
+	// DecoderData::load_acquire().
+	static void replace_entry(DecoderData& entry, const DecoderData& data)
+	{
+		static_assert(sizeof(DecoderData) == sizeof(uint64_t));
+		uint64_t bits;
+		std::memcpy(&bits, &data, sizeof(bits));
+		__atomic_store_n(reinterpret_cast<uint64_t*>(&entry), bits, __ATOMIC_RELEASE);
+	}
+
 	// Apply live-patching: atomically swap decoder cache entries
 	static void apply_live_patch(const MachineOptions& options, DecodedExecuteSegment& exec,
 		const Mapping* mappings, unsigned nmappings)
@@ -243,11 +526,12 @@ namespace loongarch
 			const auto addr = mappings[i].addr;
 
 			if (exec.is_within(addr)) {
-				auto& entry = *exec.pc_relative_decoder_cache(addr);
-				/// XXX: Set the livepatch bytecode atomically
 				/// NOTE: handler_idx=0 means binary translation livepatch
-				entry.set_bytecode(LA64_BC_LIVEPATCH);
-				entry.handler_idx = 0;
+				DecoderData data = *exec.pc_relative_decoder_cache(addr);
+				data.set_bytecode(LA64_BC_LIVEPATCH);
+				data.handler_idx = 0;
+				// Overlays of a shared segment are patched as well
+				exec.live_patch(addr, data);
 			}
 		}
 
@@ -258,7 +542,8 @@ namespace loongarch
 
 	// Activate the dylib by mapping handlers to decoder cache
 	// live_patch=true will apply to patched decoder cache and use livepatch bytecode
-	void activate_dylib(MachineOptions options, DecodedExecuteSegment& exec, void* dylib,
+	// Returns false when the dylib had nothing to activate, and was closed.
+	bool activate_dylib(MachineOptions options, DecodedExecuteSegment& exec, void* dylib,
 		const ArenaInfo& arena_info, bool is_libtcc, bool live_patch = false)
 	{
 		// Map all the functions to instruction handlers
@@ -267,38 +552,41 @@ namespace loongarch
 		const uint32_t* no_handlers = (const uint32_t*)dylib_lookup(dylib, "no_handlers", is_libtcc);
 		const auto* handlers = (const bintr_block_func*)dylib_lookup(dylib, "unique_mappings", is_libtcc);
 
-		if (no_mappings == nullptr || mappings == nullptr || *no_mappings > 500000UL) {
+		if (no_mappings == nullptr || mappings == nullptr || *no_mappings > 500000UL
+			|| no_handlers == nullptr || handlers == nullptr) {
 			dylib_close(dylib, is_libtcc);
-			exec.set_libtcc(false);
 			throw MachineException(INVALID_PROGRAM, "Invalid mappings in binary translation program");
 		}
-		if (*no_mappings == 0)
-			return;
+		if (*no_mappings == 0) {
+			dylib_close(dylib, is_libtcc);
+			return false;
+		}
 
 		if (!initialize_translated_segment(exec, dylib, arena_info, is_libtcc))
 		{
-#ifdef ENABLE_LIBTCC
 			if (options.verbose_loader) {
 				fprintf(stderr, "libloong: Could not find dylib init function\n");
 			}
-#else
-			(void)options;
-#endif
 			if (dylib != nullptr) {
 				dylib_close(dylib, is_libtcc);
 			}
-			exec.set_libtcc(false);
-			return;
+			return false;
 		}
 
-		// Mark segment as binary translated
-		exec.set_libtcc(is_libtcc);
-
 		const unsigned nmappings = *no_mappings;
 		const unsigned unique_mappings = *no_handlers;
 
-		// Create N+1 mappings, where the last one is a catch-all for invalid mappings
-		exec.set_mappings_base_address((const char*)handlers[0]);
+		// Append the handlers to the handler table of the segment, where
+		// the handlers of earlier (tiered) translations stay in use
+		const long first_handler = exec.add_translator_handlers(handlers, unique_mappings);
+		if (first_handler < 0) {
+			dylib_close(dylib, is_libtcc);
+			throw MachineException(INVALID_PROGRAM, "Binary translation handler table is full");
+		}
+		// Mark segment as binary translated
+		exec.set_libtcc(is_libtcc);
+		// Store the dylib handle for cleanup, as its handlers are now in the table
+		exec.add_bintr_dylib(dylib);
 
 		// Debug: print the function pointers we're using
 		if (options.verbose_loader) {
@@ -332,17 +620,16 @@ namespace loongarch
 			const auto addr = mappings[i].addr;
 
 			if (exec.is_within(addr)) {
+				if (mapping_index >= unique_mappings) {
+					throw MachineException(INVALID_PROGRAM, "Invalid handler index in binary translation");
+				}
 				// Calculate the decoder entry for this address
 				auto* entry = target_decoder + (addr >> DecoderCache::SHIFT);
-				entry->set_bytecode(LA64_BC_TRANSLATOR);
-				const intptr_t diff =
-					(intptr_t)handlers[mapping_index] -
-					(intptr_t)exec.mappings_base_address();
-				if (diff < 0 || diff > UINT32_MAX) {
-					throw MachineException(INVALID_PROGRAM, "Invalid handler offset in binary translation");
-				}
-				entry->instr = (uint32_t)diff;
-				entry->handler_idx = 0xFF; // Invalid handler index
+				DecoderData data = *entry;
+				data.set_bytecode(LA64_BC_TRANSLATOR);
+				data.instr = uint32_t(first_handler + mapping_index);
+				data.handler_idx = 0xFF; // Invalid handler index
+				replace_entry(*entry, data);
 			} else if (options.verbose_loader) {
 				fprintf(stderr, "libloong: Mapping address 0x%lx outside execute area\n",
 					(unsigned long)addr);
@@ -354,14 +641,119 @@ namespace loongarch
 				live_patch ? "prepared for live-patching" : "activated",
 				nmappings, unique_mappings);
 		}
+		return true;
+	}
 
-		// Store the dylib handle for cleanup
-		if (live_patch) {
-			// For live-patching, we'll apply the patch after this function returns
-			// Don't store the dylib yet - caller will do it
+	static ArenaInfo arena_info_for(const Machine& machine)
+	{
+		// Prepare arena information for background compilation
+		ArenaInfo arena_info;
+		auto* arena_ptr = machine.memory.arena_ref();
+		arena_info.arena_ptr = (const uint8_t*)arena_ptr;
+		arena_info.arena_offset = reinterpret_cast<intptr_t>((intptr_t)arena_ptr - (intptr_t)&machine);
+		arena_info.ic_offset = Machine::counter_offset();
+		return arena_info;
+	}
+
+	// Entry points of a tiered round are only recorded once they are
+	// installed. Hot blocks of a round that failed may become hot again.
+	static void record_tiered_round(TransTiering& tiering, const std::vector<address_t>& activated,
+		const std::vector<address_t>& hot_blocks, bool failed)
+	{
+		std::lock_guard<std::mutex> lock(tiering.mutex);
+		tiering.translated.insert(activated.begin(), activated.end());
+		if (failed) {
+			for (const address_t pc : hot_blocks) {
+				if (tiering.translated.count(pc) == 0)
+					tiering.hot_blocks.erase(pc);
+			}
+		}
+	}
+
+	// Compile the translation units and activate them. With live-patching
+	// the compilation runs in the background when there is a background callback.
+	// hot_blocks are the blocks of a tiered translation round.
+	static void start_compilation(const MachineOptions& options, std::shared_ptr<DecodedExecuteSegment> exec,
+		std::vector<TransOutput>&& units, bool is_libtcc, const ArenaInfo& arena_info, const std::string& cache_key,
+		bool use_live_patch, std::vector<address_t> hot_blocks = {})
+	{
+		// Create the compilation step as a lambda
+		// Capture by value to ensure thread safety
+		auto compilation_step = [options, exec_ptr = exec, units = std::move(units), use_live_patch, is_libtcc, arena_info, cache_key,
+				hot_blocks = std::move(hot_blocks)]() mutable -> void {
+			// Compile with libtcc or the system compiler
+			std::vector<void*> dylibs;
+			bool failed = false;
+			try {
+				dylibs = compile_translation_units(units, options, is_libtcc, *exec_ptr, cache_key);
+			} catch (const std::exception& e) {
+				failed = true;
+				if (options.verbose_loader) {
+					fprintf(stderr, "libloong: Binary translation compilation failed: %s\n", e.what());
+				}
+			}
+			TransTiering* tiering = exec_ptr->tiering();
+			std::vector<address_t> activated;
+
+			// Activate the units that compiled, as they are independent
+			for (size_t unit = 0; unit < dylibs.size(); unit++) {
+				void* dylib = dylibs[unit];
+				if (dylib == nullptr) {
+					failed = true;
+					if (options.verbose_loader) {
+						fprintf(stderr, "libloong: %s compilation failed\n",
+							is_libtcc ? "libtcc" : "System compiler");
+					}
+					continue;
+				}
+				try {
+					// Activate the compiled code
+					if (!activate_dylib(options, *exec_ptr, dylib, arena_info, is_libtcc, use_live_patch)) {
+						failed = true;
+						continue;
+					}
+
+					const uint32_t* no_mappings = (const uint32_t*)dylib_lookup(dylib, "no_mappings", is_libtcc);
+					const auto* mappings = (const Mapping*)dylib_lookup(dylib, "mappings", is_libtcc);
+					if (no_mappings && mappings) {
+						if (use_live_patch) {
+							// Apply the live-patch
+							apply_live_patch(options, *exec_ptr, mappings, *no_mappings);
+						}
+						if (tiering != nullptr) {
+							for (uint32_t i = 0; i < *no_mappings; i++)
+								activated.push_back(mappings[i].addr);
+						}
+					}
+				} catch (const std::exception& e) {
+					failed = true;
+					if (options.verbose_loader) {
+						fprintf(stderr, "libloong: Binary translation compilation failed: %s\n", e.what());
+					}
+				}
+			}
+
+			if (tiering != nullptr)
+				record_tiered_round(*tiering, activated, hot_blocks, failed || dylibs.empty());
+
+			// Mark compilation as complete
+			if (use_live_patch) {
+				exec_ptr->set_background_compiling(false);
+			}
+		};
+
+		// Mark that we're compiling, before the compilation step has started
+		if (use_live_patch) {
+			exec->set_background_compiling(true);
+		}
+
+		// Execute the compilation step
+		if (use_live_patch && options.translate_background_callback != nullptr) {
+			// Call the user-provided background callback
+			options.translate_background_callback(compilation_step);
 		} else {
-			// For synchronous translation, store the dylib immediately
-			exec.set_bintr_dylib(dylib);
+			// Execute synchronously in the same thread
+			compilation_step();
 		}
 	}
 
@@ -372,109 +764,70 @@ namespace loongarch
 #ifdef LA_BINARY_TRANSLATION
 		if (!options.translate_enabled)
 			return false;
+		if (options.translate_hot_threshold != 0) {
+			// Tiered translation starts out interpreting, see translate_hot_block()
+			exec->enable_tiering(options);
+			return false;
+		}
 
-		TransOutput output;
+		std::vector<TransOutput> units;
 
 		try {
+			const bool is_libtcc = translate_with_libtcc(options);
+			const ArenaInfo arena_info = arena_info_for(machine);
+
+			// Cached shared objects skip code generation and compilation
+			std::string cache_key;
+			if (!is_libtcc && !options.translate_cache_dir.empty() && host_object_checksum() != 0) {
+				cache_key = translation_cache_key(machine, options, *exec);
+				std::vector<void*> dylibs = load_cached_translation(options, *exec, cache_key);
+				if (!dylibs.empty()) {
+					if (options.verbose_loader) {
+						printf("libloong: Using cached translation %s (%zu units)\n",
+							translation_cache_path(options, *exec, cache_key, 0).c_str(), dylibs.size());
+					}
+					for (size_t unit = 0; unit < dylibs.size(); unit++) {
+						try {
+							activate_dylib(options, *exec, dylibs[unit], arena_info, false);
+						} catch (...) {
+							// Not activated yet, so not owned by the segment
+							for (size_t next = unit + 1; next < dylibs.size(); next++)
+								dylib_close(dylibs[next], false);
+							throw;
+						}
+					}
+					return true;
+				}
+			}
+
 			// Generate C code for binary translation
-			binary_translate(machine, options, *exec, output);
+			binary_translate(machine, options, *exec, units, cache_key);
 
-			if (!output.code || output.code->empty()) {
+			size_t mappings = 0;
+			for (const auto& unit : units)
+				mappings += unit.mappings.size();
+			if (units.empty()) {
 				if (options.verbose_loader) {
 					fprintf(stderr, "libloong: Binary translation produced no code\n");
 				}
 				return false;
 			}
-			if (output.mappings.empty()) {
+			if (mappings == 0) {
 				if (options.verbose_loader) {
 					fprintf(stderr, "libloong: Binary translation produced no mappings\n");
 				}
 				return false;
 			}
 
-			// Append footer
-			*output.code += output.footer;
+			// Append footers
+			for (auto& unit : units)
+				*unit.code += unit.footer;
 
-#ifdef ENABLE_LIBTCC
 			// Determine if we should use live-patching
 			const bool use_live_patch = (options.translate_background_callback != nullptr);
 
-			// Prepare arena information for background compilation
-			ArenaInfo arena_info;
-			auto* arena_ptr = machine.memory.arena_ref();
-			arena_info.arena_ptr = (const uint8_t*)arena_ptr;
-			arena_info.arena_offset = reinterpret_cast<intptr_t>((intptr_t)arena_ptr - (intptr_t)&machine);
-			arena_info.ic_offset = Machine::counter_offset();
-
-			// Create the compilation step as a lambda
-			// Capture by value to ensure thread safety
-			auto compilation_step = [options, exec_ptr = exec, output = std::move(output), use_live_patch, arena_info]() mutable -> void {
-				// Protect libtcc_compile with a mutex
-				static std::mutex libtcc_mutex;
-				std::lock_guard<std::mutex> lock(libtcc_mutex);
-
-				// Mark that we're compiling in the background
-				if (use_live_patch) {
-					exec_ptr->set_background_compiling(true);
-				}
-
-				try {
-					// Compile with libtcc
-					void* dylib = libtcc_compile(*output.code, {}, "");
-					if (dylib == nullptr) {
-						if (options.verbose_loader) {
-							fprintf(stderr, "libloong: libtcc compilation failed\n");
-						}
-						if (use_live_patch) {
-							exec_ptr->set_background_compiling(false);
-						}
-						return;
-					}
-
-					// Activate the compiled code
-					activate_dylib(options, *exec_ptr, dylib, arena_info, true, use_live_patch);
-
-					if (use_live_patch) {
-						// Store the dylib handle
-						exec_ptr->set_bintr_dylib(dylib);
-						// Get mappings for live-patching
-						const uint32_t* no_mappings = (const uint32_t*)dylib_lookup(dylib, "no_mappings", true);
-						const auto* mappings = (const Mapping*)dylib_lookup(dylib, "mappings", true);
-
-						if (no_mappings && mappings) {
-							// Apply the live-patch
-							apply_live_patch(options, *exec_ptr, mappings, *no_mappings);
-						}
-
-						// Mark compilation as complete
-						exec_ptr->set_background_compiling(false);
-					}
-				} catch (const std::exception& e) {
-					if (options.verbose_loader) {
-						fprintf(stderr, "libloong: Binary translation compilation failed: %s\n", e.what());
-					}
-					if (use_live_patch) {
-						exec_ptr->set_background_compiling(false);
-					}
-				}
-			};
-
-			// Execute the compilation step
-			if (use_live_patch) {
-				// Call the user-provided background callback
-				options.translate_background_callback(compilation_step);
-			} else {
-				// Execute synchronously in the same thread
-				compilation_step();
-			}
-
+			start_compilation(options, exec, std::move(units), is_libtcc, arena_info, cache_key, use_live_patch);
 			return true;
-#else
-			if (options.verbose_loader) {
-				fprintf(stderr, "libloong: Binary translation enabled but libtcc not compiled in\n");
-			}
-			return false;
-#endif
 		} catch (const std::exception& e) {
 			if (options.verbose_loader) {
 				fprintf(stderr, "libloong: Binary translation failed: %s\n", e.what());
@@ -489,4 +842,64 @@ namespace loongarch
 #endif
 	}
 
+	void translate_hot_block(const Machine& machine, address_t pc)
+	{
+		std::shared_ptr<DecodedExecuteSegment> exec = machine.memory.exec_segment_for(pc);
+		// Overlays count their block entries into the base segment
+		if (exec->is_overlay())
+			exec = exec->overlay_base();
+		TransTiering* tiering = exec->tiering();
+		if (tiering == nullptr)
+			return;
+		// Another machine sharing the segment is translating it right now
+		std::unique_lock<std::mutex> lock(tiering->mutex, std::try_to_lock);
+		if (!lock.owns_lock())
+			return;
+
+		if (tiering->hot_blocks.insert(pc).second)
+			tiering->queue.push_back(pc);
+		// Blocks that become hot during a compilation wait for the next round
+		if (tiering->queue.empty() || exec->is_background_compiling())
+			return;
+
+		const MachineOptions& options = tiering->options;
+		try {
+			// Generate C code only for the code blocks with queued hot blocks
+			std::vector<TransOutput> units;
+			binary_translate(machine, options, *exec, units, {}, tiering);
+			size_t mappings = 0;
+			for (const auto& unit : units)
+				mappings += unit.mappings.size();
+			std::vector<address_t> round;
+			round.swap(tiering->queue);
+			if (mappings == 0)
+				return;
+
+			if (options.verbose_loader) {
+				printf("libloong: Tiered translation of %zu entry points\n", mappings);
+			}
+			// Append footers
+			for (auto& unit : units)
+				*unit.code += unit.footer;
+
+			// The compilation records the entry points it installs in
+			// tiering->translated, so it runs without the lock. Later rounds
+			// wait until it has completed.
+			exec->set_background_compiling(true);
+			lock.unlock();
+			// Always live-patched, as the segment is already executing
+			start_compilation(options, exec, std::move(units), translate_with_libtcc(options),
+				arena_info_for(machine), {}, true, std::move(round));
+		} catch (const std::exception& e) {
+			if (!lock.owns_lock()) {
+				exec->set_background_compiling(false);
+				lock.lock();
+			}
+			tiering->queue.clear();
+			if (options.verbose_loader) {
+				fprintf(stderr, "libloong: Tiered translation failed: %s\n", e.what());
+			}
+		}
+	}
+
 } // namespace loongarch
@@ -236,7 +236,8 @@ struct Emitter
 	}
 
 	std::string arena_offset(const std::string& offset) const {
-		if (tinfo.options.use_shared_execute_segments) {
+		// Cached translations are used by other processes, with other arenas
+		if (tinfo.options.use_shared_execute_segments || !tinfo.options.translate_cache_dir.empty()) {
 			if (tinfo.cpu_relative_offset != 0) {
 				// The arena is relative to the CPU pointer, which
 				// is faster than double indirection through ARENA_AT(cpu, ...)
@@ -292,7 +293,7 @@ struct Emitter
 		// to allow for accesses that slightly exceed the allocated size
 		add_code("  if ((" + addr + ") < " +
 			hex_address(tinfo.arena_datastart) + " || (" + addr + ") >= " +
-			hex_address(tinfo.arena_ptr + tinfo.arena_size) + ")");
+			hex_address(tinfo.arena_size) + ")");
 		add_code("    return api.exception(cpu, " + hex_address(pc()) + "ULL, " + addr + ", 2);");
 	}
 
@@ -421,8 +422,10 @@ struct Emitter
 		if (tinfo.options.translate_verbose_fallbacks) {
 			add_code("  api.fallback(cpu, " + hex_address(pc()) + "ULL, " + hex_address(instr_bits) + ");");
 		}
-		const uintptr_t handler_func = reinterpret_cast<uintptr_t>(instr.handler);
-		add_code("  ((handler_t)" + hex_address(handler_func) + ")(cpu, " + hex_address(instr_bits) + ");");
+		const intptr_t handler_offset =
+			reinterpret_cast<intptr_t>(instr.handler) - intptr_t(translation_host_base());
+		add_code("  ((handler_t)(api.host_base + (uintptr_t)" + std::to_string(handler_offset) + "LL))(cpu, "
+			+ hex_address(instr_bits) + ");");
 		// Reload cached registers after handler returns
 		if (!vr_only) {
 			reload_all_registers();
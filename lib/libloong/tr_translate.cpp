@@ -3,6 +3,7 @@
 #include "la_instr.hpp"
 #include "tr_api.hpp"
 #include "tr_types.hpp"
+#include "util/crc32.hpp"
 #include <algorithm>
 #include <unordered_set>
 #include <unordered_map>
@@ -126,11 +127,127 @@ namespace loongarch
 		return false;
 	}
 
+	// Tiered translation emits only the code blocks that contain queued
+	// hot blocks which have no translation yet
+	static bool has_queued_hot_block(const TransTiering& tiering, address_t begin, address_t end)
+	{
+		for (const address_t pc : tiering.queue) {
+			if (pc >= begin && pc < end && tiering.translated.count(pc) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	// Generate the C code, mapping tables and checksum of one translation unit,
+	// made of the code blocks [first, last)
+	static void emit_translation_unit(TransOutput& output, const std::vector<TransInfo>& blocks,
+		size_t first, size_t last, const std::string& cache_key, size_t unit_count)
+	{
+		output.code = std::make_shared<std::string>();
+		auto& code = *output.code;
+
+		// Add header with API inclusion
+		extern const std::string bintr_code;
+		code = bintr_code;
+
+		// Generate code for each block
+		for (size_t i = first; i < last; i++)
+		{
+			auto result = emit(code, blocks[i]);
+			for (auto& mapping : result) {
+				output.mappings.push_back(std::move(mapping));
+			}
+		}
+
+		// Generate footer for shared libraries
+		output.footer += "VISIBLE const uint32_t no_mappings = "
+			+ std::to_string(output.mappings.size()) + ";\n";
+		output.footer += R"V0G0N(
+struct Mapping {
+	addr_t   addr;
+	unsigned mapping_index;
+};
+VISIBLE const struct Mapping mappings[] = {
+)V0G0N";
+
+		std::unordered_map<std::string, unsigned> mapping_indices;
+		std::vector<const std::string*> handlers;
+		handlers.reserve(last - first);
+
+		for (const auto& mapping : output.mappings)
+		{
+			// Create map of unique mappings
+			unsigned mapping_index = 0;
+			auto it = mapping_indices.find(mapping.symbol);
+			if (it == mapping_indices.end()) {
+				mapping_index = handlers.size();
+				mapping_indices.emplace(mapping.symbol, mapping_index);
+				handlers.push_back(&mapping.symbol);
+			} else {
+				mapping_index = it->second;
+			}
+
+			char buffer[128];
+			snprintf(buffer, sizeof(buffer),
+				"{0x%lX, %u},\n",
+				(long)mapping.addr, mapping_index);
+			output.footer.append(buffer);
+		}
+
+		output.footer += "};\nVISIBLE const uint32_t no_handlers = "
+			+ std::to_string(mapping_indices.size()) + ";\n"
+			+ "VISIBLE const void* unique_mappings[] = {\n";
+
+		// Create array of unique mappings
+		for (auto* handler : handlers) {
+			output.footer += "    " + *handler + ",\n";
+		}
+		output.footer += "};\n";
+		output.footer += "VISIBLE const uint32_t translation_units = " + std::to_string(unit_count) + ";\n";
+		if (!cache_key.empty()) {
+			output.footer += "VISIBLE const char translation_key[] = \"" + cache_key + "\";\n";
+		}
+
+		// The checksum covers everything before it, and a shared object
+		// is only accepted when it exports the expected checksum
+		output.checksum = ~util::crc32c(util::crc32c(0xFFFFFFFF, code.data(), code.size()),
+			output.footer.data(), output.footer.size());
+		char checksum[64];
+		snprintf(checksum, sizeof(checksum),
+			"VISIBLE const uint32_t translation_crc = 0x%08X;\n", output.checksum);
+		output.footer += checksum;
+	}
+
+	// The first unit is written to the output file itself, unit N to
+	// file.N.c (or file.N without an extension)
+	static std::string translation_unit_filename(const std::string& filename, size_t unit)
+	{
+		if (unit == 0)
+			return filename;
+		const size_t slash = filename.find_last_of('/');
+		const size_t dot = filename.find_last_of('.');
+		if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+			return filename + "." + std::to_string(unit);
+		return filename.substr(0, dot) + "." + std::to_string(unit) + filename.substr(dot);
+	}
+
+	intptr_t translation_cpu_relative_offset(const Machine& machine)
+	{
+		// Calculate CPU-relative offset, and see if it's within a certain range
+		// an efficient range varies between architectures. Since memory
+		// ops also add their own offsets, we constrain to 64kB.
+		const intptr_t offset = (intptr_t)((uint8_t*)machine.memory.arena_ptr() - (uint8_t*)&machine);
+		if (offset < 0 || offset > 65536)
+			return 0;
+		return offset;
+	}
+
 	void binary_translate(const Machine& machine, const MachineOptions& options,
-		DecodedExecuteSegment& exec, TransOutput& output)
+		DecodedExecuteSegment& exec, std::vector<TransOutput>& units, const std::string& cache_key,
+		const TransTiering* tiering)
 	{
 		const bool verbose = options.verbose_loader;
-		const bool is_libtcc = true; // We always use libtcc for LoongArch
+		const bool is_libtcc = translate_with_libtcc(options);
 
 		const address_t basepc = exec.exec_begin();
 		const address_t endbasepc = exec.exec_end();
@@ -138,13 +255,7 @@ namespace loongarch
 		const address_t arena_size = machine.memory.arena_size();
 		const address_t arena_rostart = (address_t)machine.memory.rodata_start();
 		const address_t arena_datastart = (address_t)machine.memory.data_start();
-		// Calculate CPU-relative offset, and see if it's within a certain range
-		// an efficient range varies between architectures. Since memory
-		// ops also add their own offsets, we constrain to 64kB.
-		intptr_t cpu_relative_offset = (intptr_t)((uint8_t*)arena_ptr - (uint8_t*)&machine);
-		if (cpu_relative_offset < 0 || cpu_relative_offset > 65536) {
-			cpu_relative_offset = 0;
-		}
+		const intptr_t cpu_relative_offset = translation_cpu_relative_offset(machine);
 		if (verbose) {
 			printf("Starting binary translation of execute segment [%#lx - %#lx)\n",
 				(long)basepc, (long)endbasepc);
@@ -157,6 +268,9 @@ namespace loongarch
 
 		// Code block detection
 		const size_t ITS_TIME_TO_SPLIT = is_libtcc ? 5'000 : 1'250;
+		// Instructions per translation unit. libtcc compiles one unit at a
+		// time anyway, see libtcc_compile(), so it gets a single unit.
+		const size_t UNIT_SIZE = is_libtcc ? SIZE_MAX : 10'000;
 		size_t icounter = 0;
 		std::unordered_set<address_t> global_jump_locations;
 		std::vector<TransInfo> blocks;
@@ -167,6 +281,9 @@ namespace loongarch
 			global_jump_locations.insert(elf_entry);
 		// Speculate that the first instruction is a jump target
 		global_jump_locations.insert(exec.exec_begin());
+		// Hot blocks are entered by the interpreter, so they need entry points
+		if (tiering != nullptr)
+			global_jump_locations.insert(tiering->queue.begin(), tiering->queue.end());
 
 		// Scan through execute segment and create blocks
 		for (address_t pc = basepc; pc < endbasepc && icounter < options.translate_instr_max; )
@@ -257,6 +374,10 @@ namespace loongarch
 
 			// Process block and add it for emission
 			const size_t length = block_instructions.size();
+			if (tiering != nullptr && !has_queued_hot_block(*tiering, block, block_end)) {
+				pc = block_end;
+				continue;
+			}
 			if (length > 0 && icounter + length < options.translate_instr_max)
 			{
 				if (verbose_blocks()) {
@@ -300,90 +421,52 @@ namespace loongarch
 			pc = block_end;
 		}
 
-		// Code generation will be implemented in tr_emit.cpp
-		// For now, just set up the output structure
-		output.code = std::make_shared<std::string>();
-		auto& code = *output.code;
-
-		// Add header with API inclusion
-		extern const std::string bintr_code;
-		code = bintr_code;
+		// Group the code blocks into translation units, which are compiled
+		// separately (and in parallel) into one shared object each
+		std::vector<std::pair<size_t, size_t>> unit_ranges;
+		for (size_t first = 0; first < blocks.size(); ) {
+			size_t last = first;
+			size_t unit_insns = 0;
+			do {
+				unit_insns += blocks[last].instr.size();
+				last++;
+			} while (last < blocks.size() && unit_insns + blocks[last].instr.size() <= UNIT_SIZE);
+			unit_ranges.emplace_back(first, last);
+			first = last;
+		}
 
-		// Generate code for each block
 		for (auto& block : blocks)
-		{
 			block.blocks = &blocks;
-			auto result = emit(code, block);
-			for (auto& mapping : result) {
-				output.mappings.push_back(std::move(mapping));
-			}
-		}
-
-		// Write generated code to output file if specified
-		if (!options.translate_output_file.empty() && !code.empty()) {
-			std::ofstream ofs(options.translate_output_file, std::ios::out | std::ios::trunc);
-			if (ofs.is_open()) {
-				ofs << code;
-				ofs.close();
-				if (verbose) {
-					printf("libloong: Generated translation code written to %s\n",
-						options.translate_output_file.c_str());
+		units.resize(unit_ranges.size());
+		for (size_t i = 0; i < units.size(); i++) {
+			emit_translation_unit(units[i], blocks, unit_ranges[i].first, unit_ranges[i].second,
+				cache_key, unit_ranges.size());
+
+			// Write generated code to output file if specified
+			// Each unit is a complete program, which the system compiler can build
+			// into the same shared object as the AOT translation.
+			if (!options.translate_output_file.empty()) {
+				const std::string filename = translation_unit_filename(options.translate_output_file, i);
+				std::ofstream ofs(filename, std::ios::out | std::ios::trunc);
+				if (ofs.is_open()) {
+					ofs << *units[i].code << units[i].footer;
+					ofs.close();
+					if (verbose) {
+						printf("libloong: Generated translation code written to %s\n", filename.c_str());
+					}
+				} else {
+					fprintf(stderr, "libloong: Failed to write translation code to %s\n", filename.c_str());
 				}
-			} else {
-				fprintf(stderr, "libloong: Failed to write translation code to %s\n",
-					options.translate_output_file.c_str());
-			}
-		}
-
-		// Generate footer for shared libraries
-		output.footer += "VISIBLE const uint32_t no_mappings = "
-			+ std::to_string(output.mappings.size()) + ";\n";
-		output.footer += R"V0G0N(
-struct Mapping {
-	addr_t   addr;
-	unsigned mapping_index;
-};
-VISIBLE const struct Mapping mappings[] = {
-)V0G0N";
-
-		std::unordered_map<std::string, unsigned> mapping_indices;
-		std::vector<const std::string*> handlers;
-		handlers.reserve(blocks.size());
-
-		for (const auto& mapping : output.mappings)
-		{
-			// Create map of unique mappings
-			unsigned mapping_index = 0;
-			auto it = mapping_indices.find(mapping.symbol);
-			if (it == mapping_indices.end()) {
-				mapping_index = handlers.size();
-				mapping_indices.emplace(mapping.symbol, mapping_index);
-				handlers.push_back(&mapping.symbol);
-			} else {
-				mapping_index = it->second;
 			}
-
-			char buffer[128];
-			snprintf(buffer, sizeof(buffer),
-				"{0x%lX, %u},\n",
-				(long)mapping.addr, mapping_index);
-			output.footer.append(buffer);
-		}
-
-		output.footer += "};\nVISIBLE const uint32_t no_handlers = "
-			+ std::to_string(mapping_indices.size()) + ";\n"
-			+ "VISIBLE const void* unique_mappings[] = {\n";
-
-		// Create array of unique mappings
-		for (auto* handler : handlers) {
-			output.footer += "    " + *handler + ",\n";
 		}
-		output.footer += "};\n";
 
 		if (verbose) {
 			printf("libloong: Binary translation summary:\n");
 			printf("  - Translated %zu instructions across %zu blocks\n", icounter, blocks.size());
-			printf("  - Generated %zu function mappings\n", output.mappings.size());
+			size_t mappings = 0;
+			for (const auto& unit : units)
+				mappings += unit.mappings.size();
+			printf("  - Generated %zu function mappings in %zu translation units\n", mappings, units.size());
 			printf("  - Execute segment: 0x%lX - 0x%lX (%zu bytes)\n",
 				(long)basepc, (long)endbasepc, (size_t)(endbasepc - basepc));
 			printf("  - Global jump targets: %zu\n", global_jump_locations.size());
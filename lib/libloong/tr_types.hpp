@@ -4,6 +4,7 @@
 #include <unordered_set>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace loongarch
@@ -59,12 +60,46 @@ namespace loongarch
 		const address_t arena_size;      // Total arena size
 	};
 
-	// Output from translation process
+	// Output from translation process, one per translation unit
+	// Units are separate programs with their own mappings, so they can be
+	// compiled in parallel and activated one by one.
 	struct TransOutput {
 		std::unordered_map<std::string, std::string> defines;
 		std::shared_ptr<std::string> code;
 		std::string footer;
 		std::vector<TransMapping<>> mappings;
+		uint32_t checksum = 0; // CRC32-C of the source, also exported as translation_crc
 	};
 
+	// Tiered translation state of an execute segment, see
+	// MachineOptions::translate_hot_threshold
+	struct TransTiering {
+		TransTiering(const MachineOptions& opts) : options(opts) {}
+
+		const MachineOptions options; // Copied, shared segments outlive machines
+		std::mutex mutex;
+		std::unordered_set<address_t> hot_blocks; // Every block that became hot
+		std::vector<address_t> queue;             // Hot blocks not yet translated
+		std::unordered_set<address_t> translated; // Entry points of installed translations
+	};
+
+	// Called by the tiering dispatch when the block at pc becomes hot
+	void translate_hot_block(const Machine& machine, address_t pc);
+
+	// Translated code calls host functions relative to this address, so that
+	// a cached translation still works when the host is loaded elsewhere
+	uintptr_t translation_host_base() noexcept;
+
+	// libtcc compiles translations, unless the system compiler was
+	// requested, or libtcc is not compiled in
+	inline bool translate_with_libtcc(const MachineOptions& options) noexcept
+	{
+#ifdef ENABLE_LIBTCC
+		return !options.translate_use_system_compiler;
+#else
+		(void)options;
+		return false;
+#endif
+	}
+
 } // namespace loongarch
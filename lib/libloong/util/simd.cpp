@@ -0,0 +1,32 @@
+#include "simd.hpp"
+
+namespace loongarch {
+namespace util {
+
+SimdLevel host_simd_level() noexcept
+{
+#if LA_SIMD_X86
+	static const SimdLevel level = [] {
+		__builtin_cpu_init();
+		if (!__builtin_cpu_supports("ssse3") || !__builtin_cpu_supports("sse4.2"))
+			return SimdLevel::Scalar;
+		if (!__builtin_cpu_supports("avx2"))
+			return SimdLevel::SSE4;
+		return SimdLevel::AVX2;
+	}();
+	return level;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+void set_simd_level(SimdLevel level) noexcept
+{
+	const SimdLevel host = host_simd_level();
+	g_simd_level = (level > host) ? host : level;
+}
+
+SimdLevel g_simd_level = host_simd_level();
+
+} // namespace util
+} // namespace loongarch
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <libloong_settings.h>
+
+// Host SIMD for the LSX/LASX instruction handlers
+// Only x86-64 with GCC or Clang has vectorized handlers. Everywhere else
+// (and with LA_HOST_SIMD disabled) the portable lane-by-lane code is used.
+#if defined(LA_HOST_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#define LA_SIMD_X86 1
+#else
+#define LA_SIMD_X86 0
+#endif
+
+namespace loongarch {
+namespace util {
+
+enum class SimdLevel : uint8_t {
+	Scalar, // Portable lane-by-lane code
+	SSE4,   // SSSE3 and SSE4.2, 128-bit
+	AVX2,   // AVX2, 256-bit
+};
+
+// The best level supported by both the build and the host CPU
+SimdLevel host_simd_level() noexcept;
+
+// Select the level used by the vector handlers. Clamped to host_simd_level().
+// Defaults to the host level. Mainly useful for comparing against Scalar.
+void set_simd_level(SimdLevel level) noexcept;
+
+extern SimdLevel g_simd_level;
+inline SimdLevel simd_level() noexcept { return g_simd_level; }
+
+} // namespace util
+} // namespace loongarch
@@ -0,0 +1,125 @@
+#include "watchdog.hpp"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace loongarch {
+namespace util {
+
+namespace {
+	using clock = Watchdog::clock;
+	using Timer = Watchdog::Timer;
+
+	struct TimerThread
+	{
+		~TimerThread()
+		{
+			if (m_thread.joinable()) {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_quit = true;
+				}
+				m_cv.notify_one();
+				m_thread.join();
+			}
+		}
+
+		Timer arm(std::atomic<bool>& flag, std::chrono::nanoseconds budget)
+		{
+			bool wake = false;
+			Timer timer;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				timer = m_next_timer++;
+				const auto deadline = clock::now() + budget;
+				m_armed.emplace(timer, Armed{&flag, deadline});
+				m_deadlines.push({deadline, timer});
+				// Only wake the timer thread when it would sleep past the new deadline
+				wake = deadline < m_waiting_until;
+				if (!m_thread.joinable())
+					m_thread = std::thread([this] { this->run(); });
+			}
+			if (wake)
+				m_cv.notify_one();
+			return timer;
+		}
+
+		void disarm(Timer timer)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_armed.erase(timer);
+			// Disarmed deadlines stay in the heap until they are due, so
+			// rebuild it when short runs with long budgets pile them up
+			if (m_deadlines.size() > 2 * m_armed.size() + 64) {
+				Deadlines deadlines;
+				for (const auto& [id, armed] : m_armed)
+					deadlines.push({armed.deadline, id});
+				m_deadlines.swap(deadlines);
+			}
+		}
+
+	private:
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (!m_quit) {
+				if (m_deadlines.empty()) {
+					m_waiting_until = clock::time_point::max();
+					m_cv.wait(lock);
+					continue;
+				}
+				const auto [deadline, timer] = m_deadlines.top();
+				auto it = m_armed.find(timer);
+				if (it == m_armed.end()) {
+					m_deadlines.pop();
+				} else if (clock::now() >= deadline) {
+					it->second.flag->store(true, std::memory_order_relaxed);
+					m_armed.erase(it);
+					m_deadlines.pop();
+				} else {
+					m_waiting_until = deadline;
+					m_cv.wait_until(lock, deadline);
+				}
+			}
+		}
+
+		struct Armed {
+			std::atomic<bool>* flag;
+			clock::time_point deadline;
+		};
+		using Deadline = std::pair<clock::time_point, Timer>;
+		using Deadlines = std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>>;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		std::thread m_thread;
+		Deadlines m_deadlines;
+		std::unordered_map<Timer, Armed> m_armed;
+		Timer m_next_timer = 1;
+		clock::time_point m_waiting_until = clock::time_point::max();
+		bool m_quit = false;
+	};
+
+	TimerThread& timer_thread()
+	{
+		static TimerThread timers;
+		return timers;
+	}
+} // namespace
+
+Watchdog::Timer Watchdog::arm(std::atomic<bool>& flag, std::chrono::nanoseconds budget)
+{
+	return timer_thread().arm(flag, budget);
+}
+
+void Watchdog::disarm(Timer timer)
+{
+	timer_thread().disarm(timer);
+}
+
+} // namespace util
+} // namespace loongarch
@@ -0,0 +1,26 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace loongarch {
+namespace util {
+
+// Host-side timers that raise a stop flag once a wall-clock budget runs out
+// Used with CPU::simulate_watchdog, which polls Machine::stop_flag() at
+// backward branches and indirect jumps. All timers of the process share one
+// timer thread, which is started on the first arm() and sleeps until the
+// earliest deadline.
+struct Watchdog
+{
+	using clock = std::chrono::steady_clock;
+	using Timer = uint64_t;
+
+	// Set flag to true after budget, unless the timer is disarmed first
+	static Timer arm(std::atomic<bool>& flag, std::chrono::nanoseconds budget);
+	// After disarm() returns, the flag is no longer touched by the timer
+	static void disarm(Timer timer);
+};
+
+} // namespace util
+} // namespace loongarch
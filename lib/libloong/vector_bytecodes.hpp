@@ -0,0 +1,28 @@
+// LSX/LASX 3R bytecodes
+//
+// LA64_VECTOR_BYTECODE(InstrId, name, operation) becomes the bytecode
+// LA64_BC_<InstrId>, which runs operation(registers, vd, vj, vk) with the
+// register fields pre-extracted by the rewriter. The operations are the same
+// ones the InstrImpl handlers use (la_instr_simd.hpp), so both paths agree.
+// Vector instructions with immediates or four registers have hand-written
+// bytecodes instead (VORI.B, VREPLGR2VR, VPICKVE2GR, VSHUF.B, XVFMADD.D).
+//
+// The selection is measured: every 3R instruction that ran in laemu --profile
+// of the STREAM kernels and of a set of autovectorised integer, logic and FP
+// loops (LSX), ordered by its dynamic execution count in those profiles.
+// LASX builds of the same guests could not be profiled, as they need LASX
+// instructions that are not implemented (XVREPLGR2VR.D). Re-profile before
+// adding more; the bytecode space is shared with profiled_bytecodes.hpp.
+// This file is included several times, with different definitions of the macro.
+
+LA64_VECTOR_BYTECODE(VFMUL_D,   "VFMUL.D",   simd::lsx<simd::FMul<double>>) // 13276800
+LA64_VECTOR_BYTECODE(VADD_D,    "VADD.D",    simd::lsx<simd::Add<uint64_t>>) // 3277200
+LA64_VECTOR_BYTECODE(VXOR_V,    "VXOR.V",    simd::lsx<simd::Xor, false>) // 2662400
+LA64_VECTOR_BYTECODE(VOR_V,     "VOR.V",     simd::lsx<simd::Or>) // 1843200
+LA64_VECTOR_BYTECODE(VFDIV_D,   "VFDIV.D",   simd::lsx<simd::FDiv<double>>) // 1638400
+LA64_VECTOR_BYTECODE(VADD_W,    "VADD.W",    simd::lsx<simd::Add<uint32_t>>) // 1228800
+LA64_VECTOR_BYTECODE(VAND_V,    "VAND.V",    simd::lsx<simd::And>) // 819200
+LA64_VECTOR_BYTECODE(VMAX_W,    "VMAX.W",    simd::lsx<simd::Max<int32_t>, false>) // 819200
+LA64_VECTOR_BYTECODE(VMIN_W,    "VMIN.W",    simd::lsx<simd::Min<int32_t>, false>) // 819200
+LA64_VECTOR_BYTECODE(VMAX_BU,   "VMAX.BU",   simd::lsx<simd::Max<uint8_t>, false>) // 204800
+LA64_VECTOR_BYTECODE(VSUB_B,    "VSUB.B",    simd::lsx<simd::Sub<uint8_t>>) // 204800
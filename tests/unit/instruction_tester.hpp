@@ -22,6 +22,8 @@ public:
 		options.memory_max = memory_size;
 
 		m_machine = std::make_unique<Machine>(std::string_view{}, options);
+		// Needed to create execute segments (simulate_sequence)
+		m_machine->set_options(std::make_shared<MachineOptions>(options));
 		m_machine->set_max_instructions(1'000'000ull);
 		// 64KB rodata starts at 0x10000, writable data at 0x20000 to end of arena
 		m_machine->memory.allocate_custom_arena(memory_size, 0x10000, 0x20000);
@@ -133,6 +135,37 @@ public:
 		return result;
 	}
 
+	// Execute a sequence of instructions through the decoder cache
+	// (threaded dispatch). The sequence must end with a STOP instruction.
+	SequenceResult simulate_sequence(const std::vector<uint32_t>& instructions,
+	                                 uint64_t pc = 0x10000) {
+		SequenceResult result;
+
+		try {
+			const size_t length = instructions.size() * sizeof(uint32_t);
+			m_machine->memory.copy_into_arena_unsafe(pc, instructions.data(), length);
+			m_machine->cpu.init_execute_area(instructions.data(), pc, length);
+			m_machine->cpu.registers().pc = pc;
+
+			result.pc_before = pc;
+			uint64_t before_counter = m_machine->instruction_counter();
+			m_machine->simulate(1'000'000ull, before_counter);
+			result.instructions_executed = m_machine->instruction_counter() - before_counter;
+			result.pc_after = m_machine->cpu.pc();
+			result.success = true;
+
+		} catch (const MachineException& e) {
+			result.error = std::string("MachineException: ") + e.what() +
+			               " (type=" + std::to_string(static_cast<int>(e.type())) + ")";
+			result.pc_after = m_machine->cpu.pc();
+		} catch (const std::exception& e) {
+			result.error = std::string("Exception: ") + e.what();
+			result.pc_after = m_machine->cpu.pc();
+		}
+
+		return result;
+	}
+
 	// Allocate guest memory and return the guest address
 	uint64_t allocate_guest_memory(size_t size, size_t alignment = 32) {
 		// Align the current allocation address
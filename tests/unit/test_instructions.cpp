@@ -1,7 +1,12 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include "instruction_tester.hpp"
+#include <libloong/sample_profiler.hpp>
+#include <libloong/threaded_bytecodes.hpp>
+#include <libloong/util/simd.hpp>
 #include <cmath>
+#include <random>
+#include <thread>
 
 using namespace loongarch;
 using namespace loongarch::test;
@@ -346,6 +351,343 @@ TEST_CASE("vfcmp and xvfcmp - vector FP comparisons", "[instructions][vector][fc
 	}
 }
 
+TEST_CASE("Host SIMD matches the scalar reference", "[instructions][vector][simd]") {
+	using VectorReg = Registers::VectorReg256;
+	// The lane-by-lane handler each instruction had before la_instr_simd.hpp,
+	// applied to a copy of the register file so that aliasing behaves as it did.
+	using Legacy = void (*)(VectorReg& dst, const VectorReg& src1, const VectorReg& src2, const VectorReg& idx);
+	enum Kind { Int, F32, F64 };
+	struct VectorOp {
+		const char* name;
+		uint32_t opcode; // Bits 31:15 (bits 31:20 for VSHUF.B)
+		Kind kind;
+		Legacy legacy;
+	};
+	static const VectorOp ops[] = {
+		{"vadd.b", 0xE014, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.bu[i] = j.bu[i] + k.bu[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vadd.h", 0xE015, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.hu[i] = j.hu[i] + k.hu[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vadd.w", 0xE016, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.wu[i] = j.wu[i] + k.wu[i];
+			for (int i = 4; i < 8; i++) d.wu[i] = 0; }},
+		{"vadd.d", 0xE017, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = j.du[0] + k.du[0]; d.du[1] = j.du[1] + k.du[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vsub.b", 0xE018, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.bu[i] = j.bu[i] - k.bu[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vsub.h", 0xE019, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.hu[i] = j.hu[i] - k.hu[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vsub.w", 0xE01A, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.wu[i] = j.wu[i] - k.wu[i];
+			for (int i = 4; i < 8; i++) d.wu[i] = 0; }},
+		{"vsub.d", 0xE01B, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = j.du[0] - k.du[0]; d.du[1] = j.du[1] - k.du[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vmul.h", 0xE109, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.hu[i] = j.hu[i] * k.hu[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vmul.w", 0xE10A, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.wu[i] = j.wu[i] * k.wu[i];
+			for (int i = 4; i < 8; i++) d.wu[i] = 0; }},
+		// vmax/vmin never cleared the upper 128 bits
+		{"vmax.b", 0xE0E0, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.b[i] = (j.b[i] > k.b[i]) ? j.b[i] : k.b[i]; }},
+		{"vmax.h", 0xE0E1, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.h[i] = (j.h[i] > k.h[i]) ? j.h[i] : k.h[i]; }},
+		{"vmax.w", 0xE0E2, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.w[i] = (j.w[i] > k.w[i]) ? j.w[i] : k.w[i]; }},
+		{"vmax.d", 0xE0E3, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 2; i++) d.d[i] = (j.d[i] > k.d[i]) ? j.d[i] : k.d[i]; }},
+		{"vmin.b", 0xE0E4, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.b[i] = (j.b[i] < k.b[i]) ? j.b[i] : k.b[i]; }},
+		{"vmin.h", 0xE0E5, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.h[i] = (j.h[i] < k.h[i]) ? j.h[i] : k.h[i]; }},
+		{"vmin.w", 0xE0E6, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.w[i] = (j.w[i] < k.w[i]) ? j.w[i] : k.w[i]; }},
+		{"vmin.d", 0xE0E7, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 2; i++) d.d[i] = (j.d[i] < k.d[i]) ? j.d[i] : k.d[i]; }},
+		{"vmax.bu", 0xE0E8, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.bu[i] = (j.bu[i] > k.bu[i]) ? j.bu[i] : k.bu[i]; }},
+		{"vmax.hu", 0xE0E9, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.hu[i] = (j.hu[i] > k.hu[i]) ? j.hu[i] : k.hu[i]; }},
+		{"vmax.wu", 0xE0EA, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.wu[i] = (j.wu[i] > k.wu[i]) ? j.wu[i] : k.wu[i]; }},
+		{"vmax.du", 0xE0EB, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 2; i++) d.du[i] = (j.du[i] > k.du[i]) ? j.du[i] : k.du[i]; }},
+		{"vmin.bu", 0xE0EC, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.bu[i] = (j.bu[i] < k.bu[i]) ? j.bu[i] : k.bu[i]; }},
+		{"vmin.hu", 0xE0ED, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.hu[i] = (j.hu[i] < k.hu[i]) ? j.hu[i] : k.hu[i]; }},
+		{"vmin.wu", 0xE0EE, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.wu[i] = (j.wu[i] < k.wu[i]) ? j.wu[i] : k.wu[i]; }},
+		{"vmin.du", 0xE0EF, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 2; i++) d.du[i] = (j.du[i] < k.du[i]) ? j.du[i] : k.du[i]; }},
+		{"vseq.b", 0xE000, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.bu[i] = (j.bu[i] == k.bu[i]) ? 0xFF : 0x00;
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vslt.b", 0xE00C, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 16; i++) d.bu[i] = (j.b[i] < k.b[i]) ? 0xFF : 0x00;
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vslt.h", 0xE00D, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.hu[i] = (j.h[i] < k.h[i]) ? 0xFFFF : 0x0000;
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vslt.w", 0xE00E, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.wu[i] = (j.w[i] < k.w[i]) ? UINT32_MAX : 0u;
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vslt.d", 0xE00F, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 2; i++) d.du[i] = (j.d[i] < k.d[i]) ? UINT64_MAX : 0ULL;
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vand.v", 0xE24C, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = j.du[0] & k.du[0]; d.du[1] = j.du[1] & k.du[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vor.v", 0xE24D, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = j.du[0] | k.du[0]; d.du[1] = j.du[1] | k.du[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vxor.v", 0xE24E, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = j.du[0] ^ k.du[0]; d.du[1] = j.du[1] ^ k.du[1]; }},
+		{"vnor.v", 0xE24F, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = ~(j.du[0] | k.du[0]); d.du[1] = ~(j.du[1] | k.du[1]);
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vorn.v", 0xE251, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = j.du[0] | ~k.du[0]; d.du[1] = j.du[1] | ~k.du[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vilvl.b", 0xE234, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			uint8_t result[16];
+			for (int i = 0; i < 8; i++) { result[i * 2] = k.bu[i]; result[i * 2 + 1] = j.bu[i]; }
+			for (int i = 0; i < 16; i++) d.bu[i] = result[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vilvl.h", 0xE235, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			uint16_t result[8];
+			for (int i = 0; i < 4; i++) { result[i * 2] = k.hu[i]; result[i * 2 + 1] = j.hu[i]; }
+			for (int i = 0; i < 8; i++) d.hu[i] = result[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vilvl.w", 0xE236, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			uint32_t result[4];
+			for (int i = 0; i < 2; i++) { result[i * 2] = k.wu[i]; result[i * 2 + 1] = j.wu[i]; }
+			for (int i = 0; i < 4; i++) d.wu[i] = result[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vilvl.d", 0xE237, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			const auto src1_du = j.du[0], src2_du = k.du[0];
+			d.du[0] = src2_du; d.du[1] = src1_du;
+			d.du[2] = 0; d.du[3] = 0; }},
+		// Wrote vd before reading vj, so vd == vj is skipped below
+		{"vpickev.w", 0xE23E, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.wu[0] = k.wu[0]; d.wu[1] = k.wu[2]; d.wu[2] = j.wu[0]; d.wu[3] = j.wu[2];
+			for (int i = 4; i < 8; i++) d.wu[i] = 0; }},
+		{"vilvh.d", 0xE23F, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.du[0] = k.du[1]; d.du[1] = j.du[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vshuf.b", 0x0D5, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg& a) {
+			uint8_t combined[32];
+			for (int i = 0; i < 16; i++) { combined[i] = k.bu[i]; combined[i + 16] = j.bu[i]; }
+			for (int i = 0; i < 2; i++) {
+				uint64_t result = 0;
+				for (int b = 0; b < 8; b++)
+					result |= uint64_t(combined[(a.du[i] >> (b * 8)) & 0x1F]) << (b * 8);
+				d.du[i] = result;
+			} }},
+		{"vfadd.d", 0xE262, F64, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.df[0] = j.df[0] + k.df[0]; d.df[1] = j.df[1] + k.df[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vfmul.s", 0xE271, F32, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.f[i] = j.f[i] * k.f[i];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vfmul.d", 0xE272, F64, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.df[0] = j.df[0] * k.df[0]; d.df[1] = j.df[1] * k.df[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"vfdiv.d", 0xE276, F64, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			d.df[0] = j.df[0] / k.df[0]; d.df[1] = j.df[1] / k.df[1];
+			d.du[2] = 0; d.du[3] = 0; }},
+		{"xvseq.b", 0xEE00, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 32; i++) d.bu[i] = (j.bu[i] == k.bu[i]) ? 0xFF : 0x00; }},
+		{"xvxor.v", 0xEA4E, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.du[i] = j.du[i] ^ k.du[i]; }},
+		{"xvadd.d", 0xE817, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			int64_t r[4];
+			for (int i = 0; i < 4; i++) r[i] = j.d[i] + k.d[i];
+			for (int i = 0; i < 4; i++) d.d[i] = r[i]; }},
+		{"xvsub.w", 0xE81A, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 8; i++) d.w[i] = j.w[i] - k.w[i]; }},
+		{"xvmin.bu", 0xE8EC, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 32; i++) d.bu[i] = (j.bu[i] < k.bu[i]) ? j.bu[i] : k.bu[i]; }},
+		{"xvmax.bu", 0xE8E8, Int, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 32; i++) d.bu[i] = (j.bu[i] > k.bu[i]) ? j.bu[i] : k.bu[i]; }},
+		{"xvfadd.d", 0xEA62, F64, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.df[i] = j.df[i] + k.df[i]; }},
+		{"xvfsub.d", 0xEA66, F64, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.df[i] = j.df[i] - k.df[i]; }},
+		{"xvfmul.d", 0xEA72, F64, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.df[i] = j.df[i] * k.df[i]; }},
+		{"xvfdiv.d", 0xEA76, F64, [](VectorReg& d, const VectorReg& j, const VectorReg& k, const VectorReg&) {
+			for (int i = 0; i < 4; i++) d.df[i] = j.df[i] / k.df[i]; }},
+	};
+	InstructionTester tester;
+	auto& regs = tester.machine().cpu.registers();
+	std::mt19937_64 rng(0x5EED);
+
+	// Random registers 0-3, with equal, extreme and nearly-equal elements mixed in.
+	// Non-finite values only go in register 1: when two different NaNs meet, which
+	// one propagates depends on operand order, which the host compiler may swap.
+	auto randomize = [&](Kind kind) {
+		for (int reg = 0; reg < 4; reg++) {
+			auto& vr = regs.getvr(reg);
+			for (int i = 0; i < 4; i++) {
+				switch (kind) {
+				case Int:
+					switch (rng() % 6) {
+					case 0: vr.du[i] = 0; break;
+					case 1: vr.du[i] = ~0ULL; break;
+					case 2: vr.du[i] = 0x8000000000000000ULL ^ (rng() & 0x0101010101010101ULL); break;
+					case 3: vr.du[i] = regs.getvr(0).du[i] ^ (rng() & rng() & rng()); break;
+					default: vr.du[i] = rng(); break;
+					}
+					break;
+				case F64:
+					vr.df[i] = double(int64_t(rng() % 2000001) - 1000000) / double(1 + rng() % 1000);
+					break;
+				case F32:
+					vr.f[i * 2] = float(int32_t(rng() % 20001) - 10000) / float(1 + rng() % 100);
+					vr.f[i * 2 + 1] = float(int32_t(rng() % 20001) - 10000) / float(1 + rng() % 100);
+					break;
+				}
+			}
+		}
+		if (kind != Int) {
+			auto& vr = regs.getvr(1);
+			const double specials[] = { NAN, INFINITY, -INFINITY, -0.0, 4.9e-324 };
+			const int lane = rng() % 4;
+			if (kind == F64)
+				vr.df[lane] = specials[rng() % 5];
+			else
+				vr.f[lane * 2 + rng() % 2] = float(specials[rng() % 5]);
+		}
+	};
+
+	const auto host = util::host_simd_level();
+	for (const auto& op : ops) {
+		for (int iteration = 0; iteration < 64; iteration++) {
+			randomize(op.kind);
+			const uint32_t vd = rng() % 4, vj = rng() % 4, vk = rng() % 4, va = rng() % 4;
+			const uint32_t instr = (op.opcode == 0x0D5)
+				? (op.opcode << 20) | (va << 15) | (vk << 10) | (vj << 5) | vd
+				: (op.opcode << 15) | (vk << 10) | (vj << 5) | vd;
+			std::array<VectorReg, 4> before, expected;
+			std::memcpy(before.data(), &regs.getvr(0), sizeof(before));
+
+			util::set_simd_level(util::SimdLevel::Scalar);
+			REQUIRE(tester.execute_one(instr).success);
+			std::memcpy(expected.data(), &regs.getvr(0), sizeof(expected));
+
+			if (!(op.opcode == 0xE23E && vd == vj)) {
+				std::array<VectorReg, 4> legacy = before;
+				op.legacy(legacy[vd], legacy[vj], legacy[vk], legacy[va]);
+				INFO(op.name << " vd=" << vd << " vj=" << vj << " vk=" << vk << " legacy");
+				REQUIRE(std::memcmp(expected.data(), legacy.data(), sizeof(expected)) == 0);
+			}
+
+			for (auto level = util::SimdLevel::SSE4; level <= host; level = util::SimdLevel(int(level) + 1)) {
+				std::memcpy(&regs.getvr(0), before.data(), sizeof(before));
+				util::set_simd_level(level);
+				REQUIRE(tester.execute_one(instr).success);
+				INFO(op.name << " vd=" << vd << " vj=" << vj << " vk=" << vk << " level=" << int(level));
+				REQUIRE(std::memcmp(expected.data(), &regs.getvr(0), sizeof(expected)) == 0);
+			}
+		}
+	}
+	util::set_simd_level(host);
+
+	// vpickev.w $vr0, $vr0, $vr1 picks from vr0 as it was before the write
+	for (int i = 0; i < 8; i++) {
+		regs.getvr(0).wu[i] = 0x100 + i;
+		regs.getvr(1).wu[i] = 0x200 + i;
+	}
+	REQUIRE(tester.execute_one((0xE23E << 15) | (1 << 10) | (0 << 5) | 0).success);
+	const uint32_t picked[8] = { 0x200, 0x202, 0x100, 0x102, 0, 0, 0, 0 };
+	REQUIRE(std::memcmp(regs.getvr(0).wu, picked, sizeof(picked)) == 0);
+}
+
+TEST_CASE("Vector bytecodes match the instruction handlers", "[instructions][vector]") {
+	enum Format { R3, R4, VORI, GR2VR, VE2GR_W, VE2GR_D };
+	struct VectorBytecode {
+		const char* name;
+		uint32_t opcode; // Instruction with all operand fields zero
+		Format format;
+		uint8_t bytecode;
+	};
+	static const VectorBytecode ops[] = {
+		{"vfmul.d", 0x71390000, R3, LA64_BC_VFMUL_D}, {"vadd.d", 0x700b8000, R3, LA64_BC_VADD_D},
+		{"vxor.v", 0x71270000, R3, LA64_BC_VXOR_V}, {"vor.v", 0x71268000, R3, LA64_BC_VOR_V},
+		{"vfdiv.d", 0x713b0000, R3, LA64_BC_VFDIV_D}, {"vadd.w", 0x700b0000, R3, LA64_BC_VADD_W},
+		{"vand.v", 0x71260000, R3, LA64_BC_VAND_V},
+		{"vmax.w", 0x70710000, R3, LA64_BC_VMAX_W}, {"vmin.w", 0x70730000, R3, LA64_BC_VMIN_W},
+		{"vmax.bu", 0x70740000, R3, LA64_BC_VMAX_BU}, {"vsub.b", 0x700c0000, R3, LA64_BC_VSUB_B},
+		{"vshuf.b", 0x0d500000, R4, LA64_BC_VSHUF_B}, {"xvfmadd.d", 0x0a200000, R4, LA64_BC_XVFMADD_D},
+		{"vori.b", 0x73d40000, VORI, LA64_BC_VORI_B},
+		{"vreplgr2vr.w", 0x729f0800, GR2VR, LA64_BC_VREPLGR2VR_W},
+		{"vreplgr2vr.d", 0x729f0c00, GR2VR, LA64_BC_VREPLGR2VR_D},
+		{"vpickve2gr.w", 0x72efe000, VE2GR_W, LA64_BC_VPICKVE2GR_W},
+		{"vpickve2gr.d", 0x72eff000, VE2GR_D, LA64_BC_VPICKVE2GR_D},
+	};
+	using VectorReg = Registers::VectorReg256;
+	InstructionTester tester;
+	auto& regs = tester.machine().cpu.registers();
+	std::mt19937_64 rng(0xB17E);
+
+	for (const auto& op : ops) {
+		for (int iteration = 0; iteration < 16; iteration++) {
+			// Vector registers 0-3 and general registers a0-a3
+			for (int reg = 0; reg < 4; reg++) {
+				for (int i = 0; i < 4; i++)
+					regs.getvr(reg).df[i] = double(int64_t(rng() % 2000001) - 1000000) / double(1 + rng() % 1000);
+				tester.set_reg(REG_A0 + reg, rng());
+			}
+			const uint32_t vd = rng() % 4, vj = rng() % 4, vk = rng() % 4, va = rng() % 4;
+			// GPR destinations include $zero
+			const uint32_t rd = (rng() % 4 == 0) ? 0 : REG_A0 + vd;
+			uint32_t instr = op.opcode;
+			switch (op.format) {
+			case R3:      instr |= (vk << 10) | (vj << 5) | vd; break;
+			case R4:      instr |= (va << 15) | (vk << 10) | (vj << 5) | vd; break;
+			case VORI:    instr |= uint32_t(rng() & 0xFF) << 10 | (vj << 5) | vd; break;
+			case GR2VR:   instr |= ((REG_A0 + vj) << 5) | vd; break;
+			case VE2GR_W: instr |= uint32_t(rng() & 0x3) << 10 | (vj << 5) | rd; break;
+			case VE2GR_D: instr |= uint32_t(rng() & 0x1) << 10 | (vj << 5) | rd; break;
+			}
+			std::array<VectorReg, 4> before, expected;
+			std::array<uint64_t, 32> gpr_before, gpr_expected;
+			std::memcpy(before.data(), &regs.getvr(0), sizeof(before));
+			for (int reg = 0; reg < 32; reg++)
+				gpr_before[reg] = tester.get_reg(reg);
+
+			// The instruction handler
+			REQUIRE(tester.execute_one(instr).success);
+			std::memcpy(expected.data(), &regs.getvr(0), sizeof(expected));
+			for (int reg = 0; reg < 32; reg++)
+				gpr_expected[reg] = tester.get_reg(reg);
+
+			// The bytecode
+			std::memcpy(&regs.getvr(0), before.data(), sizeof(before));
+			for (int reg = 1; reg < 32; reg++)
+				tester.set_reg(reg, gpr_before[reg]);
+			auto result = tester.simulate_sequence({ instr, 0x00150000 /* stop */ });
+			REQUIRE(result.success);
+			INFO(op.name << " instr=" << std::hex << instr);
+			auto& exec = tester.machine().cpu.current_execute_segment();
+			const bool discarded = (op.format == VE2GR_W || op.format == VE2GR_D) && rd == 0;
+			REQUIRE(exec.decoder_cache()[0].get_bytecode() == (discarded ? LA64_BC_NOP : op.bytecode));
+			REQUIRE(std::memcmp(expected.data(), &regs.getvr(0), sizeof(expected)) == 0);
+			for (int reg = 0; reg < 32; reg++)
+				if (reg != REG_SP)
+					REQUIRE(tester.get_reg(reg) == gpr_expected[reg]);
+		}
+	}
+}
+
 TEST_CASE("Complex instruction sequence from real code", "[instructions][complex]") {
 	InstructionTester tester;
 
@@ -496,3 +838,872 @@ TEST_CASE("Floating-point load, add, store sequence", "[instructions][float]") {
 		REQUIRE_THAT(stored_value, Catch::Matchers::WithinAbs(initial_value + fa1_after_vldi, 1e-5f));
 	}
 }
+
+TEST_CASE("Single-precision bytecodes", "[instructions][float]") {
+	InstructionTester tester;
+
+	auto guest_addr = tester.allocate_guest_memory(64, 8);
+	REQUIRE(guest_addr != 0);
+	tester.write<float>(guest_addr + 0, 1.5f);
+	tester.write<float>(guest_addr + 4, 2.0f);
+	tester.write<float>(guest_addr + 8, 3.0f);
+	tester.set_reg(REG_A0, guest_addr);
+
+	const std::vector<uint32_t> instructions = {
+		0x2b000080,  // fld.s    $fa0, $a0, 0
+		0x2b001081,  // fld.s    $fa1, $a0, 4
+		0x2b002082,  // fld.s    $fa2, $a0, 8
+		0x01008403,  // fadd.s   $fa3, $fa0, $fa1
+		0x01048864,  // fmul.s   $fa4, $fa3, $fa2
+		0x08100485,  // fmadd.s  $fa5, $fa4, $fa1, $fa0
+		0x01028ca6,  // fsub.s   $fa6, $fa5, $fa3
+		0x010688c7,  // fdiv.s   $fa7, $fa6, $fa2
+		0x011924e8,  // fcvt.d.s $ft0, $fa7
+		0x01191909,  // fcvt.s.d $ft1, $ft0
+		0x0114952a,  // fmov.s   $ft2, $ft1
+		0x2b40308a,  // fst.s    $ft2, $a0, 12
+		0x00150000,  // stop
+	};
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+
+	const float expected = (22.5f - 3.5f) / 3.0f;
+	REQUIRE(tester.get_freg32(REG_FA0 + 3) == 3.5f);
+	REQUIRE(tester.get_freg32(REG_FA0 + 4) == 10.5f);
+	REQUIRE(tester.get_freg32(REG_FA0 + 5) == 22.5f);
+	REQUIRE(tester.get_freg32(REG_FA0 + 7) == expected);
+	REQUIRE(tester.get_freg64(8) == double(expected));
+	REQUIRE(tester.read<float>(guest_addr + 12) == expected);
+
+	// None of them went through the generic handler
+	auto& exec = tester.machine().cpu.current_execute_segment();
+	for (size_t i = 0; i + 1 < instructions.size(); i++) {
+		const uint8_t bytecode = exec.decoder_cache()[i].get_bytecode();
+		REQUIRE(bytecode != LA64_BC_FUNCTION);
+		REQUIRE(bytecode != LA64_BC_FUNCTION2);
+	}
+}
+
+#ifndef LA_INSTRUCTION_PROFILING // Profiling builds do not fuse bytecodes
+TEST_CASE("Superinstructions", "[instructions][fusion]") {
+	InstructionTester tester;
+
+	auto guest_addr = tester.allocate_guest_memory(64, 8);
+	REQUIRE(guest_addr != 0);
+	tester.write<uint64_t>(guest_addr + 0, 11);
+	tester.write<uint64_t>(guest_addr + 8, 22);
+	tester.write<uint64_t>(guest_addr + 16, 33);
+
+	SECTION("Compare and branch") {
+		const std::vector<uint32_t> instructions = {
+			0x0012948c,  // sltu     $t0, $a0, $a1
+			0x44000d80,  // bnez     $t0, 12
+			0x02c00406,  // addi.d   $a2, $zero, 1
+			0x00150000,  // stop
+			0x02c00806,  // addi.d   $a2, $zero, 2
+			0x00150000,  // stop
+		};
+		// Taken
+		tester.set_reg(REG_A0, 1);
+		tester.set_reg(REG_A1, 2);
+		auto r1 = tester.simulate_sequence(instructions);
+		REQUIRE(r1.success);
+		REQUIRE(tester.get_reg(REG_T0) == 1);
+		REQUIRE(tester.get_reg(REG_A2) == 2);
+		// Not taken
+		tester.set_reg(REG_A0, 3);
+		auto r2 = tester.simulate_sequence(instructions);
+		REQUIRE(r2.success);
+		REQUIRE(tester.get_reg(REG_T0) == 0);
+		REQUIRE(tester.get_reg(REG_A2) == 1);
+	}
+
+	SECTION("Signed compare and branch") {
+		const std::vector<uint32_t> instructions = {
+			0x0012148c,  // slt      $t0, $a0, $a1
+			0x40000d80,  // beqz     $t0, 12
+			0x02c00406,  // addi.d   $a2, $zero, 1
+			0x00150000,  // stop
+			0x02c00806,  // addi.d   $a2, $zero, 2
+			0x00150000,  // stop
+		};
+		tester.set_reg(REG_A0, uint64_t(-1));
+		tester.set_reg(REG_A1, 1);
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		REQUIRE(tester.get_reg(REG_T0) == 1);
+		REQUIRE(tester.get_reg(REG_A2) == 1);
+	}
+
+	SECTION("Address computation and load") {
+		const std::vector<uint32_t> instructions = {
+			0x02c02084,  // addi.d   $a0, $a0, 8
+			0x28c02086,  // ld.d     $a2, $a0, 8
+			0x002d10ac,  // alsl.d   $t0, $a1, $a0, 3
+			0x380c0187,  // ldx.d    $a3, $t0, $zero
+			0x00150000,  // stop
+		};
+		tester.set_reg(REG_A0, guest_addr);
+		tester.set_reg(REG_A1, 1);
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		REQUIRE(tester.get_reg(REG_A0) == guest_addr + 8);
+		REQUIRE(tester.get_reg(REG_A2) == 33);
+		REQUIRE(tester.get_reg(REG_T0) == guest_addr + 16);
+		REQUIRE(tester.get_reg(REG_A3) == 33);
+	}
+
+	SECTION("Floating-point compare and branch") {
+		const std::vector<uint32_t> instructions = {
+			0x0c110401,  // fcmp.clt.s $fcc1, $fa0, $fa1
+			0x48000d20,  // bcnez    $fcc1, 12
+			0x02c00406,  // addi.d   $a2, $zero, 1
+			0x00150000,  // stop
+			0x02c00806,  // addi.d   $a2, $zero, 2
+			0x00150000,  // stop
+		};
+		// Taken
+		tester.set_freg32(REG_FA0, 1.0f);
+		tester.set_freg32(REG_FA0 + 1, 2.0f);
+		auto r1 = tester.simulate_sequence(instructions);
+		REQUIRE(r1.success);
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[0].get_bytecode() == LA64_BC_FCMP_S_BCNEZ);
+		REQUIRE(tester.get_fcc(1) == 1);
+		REQUIRE(tester.get_reg(REG_A2) == 2);
+		// Unordered, not taken
+		tester.set_freg32(REG_FA0, NAN);
+		auto r2 = tester.simulate_sequence(instructions);
+		REQUIRE(r2.success);
+		REQUIRE(tester.get_fcc(1) == 0);
+		REQUIRE(tester.get_reg(REG_A2) == 1);
+	}
+
+	SECTION("Branch on another condition flag") {
+		const std::vector<uint32_t> instructions = {
+			0x0c210400,  // fcmp.clt.d $fcc0, $fa0, $fa1
+			0x48000c20,  // bceqz    $fcc1, 12
+			0x02c00406,  // addi.d   $a2, $zero, 1
+			0x00150000,  // stop
+			0x02c00806,  // addi.d   $a2, $zero, 2
+			0x00150000,  // stop
+		};
+		tester.set_freg64(REG_FA0, 1.0);
+		tester.set_freg64(REG_FA0 + 1, 2.0);
+		tester.set_fcc(1, 0);
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[0].get_bytecode() == LA64_BC_FCMP_COND_D);
+		REQUIRE(tester.get_fcc(0) == 1);
+		REQUIRE(tester.get_reg(REG_A2) == 2);
+	}
+
+	SECTION("Jump into the middle of a pair") {
+		const std::vector<uint32_t> instructions = {
+			0x50000800,  // b        8
+			0x28c02086,  // ld.d     $a2, $a0, 8
+			0x28c04087,  // ld.d     $a3, $a0, 16
+			0x00150000,  // stop
+		};
+		tester.set_reg(REG_A0, guest_addr);
+		tester.set_reg(REG_A2, 0x1234);
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		// The loads were fused, but only the second one was executed
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[1].get_bytecode() == LA64_BC_LD_D_LD_D);
+		REQUIRE(tester.get_reg(REG_A2) == 0x1234);
+		REQUIRE(tester.get_reg(REG_A3) == 33);
+	}
+}
+
+TEST_CASE("Chained branches", "[instructions][chaining]") {
+	InstructionTester tester;
+
+	const std::vector<uint32_t> instructions = {
+		0x02c00484,  // addi.d   $a0, $a0, 1
+		0x50000800,  // b        8
+		0x02c19084,  // addi.d   $a0, $a0, 100
+		0x02c00884,  // addi.d   $a0, $a0, 2
+		0x54000800,  // bl       8
+		0x00150000,  // stop
+		0x02c01084,  // addi.d   $a0, $a0, 4
+		0x00150000,  // stop
+	};
+	// The same instructions without the branches
+	const std::vector<uint32_t> straight = {
+		0x02c00484,  // addi.d   $a0, $a0, 1
+		0x03400000,  // nop
+		0x02c00884,  // addi.d   $a0, $a0, 2
+		0x03400000,  // nop
+		0x02c01084,  // addi.d   $a0, $a0, 4
+		0x00150000,  // stop
+	};
+	InstructionTester reference;
+	const auto expected = reference.simulate_sequence(straight);
+	REQUIRE(expected.success);
+
+	tester.set_reg(REG_A0, 0);
+	auto result = tester.simulate_sequence(instructions, 0x10000);
+	REQUIRE(result.success);
+	REQUIRE(tester.get_reg(REG_A0) == 7);
+	REQUIRE(tester.get_reg(REG_RA) == 0x10000 + 20);
+	// Instruction counting is exact across the chained blocks
+	REQUIRE(result.instructions_executed == expected.instructions_executed);
+
+	auto& exec = tester.machine().cpu.current_execute_segment();
+	REQUIRE(exec.decoder_cache()[1].get_bytecode() == LA64_BC_B_CHAINED);
+	REQUIRE(exec.decoder_cache()[4].get_bytecode() == LA64_BC_BL_CHAINED);
+
+	SECTION("Patching a chained block") {
+		// A system call that returns to RA, like the accelerated syscalls
+		struct RestoreHandler {
+			Machine::syscall_t* previous = Machine::get_syscall_handlers()[LA_SYSCALLS_MAX - 1];
+			~RestoreHandler() { Machine::install_syscall_handler(LA_SYSCALLS_MAX - 1, previous); }
+		} restore;
+		Machine::install_syscall_handler(LA_SYSCALLS_MAX - 1, [](Machine&) {});
+		DecoderData entry {};
+		entry.set_bytecode(LA64_BC_SYSCALLIMM);
+		entry.block_bytes = 0;
+		entry.instr = LA_SYSCALLS_MAX - 1;
+		exec.set(0x10000 + 24, entry);
+		// The chained blocks now end at the patched BL target
+		REQUIRE(exec.decoder_cache()[4].block_bytes == 4);
+		REQUIRE(exec.decoder_cache()[0].instruction_count() == 5);
+
+		tester.set_reg(REG_A0, 0);
+		tester.machine().cpu.registers().pc = 0x10000;
+		const uint64_t before = tester.machine().instruction_counter();
+		tester.machine().simulate(1'000'000ull, before);
+		REQUIRE(tester.get_reg(REG_A0) == 3);
+		// The chain, then the block returned to at RA
+		REQUIRE(tester.machine().instruction_counter() - before == 5 + exec.decoder_cache()[5].instruction_count());
+	}
+}
+
+TEST_CASE("Stack access runs", "[instructions][fusion]") {
+	InstructionTester tester;
+
+	const std::vector<uint32_t> instructions = {
+		0x29ffe064,  // st.d     $a0, $sp, -8
+		0x29ffc065,  // st.d     $a1, $sp, -16
+		0x28ffc066,  // ld.d     $a2, $sp, -16
+		0x28ffe067,  // ld.d     $a3, $sp, -8
+		0x00150000,  // stop
+	};
+	tester.set_reg(REG_A0, 0x1111);
+	tester.set_reg(REG_A1, 0x2222);
+
+	SECTION("Validated once") {
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		REQUIRE(tester.get_reg(REG_A2) == 0x2222);
+		REQUIRE(tester.get_reg(REG_A3) == 0x1111);
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[0].get_bytecode() == LA64_BC_ST_D_SP);
+		REQUIRE(exec.decoder_cache()[3].get_bytecode() == LA64_BC_LD_D_SP);
+	}
+
+	SECTION("sp at the end of the arena") {
+		// Too close to the end for the whole run to be validated
+		tester.set_reg(REG_SP, tester.machine().memory.arena_size() - 16);
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		REQUIRE(tester.get_reg(REG_A2) == 0x2222);
+		REQUIRE(tester.get_reg(REG_A3) == 0x1111);
+	}
+
+	SECTION("Jump into a run with an invalid sp") {
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		// The read-only area must not be written through the run
+		tester.set_reg(REG_SP, 0x10000 + 16);
+		tester.machine().cpu.registers().pc = 0x10000 + 4;
+		REQUIRE_THROWS_AS(tester.machine().simulate(1'000'000ull, 0), MachineException);
+		REQUIRE(tester.read<uint32_t>(0x10000) == instructions[0]);
+	}
+}
+
+TEST_CASE("Folded constants and addresses", "[instructions][fusion]") {
+	InstructionTester tester;
+
+	SECTION("64-bit constant") {
+		const std::vector<uint32_t> instructions = {
+			0x142468a4,  // lu12i.w  $a0, 0x12345
+			0x0399e084,  // ori      $a0, $a0, 0x678
+			0x17579bc4,  // lu32i.d  $a0, 0xabcde
+			0x03048c84,  // lu52i.d  $a0, $a0, 0x123
+			0x00150000,  // stop
+		};
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[0].get_bytecode() == LA64_BC_CONST);
+		REQUIRE(tester.get_reg(REG_A0) == 0x123abcde12345678ull);
+	}
+
+	SECTION("PC-relative addresses") {
+		const std::vector<uint32_t> instructions = {
+			0x1c000025,  // pcaddu12i $a1, 1
+			0x02ffe0a5,  // addi.d   $a1, $a1, -8
+			0x1a000006,  // pcalau12i $a2, 0
+			0x28c020c7,  // ld.d     $a3, $a2, 8
+			0x00150000,  // stop
+		};
+		auto result = tester.simulate_sequence(instructions, 0x10000);
+		REQUIRE(result.success);
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[0].get_bytecode() == LA64_BC_CONST);
+		REQUIRE(exec.decoder_cache()[2].get_bytecode() == LA64_BC_CONST_LD_D);
+		REQUIRE(tester.get_reg(REG_A1) == 0x10000 + 0x1000 - 8);
+		REQUIRE(tester.get_reg(REG_A2) == 0x10000);
+		REQUIRE(tester.get_reg(REG_A3) == tester.read<uint64_t>(0x10008));
+	}
+
+	SECTION("Jump into the tail of a sequence") {
+		const std::vector<uint32_t> instructions = {
+			0x50000800,  // b        8
+			0x142468a4,  // lu12i.w  $a0, 0x12345
+			0x0399e084,  // ori      $a0, $a0, 0x678
+			0x00150000,  // stop
+		};
+		tester.set_reg(REG_A0, 0x1000);
+		auto result = tester.simulate_sequence(instructions);
+		REQUIRE(result.success);
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[1].get_bytecode() == LA64_BC_CONST);
+		REQUIRE(tester.get_reg(REG_A0) == 0x1678);
+	}
+}
+#endif
+
+TEST_CASE("Return prediction", "[instructions][branches]") {
+	InstructionTester tester;
+
+	// main calls f, which saves RA and calls g
+	auto program = [](uint32_t g_body) -> std::vector<uint32_t> {
+		return {
+			0x54001800,  // bl       24 (f)
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x00150000,  // stop
+			0x03400000,  // nop
+			g_body,      // g:
+			0x4c000020,  // ret
+			0x0015040c,  // f: or    $t0, $zero, $ra
+			0x57fff7ff,  // bl       -12 (g)
+			0x02c190a5,  // addi.d   $a1, $a1, 100
+			0x00153001,  // or       $ra, $zero, $t0
+			0x02c004a5,  // addi.d   $a1, $a1, 1
+			0x4c000020,  // ret
+		};
+	};
+
+	SECTION("Nested calls") {
+		tester.set_reg(REG_A0, 0);
+		tester.set_reg(REG_A1, 0);
+		auto result = tester.simulate_sequence(program(0x02c028a5)); // addi.d $a1, $a1, 10
+		REQUIRE(result.success);
+		REQUIRE(tester.get_reg(REG_A0) == 1);
+		REQUIRE(tester.get_reg(REG_A1) == 111);
+		REQUIRE(tester.get_reg(REG_RA) == 0x10000 + 4);
+
+		auto& exec = tester.machine().cpu.current_execute_segment();
+		REQUIRE(exec.decoder_cache()[5].get_bytecode() == LA64_BC_RET);
+		REQUIRE(exec.decoder_cache()[11].get_bytecode() == LA64_BC_RET);
+
+		// Returning through the regular JIRL path counts the same
+		for (const size_t index : {5u, 11u}) {
+			DecoderData entry = exec.decoder_cache()[index];
+			entry.set_bytecode(LA64_BC_JIRL);
+			exec.set(0x10000 + index * 4, entry);
+		}
+		tester.set_reg(REG_A0, 0);
+		tester.set_reg(REG_A1, 0);
+		tester.machine().cpu.registers().pc = 0x10000;
+		const uint64_t before = tester.machine().instruction_counter();
+		tester.machine().simulate(1'000'000ull, before);
+		REQUIRE(tester.get_reg(REG_A1) == 111);
+		REQUIRE(tester.machine().instruction_counter() - before == result.instructions_executed);
+	}
+
+	SECTION("Mispredicted return") {
+		// g returns past the instruction after the call
+		tester.set_reg(REG_A0, 0);
+		tester.set_reg(REG_A1, 0);
+		auto result = tester.simulate_sequence(program(0x02c01021)); // addi.d $ra, $ra, 4
+		REQUIRE(result.success);
+		REQUIRE(tester.get_reg(REG_A0) == 1);
+		REQUIRE(tester.get_reg(REG_A1) == 1);
+		REQUIRE(tester.get_reg(REG_RA) == 0x10000 + 4);
+	}
+}
+
+TEST_CASE("Instruction profile", "[instructions][profiling]") {
+	InstructionTester tester;
+
+	const std::vector<uint32_t> instructions = {
+		0x02fffc84,  // addi.d   $a0, $a0, -1
+		0x47fffc9f,  // bnez     $a0, -4
+		0x00150000,  // stop
+	};
+	tester.set_reg(REG_A0, 10);
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	REQUIRE(tester.get_reg(REG_A0) == 0);
+
+	const auto profile = tester.machine().collect_instruction_profile();
+#ifdef LA_INSTRUCTION_PROFILING
+	auto count_of = [&](InstrId id) -> uint64_t {
+		for (const auto& entry : profile) {
+			if (entry.id == id)
+				return entry.count;
+		}
+		return 0;
+	};
+	REQUIRE(count_of(InstrId::ADDI_D) == 10);
+	REQUIRE(count_of(InstrId::BNEZ) == 10);
+#else
+	REQUIRE(profile.empty());
+#endif
+}
+
+TEST_CASE("Block profile", "[instructions][profiling]") {
+	InstructionTester tester;
+	tester.machine().set_block_profiling(true);
+
+	const std::vector<uint32_t> instructions = {
+		0x02fffc84,  // addi.d   $a0, $a0, -1
+		0x47fffc9f,  // bnez     $a0, -4
+		0x00150000,  // stop
+	};
+	tester.set_reg(REG_A0, 10);
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	REQUIRE(tester.get_reg(REG_A0) == 0);
+
+	// The loop block is entered 10 times, then falls through to stop once
+	const auto profile = tester.machine().collect_block_profile();
+	REQUIRE(profile.size() == 2);
+	REQUIRE(profile[0].count == 10);
+	REQUIRE(profile[0].instructions == 2);
+	REQUIRE(profile[1].pc == profile[0].pc + 8);
+	REQUIRE(profile[1].count == 1);
+
+	// Counts add up until they are reset
+	tester.set_reg(REG_A0, 10);
+	REQUIRE(tester.simulate_sequence(instructions).success);
+	REQUIRE(tester.machine().collect_block_profile()[0].count == 20);
+	tester.machine().reset_block_profile();
+	REQUIRE(tester.machine().collect_block_profile().empty());
+	tester.set_reg(REG_A0, 10);
+	REQUIRE(tester.simulate_sequence(instructions).success);
+	REQUIRE(tester.machine().collect_block_profile()[0].count == 10);
+}
+
+TEST_CASE("Dispatch tracer", "[instructions][profiling]") {
+	InstructionTester tester;
+	static std::vector<address_t> trace;
+	trace.clear();
+	tester.machine().set_dispatch_tracer([](Machine&, address_t pc) {
+		trace.push_back(pc);
+	});
+
+	const std::vector<uint32_t> instructions = {
+		0x02fffc84,  // addi.d   $a0, $a0, -1
+		0x47fffc9f,  // bnez     $a0, -4
+		0x00150000,  // stop
+	};
+	tester.set_reg(REG_A0, 3);
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	REQUIRE(tester.get_reg(REG_A0) == 0);
+	// Tracing does not change what is executed
+	InstructionTester reference;
+	reference.set_reg(REG_A0, 3);
+	REQUIRE(reference.simulate_sequence(instructions).instructions_executed == result.instructions_executed);
+
+	// Three entries into the loop, then the block with the stop
+	REQUIRE(trace.size() == 4);
+	REQUIRE(trace[0] == trace[1]);
+	REQUIRE(trace[1] == trace[2]);
+	REQUIRE(trace[3] == trace[0] + 8);
+
+	// Without a tracer, the regular dispatch is used again
+	tester.machine().set_dispatch_tracer(nullptr);
+	tester.set_reg(REG_A0, 3);
+	REQUIRE(tester.simulate_sequence(instructions).success);
+	REQUIRE(trace.size() == 4);
+}
+
+TEST_CASE("Chained blocks are profiled and traced", "[instructions][profiling]") {
+	InstructionTester tester;
+	static std::vector<address_t> trace;
+	trace.clear();
+	tester.machine().set_block_profiling(true);
+	tester.machine().set_dispatch_tracer([](Machine&, address_t pc) {
+		trace.push_back(pc);
+	});
+
+	const std::vector<uint32_t> instructions = {
+		0x02fffc84,  // addi.d   $a0, $a0, -1
+		0x50000800,  // b        8
+		0x02c19084,  // addi.d   $a0, $a0, 100
+		0x47fff49f,  // bnez     $a0, -12
+		0x00150000,  // stop
+	};
+	tester.set_reg(REG_A0, 3);
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	REQUIRE(tester.get_reg(REG_A0) == 0);
+	REQUIRE(tester.machine().cpu.current_execute_segment().decoder_cache()[1].get_bytecode() == LA64_BC_B_CHAINED);
+
+	// The forward branch enters the BNEZ block without leaving the dispatch
+	const std::vector<address_t> expected = {
+		0x10000, 0x1000c, 0x10000, 0x1000c, 0x10000, 0x1000c, 0x10010 };
+	REQUIRE(trace == expected);
+	tester.machine().set_dispatch_tracer(nullptr);
+
+	// The tracer takes precedence, so profile a second run on its own
+	tester.set_reg(REG_A0, 3);
+	result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	auto count_of = [&](address_t pc) -> uint64_t {
+		for (const auto& block : tester.machine().collect_block_profile()) {
+			if (block.pc == pc)
+				return block.count;
+		}
+		return 0;
+	};
+	REQUIRE(count_of(0x10000) == 3);
+	REQUIRE(count_of(0x1000c) == 3);
+	REQUIRE(count_of(0x10010) == 1);
+	// Chained blocks are counted where they are entered, not again with the branch
+	uint64_t profiled = 0;
+	for (const auto& block : tester.machine().collect_block_profile())
+		profiled += block.count * block.instructions;
+	REQUIRE(profiled == result.instructions_executed);
+}
+
+TEST_CASE("Sample profile", "[instructions][profiling]") {
+	InstructionTester tester;
+	SampleProfiler profiler(3);
+	tester.machine().set_sample_profiler(&profiler);
+
+	const std::vector<uint32_t> instructions = {
+		0x02fffc84,  // addi.d   $a0, $a0, -1
+		0x47fffc9f,  // bnez     $a0, -4
+		0x00150000,  // stop
+	};
+	tester.set_reg(REG_A0, 10);
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	REQUIRE(tester.get_reg(REG_A0) == 0);
+	// Slicing does not change what is executed
+	InstructionTester reference;
+	reference.set_reg(REG_A0, 10);
+	REQUIRE(reference.simulate_sequence(instructions).instructions_executed == result.instructions_executed);
+
+	// Slices end at the first taken branch after 3 instructions: the
+	// loop runs two iterations per sample, and the final one falls through
+	REQUIRE(profiler.samples() == 4);
+	const std::string folded = profiler.folded_stacks(tester.machine());
+	REQUIRE(folded == "0x10000 4\n");
+}
+
+TEST_CASE("Watchdog timeout", "[instructions][watchdog]") {
+	using namespace std::chrono_literals;
+	InstructionTester tester;
+	auto& machine = tester.machine();
+
+	auto load = [&](const std::vector<uint32_t>& instructions) {
+		const size_t length = instructions.size() * sizeof(uint32_t);
+		machine.memory.copy_into_arena_unsafe(0x10000, instructions.data(), length);
+		machine.cpu.init_execute_area(instructions.data(), 0x10000, length);
+		machine.cpu.registers().pc = 0x10000;
+	};
+
+	SECTION("Backward branch") {
+		load({
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x53ffffff,  // b        -4
+		});
+		tester.set_reg(REG_A0, 0);
+		REQUIRE(machine.simulate_for(20ms) == false);
+		// Stopped at the branch target, and can be resumed from there
+		REQUIRE(machine.cpu.pc() == 0x10000);
+		REQUIRE(tester.get_reg(REG_A0) > 0);
+		REQUIRE(machine.stop_flag() == false);
+		const uint64_t a0 = tester.get_reg(REG_A0);
+		REQUIRE(machine.simulate_for(5ms) == false);
+		REQUIRE(tester.get_reg(REG_A0) > a0);
+	}
+
+	SECTION("Indirect jump") {
+		load({
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x4c000180,  // jirl     $zero, $t0, 0
+		});
+		tester.set_reg(REG_A0, 0);
+		tester.set_reg(REG_T0, 0x10000);
+		REQUIRE(machine.simulate_for(20ms) == false);
+		REQUIRE(machine.cpu.pc() == 0x10000);
+		REQUIRE(tester.get_reg(REG_A0) > 0);
+	}
+
+	SECTION("Finishes within the budget") {
+		load({
+			0x02fffc84,  // addi.d   $a0, $a0, -1
+			0x47fffc9f,  // bnez     $a0, -4
+			0x00150000,  // stop
+		});
+		tester.set_reg(REG_A0, 1000);
+		REQUIRE(machine.simulate_for(10s) == true);
+		REQUIRE(tester.get_reg(REG_A0) == 0);
+	}
+
+	SECTION("Stop requested before the run") {
+		load({
+			0x00150000,  // stop
+		});
+		machine.request_stop();
+		REQUIRE(machine.simulate_for(10s) == false);
+		REQUIRE(machine.cpu.pc() == 0x10000);
+		REQUIRE(machine.stop_flag() == false);
+		REQUIRE(machine.simulate_for(10s) == true);
+	}
+
+	SECTION("Shorter budget while a longer one is armed") {
+		// Both timers are served by the same timer thread
+		InstructionTester other;
+		const std::vector<uint32_t> loop = {
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x53ffffff,  // b        -4
+		};
+		const size_t length = loop.size() * sizeof(uint32_t);
+		other.machine().memory.copy_into_arena_unsafe(0x10000, loop.data(), length);
+		other.machine().cpu.init_execute_area(loop.data(), 0x10000, length);
+		other.machine().cpu.registers().pc = 0x10000;
+		bool other_stopped = true;
+		std::thread thread([&] {
+			other_stopped = other.machine().simulate_for(1s);
+		});
+		load(loop);
+		const auto start = std::chrono::steady_clock::now();
+		REQUIRE(machine.simulate_for(5ms) == false);
+		REQUIRE(std::chrono::steady_clock::now() - start < 500ms);
+		thread.join();
+		REQUIRE(other_stopped == false);
+	}
+}
+
+TEST_CASE("Precise simulation", "[instructions][step]") {
+	InstructionTester tester;
+	auto& machine = tester.machine();
+
+	// Folded constant, a loop and a chained branch
+	const std::vector<uint32_t> instructions = {
+		0x142468a4,  // lu12i.w  $a0, 0x12345
+		0x0399e084,  // ori      $a0, $a0, 0x678
+		0x17579bc4,  // lu32i.d  $a0, 0xabcde
+		0x03048c84,  // lu52i.d  $a0, $a0, 0x123
+		0x02fffca5,  // addi.d   $a1, $a1, -1
+		0x47fffcbf,  // bnez     $a1, -4
+		0x50000800,  // b        8
+		0x02c19084,  // addi.d   $a0, $a0, 100
+		0x00150000,  // stop
+	};
+	tester.set_reg(REG_A1, 10);
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	REQUIRE(machine.cpu.current_execute_segment().decoder_cache()[0].get_bytecode() == LA64_BC_CONST);
+
+	auto run_precise = [&](uint64_t max_instructions) {
+		tester.set_reg(REG_A0, 0);
+		tester.set_reg(REG_A1, 10);
+		machine.cpu.registers().pc = 0x10000;
+		machine.set_instruction_counter(0);
+		machine.set_max_instructions(max_instructions);
+		machine.cpu.simulate_precise();
+	};
+
+	SECTION("Runs to completion") {
+		run_precise(1'000'000ull);
+		REQUIRE(tester.get_reg(REG_A0) == 0x123abcde12345678ull);
+		REQUIRE(tester.get_reg(REG_A1) == 0);
+		// Constant, ten loop iterations, the branch and STOP
+		REQUIRE(machine.instruction_counter() == 4 + 10 * 2 + 2);
+	}
+
+	SECTION("Stops at the exact instruction") {
+		// Through the folded constant and one loop iteration
+		run_precise(6);
+		REQUIRE(machine.instruction_counter() == 6);
+		REQUIRE(machine.cpu.pc() == 0x10010);
+		REQUIRE(tester.get_reg(REG_A0) == 0x123abcde12345678ull);
+		REQUIRE(tester.get_reg(REG_A1) == 9);
+		// Inside the folded constant
+		run_precise(2);
+		REQUIRE(machine.cpu.pc() == 0x10008);
+		REQUIRE(tester.get_reg(REG_A0) == 0x12345678);
+	}
+
+	SECTION("Single steps match") {
+		tester.set_reg(REG_A0, 0);
+		tester.set_reg(REG_A1, 2);
+		machine.cpu.registers().pc = 0x10000;
+		for (int i = 0; i < 6; i++)
+			machine.cpu.step_decoded();
+		REQUIRE(machine.cpu.pc() == 0x10010);
+		REQUIRE(tester.get_reg(REG_A1) == 1);
+	}
+}
+
+TEST_CASE("Precise simulation of superinstructions", "[instructions][step]") {
+	InstructionTester tester;
+	auto& machine = tester.machine();
+
+	// A stack run, and a fused SLT+BEQZ pair
+	const std::vector<uint32_t> instructions = {
+		0x29c02061,  // st.d     $ra, $sp, 8
+		0x29c00076,  // st.d     $fp, $sp, 0
+		0x28c02067,  // ld.d     $a3, $sp, 8
+		0x00121486,  // slt      $a2, $a0, $a1
+		0x400008c0,  // beqz     $a2, 8
+		0x02c00484,  // addi.d   $a0, $a0, 1
+		0x00150000,  // stop
+	};
+	auto result = tester.simulate_sequence(instructions);
+	REQUIRE(result.success);
+	const DecoderData* cache = machine.cpu.current_execute_segment().decoder_cache();
+	REQUIRE(cache[0].get_bytecode() == LA64_BC_ST_D_SP);
+	REQUIRE(cache[3].get_bytecode() == LA64_BC_SLT_BEQZ);
+
+	auto run_precise = [&](uint64_t max_instructions) {
+		tester.set_reg(REG_RA, 0x1234);
+		tester.set_reg(REG_A0, 5);
+		tester.set_reg(REG_A1, 3);
+		tester.set_reg(REG_A2, 1);
+		tester.set_reg(REG_A3, 0);
+		machine.cpu.registers().pc = 0x10000;
+		machine.set_instruction_counter(0);
+		machine.set_max_instructions(max_instructions);
+		machine.cpu.simulate_precise();
+	};
+
+	SECTION("Runs to completion") {
+		run_precise(1'000'000ull);
+		REQUIRE(machine.instruction_counter() == 6);
+		REQUIRE(tester.get_reg(REG_A0) == 5);
+		REQUIRE(tester.get_reg(REG_A3) == 0x1234);
+	}
+
+	SECTION("Stops inside the stack run") {
+		run_precise(2);
+		REQUIRE(machine.instruction_counter() == 2);
+		REQUIRE(machine.cpu.pc() == 0x10008);
+		REQUIRE(tester.get_reg(REG_A3) == 0);
+	}
+
+	SECTION("Stops inside the superinstruction") {
+		run_precise(4);
+		REQUIRE(machine.instruction_counter() == 4);
+		REQUIRE(machine.cpu.pc() == 0x10010);
+		REQUIRE(tester.get_reg(REG_A2) == 0);
+		REQUIRE(tester.get_reg(REG_A3) == 0x1234);
+	}
+
+	SECTION("Single steps") {
+		run_precise(0);
+		for (uint64_t pc : {0x10004, 0x10008, 0x1000c, 0x10010, 0x10018}) {
+			machine.cpu.step_decoded();
+			REQUIRE(machine.cpu.pc() == pc);
+		}
+		REQUIRE(machine.instruction_counter() == 5);
+		REQUIRE(tester.get_reg(REG_A0) == 5);
+	}
+}
+
+TEST_CASE("Guest faults without exceptions", "[instructions][faults]") {
+	InstructionTester tester;
+	auto& machine = tester.machine();
+
+	auto load = [&](const std::vector<uint32_t>& instructions) {
+		const size_t length = instructions.size() * sizeof(uint32_t);
+		machine.memory.copy_into_arena_unsafe(0x10000, instructions.data(), length);
+		machine.cpu.init_execute_area(instructions.data(), 0x10000, length);
+		machine.cpu.registers().pc = 0x10000;
+	};
+
+	SECTION("Protection fault") {
+		load({
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x28c00005,  // ld.d     $a1, $zero, 0
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x00150000,  // stop
+		});
+		tester.set_reg(REG_A0, 0);
+		const GuestFault fault = machine.try_simulate(1000);
+		REQUIRE(fault);
+		REQUIRE(fault.type == PROTECTION_FAULT);
+		REQUIRE(fault.data == 0);
+		REQUIRE(fault.pc == 0x10004);
+		REQUIRE(machine.cpu.pc() == 0x10004);
+		// The fault stopped execution at the faulting instruction
+		REQUIRE(tester.get_reg(REG_A0) == 1);
+		// The exception is still available on request
+		REQUIRE_THROWS_AS(fault.throw_if_fault(), MachineException);
+		// Regular simulate() throws as before
+		machine.cpu.registers().pc = 0x10000;
+		REQUIRE_THROWS_AS(machine.simulate(1000), MachineException);
+	}
+
+	SECTION("Fault in the second half of a superinstruction") {
+		load({
+			0x02c020a5,  // addi.d   $a1, $a1, 8
+			0x28c000a6,  // ld.d     $a2, $a1, 0
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x00150000,  // stop
+		});
+		REQUIRE(machine.cpu.current_execute_segment().decoder_cache()[0].get_bytecode() == LA64_BC_ADDI_D_LD_D);
+		tester.set_reg(REG_A1, -8);
+		const GuestFault fault = machine.try_simulate(1000);
+		REQUIRE(fault.type == PROTECTION_FAULT);
+		REQUIRE(fault.pc == 0x10004);
+		REQUIRE(tester.get_reg(REG_A1) == 0);
+	}
+
+	SECTION("Unimplemented system call") {
+		load({
+			0x002b0000,  // syscall  0
+			0x00150000,  // stop
+		});
+		tester.set_reg(REG_A7, 500);
+		const GuestFault fault = machine.try_simulate(1000);
+		REQUIRE(fault.type == UNIMPLEMENTED_SYSCALL);
+		REQUIRE(fault.data == 500);
+		REQUIRE(fault.pc == 0x10000);
+	}
+
+	SECTION("Instruction limit") {
+		load({
+			0x02c00484,  // addi.d   $a0, $a0, 1
+			0x53ffffff,  // b        -4
+		});
+		const GuestFault fault = machine.try_simulate(1000);
+		REQUIRE(fault.type == MACHINE_TIMEOUT);
+	}
+
+	SECTION("No fault") {
+		load({
+			0x02fffc84,  // addi.d   $a0, $a0, -1
+			0x47fffc9f,  // bnez     $a0, -4
+			0x00150000,  // stop
+		});
+		tester.set_reg(REG_A0, 10);
+		const GuestFault fault = machine.try_simulate(1000);
+		REQUIRE(!fault);
+		REQUIRE(tester.get_reg(REG_A0) == 0);
+		REQUIRE_NOTHROW(fault.throw_if_fault());
+	}
+}
@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include "codebuilder.hpp"
 #include "test_utils.hpp"
+#include <libloong/sample_profiler.hpp>
 
 using namespace loongarch;
 using namespace loongarch::test;
@@ -255,6 +256,52 @@ TEST_CASE("Symbol lookup", "[machine][symbols]") {
 	}
 }
 
+TEST_CASE("Sample profile of a call chain", "[machine][profiling]") {
+	CodeBuilder builder;
+	auto binary = builder.build(R"(
+		static void* stale_address;
+		__attribute__((noinline)) void remember() {
+			stale_address = __builtin_return_address(0);
+		}
+		__attribute__((noinline)) void decoy() {
+			remember();
+			__asm__ volatile ("" ::: "memory");
+		}
+		__attribute__((noinline)) long inner(long n) {
+			long sum = 0;
+			for (long i = 0; i < n; i++) {
+				sum += i * i;
+				__asm__ volatile ("" : "+r"(sum));
+			}
+			return sum;
+		}
+		// Leaves return addresses into decoy() in its frame, below
+		// the one that inner() returns to
+		__attribute__((noinline)) long outer(long n) {
+			volatile void* stale[4];
+			decoy();
+			for (int i = 0; i < 4; i++)
+				stale[i] = stale_address;
+			return inner(n) + (stale[0] != stale[3]);
+		}
+		int main() { return 0; }
+	)", "sample_call_chain");
+
+	TestMachine machine(binary);
+	machine.setup_linux();
+	machine.vmcall("main");
+
+	SampleProfiler profiler(10'000);
+	machine.machine().set_sample_profiler(&profiler);
+	machine.machine().vmcall<long, 100'000'000ull>(machine.address_of("outer"), 100'000l);
+	machine.machine().set_sample_profiler(nullptr);
+
+	// Neither the stale words nor the saved copy of RA are frames
+	REQUIRE(profiler.samples() > 10);
+	REQUIRE(profiler.folded_stacks(machine.machine()) ==
+		"outer;inner " + std::to_string(profiler.samples()) + "\n");
+}
+
 TEST_CASE("Machine state", "[machine][state]") {
 	CodeBuilder builder;
 
@@ -290,6 +337,65 @@ TEST_CASE("Machine state", "[machine][state]") {
 	}
 }
 
+TEST_CASE("Guest-generated code", "[machine][jit]") {
+	CodeBuilder builder;
+
+	SECTION("Execute code made executable with mprotect") {
+		auto binary = builder.build(R"(
+			#include <string.h>
+			#include <sys/mman.h>
+			typedef int (*func_t)(int);
+
+			static void emit(unsigned* code, int imm) {
+				code[0] = 0x02800084 | (imm << 10); // addi.w $a0, $a0, imm
+				code[1] = 0x4c000020;               // jirl $zero, $ra, 0
+			}
+
+			int main() {
+				unsigned* code = mmap(0, 4096, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				emit(code, 1);
+				mprotect(code, 4096, PROT_READ | PROT_EXEC);
+				int a = ((func_t)code)(40);
+
+				// Rewrite the code, which must invalidate the old decoding
+				mprotect(code, 4096, PROT_READ | PROT_WRITE);
+				emit(code, 2);
+				mprotect(code, 4096, PROT_READ | PROT_EXEC);
+				int b = ((func_t)code)(a);
+				return b;
+			}
+		)", "jit_mprotect");
+
+		TestMachine machine(binary);
+		machine.setup_linux();
+
+		auto result = machine.execute();
+		REQUIRE(result.success);
+		REQUIRE(result.exit_code == 43);
+	}
+
+	SECTION("Writable pages are not executable") {
+		auto binary = builder.build(R"(
+			#include <sys/mman.h>
+			typedef int (*func_t)(int);
+
+			int main() {
+				unsigned* code = mmap(0, 4096, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				code[0] = 0x4c000020; // jirl $zero, $ra, 0
+				return ((func_t)code)(0);
+			}
+		)", "jit_noexec");
+
+		TestMachine machine(binary);
+		machine.setup_linux();
+
+		auto result = machine.execute();
+		REQUIRE(!result.success);
+	}
+}
+
 TEST_CASE("Program counter", "[machine][pc]") {
 	CodeBuilder builder;
 
@@ -477,6 +583,34 @@ TEST_CASE("System call argument helpers", "[machine][syscall][sysargs]") {
 	}
 }
 
+TEST_CASE("Unknown system call handler", "[machine][syscall]") {
+	CodeBuilder builder;
+	auto binary = builder.build(R"(
+		long unknown_syscall() {
+			register long a0 __asm__("a0") = 0;
+			register long a7 __asm__("a7") = 600; // Past LA_SYSCALLS_MAX
+			__asm__ volatile ("syscall 0" : "+r"(a0) : "r"(a7) : "memory");
+			return a0;
+		}
+		int main() { return 0; }
+	)", "unknown_syscall");
+
+	TestMachine machine(binary);
+	machine.setup_linux();
+
+	// Replaced after the program has been translated, too
+	auto* original = Machine::get_unknown_syscall_handler();
+	Machine::set_unknown_syscall_handler([](Machine& m, int sysnum) {
+		m.set_result<long>(sysnum + 1);
+	});
+	REQUIRE(machine.machine().vmcall("unknown_syscall") == 601);
+	Machine::set_unknown_syscall_handler([](Machine& m, int sysnum) {
+		m.set_result<long>(sysnum + 2);
+	});
+	REQUIRE(machine.machine().vmcall("unknown_syscall") == 602);
+	Machine::set_unknown_syscall_handler(original);
+}
+
 TEST_CASE("Exception handling", "[machine][exceptions]") {
 	CodeBuilder builder;
 
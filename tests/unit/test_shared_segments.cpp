@@ -3,6 +3,7 @@
 #include <libloong/util/crc32.hpp>
 #include <libloong/shared_exec_segment.hpp>
 #include <libloong/machine.hpp>
+#include <libloong/threaded_bytecodes.hpp>
 #include <thread>
 #include <vector>
 #include <array>
@@ -120,6 +121,15 @@ TEST_CASE("Shared execute segments - basic", "[shared_segments]") {
 		size_t hash1 = hasher(key1);
 		size_t hash2 = hasher(key2);
 		REQUIRE(hash1 == hash2);
+
+		// All fields take part in equality and hashing
+		SegmentKey key3 = SegmentKey::from(0x1000, 0x12345678, 2 * 1024 * 1024);
+		REQUIRE(!(key1 == key3));
+		REQUIRE(hasher(key1) != hasher(key3));
+		// The old xor hash collided on these
+		SegmentKey key4 = SegmentKey::from(0x1001, 0x12345679, 1024 * 1024);
+		SegmentKey key5 = SegmentKey::from(0x1000, 0x12345678, 1024 * 1024);
+		REQUIRE(hasher(key4) != hasher(key5));
 	}
 
 	SECTION("Shared cache operations") {
@@ -135,29 +145,34 @@ TEST_CASE("Shared execute segments - basic", "[shared_segments]") {
 
 		SegmentKey key1 = SegmentKey::from(*seg1, 1024 * 1024);
 
-		// Add to cache
-		auto& entry = cache.get_segment(key1);
-		{
-			std::lock_guard<std::mutex> lock(entry.mutex);
-			entry.unlocked_set(seg1);
-		}
+		// Looking up a missing key doesn't insert it
+		REQUIRE(cache.get_segment(key1) == nullptr);
+		REQUIRE(cache.size() == 0);
 
+		// Add to cache
+		auto added = cache.get_or_create(key1, [&] { return seg1; });
+		REQUIRE(added == seg1);
 		REQUIRE(cache.size() == 1);
 
 		// Retrieve from cache
-		auto retrieved = entry.get();
+		auto entry = cache.get_segment(key1);
+		REQUIRE(entry != nullptr);
+		auto retrieved = entry->get();
 		REQUIRE(retrieved != nullptr);
 		REQUIRE(retrieved == seg1);
+		REQUIRE(cache.get_or_create(key1, [] { return nullptr; }) == seg1);
 
 		// Remove if unique
 		seg1.reset(); // Release our reference
+		added.reset();
 		retrieved.reset(); // Release the retrieved reference
+		entry.reset();
 		cache.remove_if_unique(key1);
 
-		// The entry should still exist in the map, but the segment should be null
-		auto& entry2 = cache.get_segment(key1);
-		auto retrieved2 = entry2.get();
-		REQUIRE(retrieved2 == nullptr);
+		// The evicted key is gone, and looking it up doesn't recreate it
+		REQUIRE(cache.size() == 0);
+		REQUIRE(cache.get_segment(key1) == nullptr);
+		REQUIRE(cache.size() == 0);
 
 		cache.clear();
 	}
@@ -189,22 +204,8 @@ TEST_CASE("Shared execute segments - multi-threaded", "[shared_segments][mt]") {
 
 				SegmentKey key = SegmentKey::from(*seg, options.memory_max);
 
-				// Try to add to cache
-				auto& entry = cache.get_segment(key);
-				std::shared_ptr<DecodedExecuteSegment> existing = entry.get();
-
-				if (existing) {
-					// Reuse existing
-					seg = existing;
-				} else {
-					// Add new
-					std::lock_guard<std::mutex> lock(entry.mutex);
-					if (entry.segment) {
-						seg = entry.segment;
-					} else {
-						entry.unlocked_set(seg);
-					}
-				}
+				// Add to cache, or reuse the existing segment
+				seg = cache.get_or_create(key, [&] { return seg; });
 
 				// Verify the segment
 				REQUIRE(seg != nullptr);
@@ -247,11 +248,7 @@ TEST_CASE("Shared execute segments - multi-threaded", "[shared_segments][mt]") {
 			seg->set_crc32c_hash(util::crc32c(&i, sizeof(i))); // Different CRCs
 
 			SegmentKey key = SegmentKey::from(*seg, options.memory_max);
-			auto& entry = cache.get_segment(key);
-			{
-				std::lock_guard<std::mutex> lock(entry.mutex);
-				entry.unlocked_set(seg);
-			}
+			REQUIRE(cache.get_or_create(key, [&] { return seg; }) == seg);
 			segments.push_back(seg);
 		}
 
@@ -313,17 +310,9 @@ TEST_CASE("Shared execute segments - stress test", "[shared_segments][mt][stress
 			SegmentKey key = SegmentKey::from(*seg, options.memory_max);
 
 			// Get or create
-			auto& entry = cache.get_segment(key);
-			std::shared_ptr<DecodedExecuteSegment> existing = entry.get();
-
-			if (!existing) {
-				std::lock_guard<std::mutex> lock(entry.mutex);
-				if (!entry.segment) {
-					entry.unlocked_set(seg);
-				}
-			}
-
-			operations++;
+			auto existing = cache.get_or_create(key, [&] { return seg; });
+			if (existing->crc32c_hash() == crc)
+				operations++;
 		}
 	};
 
@@ -346,3 +335,116 @@ TEST_CASE("Shared execute segments - stress test", "[shared_segments][mt][stress
 
 	cache.clear();
 }
+
+TEST_CASE("Shared execute segments - byte budget", "[shared_segments]") {
+	auto& cache = get_shared_execute_segments();
+	cache.clear();
+
+	const uint64_t arena_size = 1024 * 1024;
+	auto create = [&](address_t addr) {
+		return cache.get_or_create(SegmentKey::from(addr, 0x1234, arena_size), [addr] {
+			auto seg = std::make_shared<DecodedExecuteSegment>(addr, addr + 0x10);
+			seg->set_crc32c_hash(0x1234);
+			return seg;
+		});
+	};
+	const auto before = cache.stats();
+
+	SECTION("Unreferenced segments are released without a budget") {
+		auto seg = create(0x40000);
+		REQUIRE(cache.stats().misses == before.misses + 1);
+		seg.reset();
+		cache.remove_if_unique(SegmentKey::from(0x40000, 0x1234, arena_size));
+		REQUIRE(cache.stats().unreferenced_segments == 0);
+		REQUIRE(cache.stats().evictions == before.evictions + 1);
+		REQUIRE(cache.size() == 0);
+	}
+
+	SECTION("Unreferenced segments are retained in LRU order") {
+		const size_t seg_bytes = DecodedExecuteSegment(0, 0x10).memory_usage();
+		cache.set_byte_budget(2 * seg_bytes);
+
+		for (address_t addr : {0x50000, 0x51000, 0x52000}) {
+			auto seg = create(addr);
+			seg.reset();
+			cache.remove_if_unique(SegmentKey::from(addr, 0x1234, arena_size));
+		}
+		// The oldest segment was evicted to stay within the budget
+		auto stats = cache.stats();
+		REQUIRE(stats.unreferenced_segments == 2);
+		REQUIRE(stats.unreferenced_bytes == 2 * seg_bytes);
+		REQUIRE(stats.evictions == before.evictions + 1);
+
+		// Retained segments are hits, and are no longer unreferenced
+		auto seg = create(0x52000);
+		REQUIRE(cache.stats().hits == before.hits + 1);
+		REQUIRE(cache.stats().unreferenced_segments == 1);
+		create(0x50000);
+		REQUIRE(cache.stats().misses == before.misses + 4);
+
+		// Bytes are reported per live segment
+		auto usage = cache.segment_usage();
+		REQUIRE(usage.size() == 3);
+		for (auto& u : usage) {
+			REQUIRE(u.bytes == seg_bytes);
+		}
+
+		cache.set_byte_budget(0);
+		REQUIRE(cache.stats().unreferenced_segments == 0);
+	}
+
+	cache.clear();
+}
+
+TEST_CASE("Shared execute segments - copy-on-write overlays", "[shared_segments]") {
+	const address_t begin = 0x60000;
+	const size_t entries = 4096; // Several pages of decoder data
+	auto base = std::make_shared<DecodedExecuteSegment>(begin, begin + entries * 4);
+	base->set_shared(true);
+	auto* cache = base->allocate_decoder_cache(entries + 1, true);
+	for (size_t i = 0; i <= entries; i++) {
+		cache[i].bytecode = 0;
+		cache[i].handler_idx = 0;
+		cache[i].block_bytes = 0;
+		cache[i].instr = uint32_t(i);
+	}
+
+	auto overlay = DecodedExecuteSegment::create_overlay(base);
+	REQUIRE(overlay->is_overlay());
+	REQUIRE(overlay->overlay_base() == base);
+	REQUIRE(overlay->decoder_cache_size() == base->decoder_cache_size());
+	REQUIRE(overlay->crc32c_hash() == base->crc32c_hash());
+
+	DecoderData patch;
+	patch.bytecode = LA64_BC_SYSCALLIMM;
+	patch.handler_idx = 0;
+	patch.block_bytes = 0;
+	patch.instr = 1234;
+	overlay->set(begin + 100 * 4, patch);
+
+	// The patch is private to the overlay
+	REQUIRE(overlay->decoder_cache()[100].instr == 1234);
+	REQUIRE(base->decoder_cache()[100].instr == 100);
+	// Everything else is identical, including the end sentinel
+	for (size_t i = 0; i <= entries; i++) {
+		if (i != 100) {
+			REQUIRE(overlay->decoder_cache()[i].instr == uint32_t(i));
+		}
+	}
+#if defined(__linux__)
+	// The patched page is a private copy, the other pages follow the base
+	base->decoder_cache()[200].instr = 5678;
+	base->decoder_cache()[3000].instr = 5678;
+	REQUIRE(overlay->decoder_cache()[200].instr == 200);
+	REQUIRE(overlay->decoder_cache()[3000].instr == 5678);
+	base->decoder_cache()[200].instr = 200;
+	base->decoder_cache()[3000].instr = 3000;
+	// Only the copied page is counted for the overlay
+	REQUIRE(overlay->memory_usage() < base->memory_usage() / 2);
+#endif
+	// The overlay keeps the base alive
+	const auto* base_ptr = base.get();
+	base.reset();
+	REQUIRE(overlay->overlay_base().get() == base_ptr);
+	REQUIRE(overlay->overlay_base()->decoder_cache()[100].instr == 100);
+}
@@ -753,3 +753,88 @@ TEST_CASE("vmcall - mixed complex types", "[vmcall][mixed]") {
 		REQUIRE(result == 42);
 	}
 }
+
+TEST_CASE("vmcall - wall-clock timeout", "[vmcall][timeout]") {
+	using namespace std::chrono_literals;
+	CodeBuilder builder;
+
+	auto binary = builder.build(FAST_EXIT_FUNCTION + R"(
+		static volatile int counter = 0;
+		int spin(int forever) {
+			do {
+				counter++;
+			} while (forever);
+			return counter;
+		}
+
+		int main() {
+			return 0;
+		}
+	)", "vmcall_timeout");
+
+	TestMachine machine(binary);
+	machine.setup_linux();
+	auto& m = machine.machine();
+	const address_t spin = m.address_of("spin");
+	REQUIRE(spin != 0);
+
+	SECTION("Function returns in time") {
+		m.timed_vmcall(spin, 10s, 0);
+		REQUIRE(m.return_value<int>() == 1);
+	}
+
+	SECTION("Infinite loop is stopped") {
+		try {
+			m.timed_vmcall(spin, 20ms, 1);
+			FAIL("Expected timeout was not thrown");
+		} catch (const MachineException& e) {
+			REQUIRE(e.type() == MACHINE_TIMEOUT);
+		}
+		// The machine is still usable afterwards
+		m.timed_vmcall(spin, 10s, 0);
+		REQUIRE(m.return_value<int>() > 1);
+	}
+}
+
+TEST_CASE("vmcall - faults without exceptions", "[vmcall][faults]") {
+	CodeBuilder builder;
+
+	auto binary = builder.build(FAST_EXIT_FUNCTION + R"(
+		long load(long addr) {
+			return *(volatile long*)addr;
+		}
+
+		int main() {
+			return 0;
+		}
+	)", "vmcall_try");
+
+	TestMachine machine(binary);
+	machine.setup_linux();
+	auto& m = machine.machine();
+	const address_t load = m.address_of("load");
+	REQUIRE(load != 0);
+
+	SECTION("Successful call") {
+		const address_t data = m.memory.mmap_allocate(8);
+		m.memory.write<int64_t>(data, 1234);
+		const GuestFault fault = m.try_vmcall(load, 1'000'000ull, data);
+		REQUIRE(!fault);
+		REQUIRE(m.return_value<long>() == 1234);
+	}
+
+	SECTION("Faulting call") {
+		const GuestFault fault = m.try_vmcall(load, 1'000'000ull, 0);
+		REQUIRE(fault);
+		REQUIRE(fault.type == PROTECTION_FAULT);
+		REQUIRE(fault.data == 0);
+		// The PC is inside the function
+		REQUIRE(fault.pc >= load);
+		REQUIRE(fault.pc < load + 64);
+		// The machine is still usable afterwards
+		const address_t data = m.memory.mmap_allocate(8);
+		m.memory.write<int64_t>(data, 5);
+		REQUIRE(!m.try_vmcall(load, 1'000'000ull, data));
+		REQUIRE(m.return_value<long>() == 5);
+	}
+}